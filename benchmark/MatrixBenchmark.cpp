@@ -0,0 +1,453 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+// Benchmarks of the Array, Matrix and SolverMatrix operations over a range of sizes.
+// The argument of each benchmark is the size n of the (n x n) matrices involved.
+// Write JSON for regression tracking with --benchmark_out=<file> --benchmark_out_format=json,
+// or build the MatrixBenchmarkJson target.
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "CholeskyDecomposition.h"
+#include "Eigen3x3Batch.h"
+#include "GeneralEigenDecomposition.h"
+#include "LuDecomposition.h"
+#include "MatrixMultiplier.h"
+#include "MatrixTextFile.h"
+#include "QrDecomposition.h"
+#include "SingularValueDecomposition.h"
+#include "SolverMatrix.h"
+#include "SymmetricEigenDecomposition.h"
+#include "ThreadPool.h"
+
+namespace RixMatrixBenchmark {
+    using RixMatrix::Array;
+    using RixMatrix::CholeskyDecomposition;
+    using RixMatrix::Dimension;
+    using RixMatrix::Eigen3x3Batch;
+    using RixMatrix::GeneralEigenDecomposition;
+    using RixMatrix::LuDecomposition;
+    using RixMatrix::Matrix;
+    using RixMatrix::MatrixMultiplier;
+    using RixMatrix::MatrixTextFile;
+    using RixMatrix::MultiplicationAlgorithm;
+    using RixMatrix::QrDecomposition;
+    using RixMatrix::SingularValueDecomposition;
+    using RixMatrix::SolverMatrix;
+    using RixMatrix::SymmetricEigenDecomposition;
+    using RixMatrix::ThreadPool;
+
+    namespace {
+        // fixed seeds, so every run measures the same matrices
+        Matrix randomMatrix(const Dimension rows, const Dimension columns, const unsigned int seed = 42) {
+            std::mt19937 generator(seed);
+            std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+            Matrix result(rows, columns);
+            for (Dimension cell = 0; cell < result.size(); cell++) result[cell] = distribution(generator);
+            return result;
+        }
+
+        // diagonally dominant, so it is well conditioned and can be inverted
+        Matrix invertibleMatrix(const Dimension size) {
+            Matrix result = randomMatrix(size, size);
+            for (Dimension diagonal = 0; diagonal < size; diagonal++) result(diagonal, diagonal) += size;
+            return result;
+        }
+
+        Matrix symmetricMatrix(const Dimension size) {
+            const Matrix random = randomMatrix(size, size);
+            return Matrix(random + random.transposed<Matrix>());
+        }
+
+        // wide constraint Jacobian (rows x 4 rows) with rank rows / 2
+        Matrix wideJacobian(const Dimension rows) {
+            return Matrix(randomMatrix(rows, rows / 2, 1) * randomMatrix(rows / 2, 4 * rows, 2));
+        }
+
+        Dimension sizeOf(const benchmark::State& state) {
+            return static_cast<Dimension>(state.range(0));
+        }
+
+        void setElementsProcessed(benchmark::State& state, const Dimension elements) {
+            state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * elements);
+            state.SetComplexityN(state.range(0));
+        }
+    }
+
+    // *** Element wise ***
+
+    void elementWiseAdd(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Array left = randomMatrix(size, size, 1);
+        const Array right = randomMatrix(size, size, 2);
+        Array result(size, size);
+        for (auto _ : state) {
+            result = left + right;
+            benchmark::DoNotOptimize(result.data());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(elementWiseAdd)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    void elementWiseExpression(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Array a = randomMatrix(size, size, 1);
+        const Array b = randomMatrix(size, size, 2);
+        const Array c = randomMatrix(size, size, 3);
+        Array result(size, size);
+        for (auto _ : state) {
+            result = a * b + c * 2.0 - a / 3.0;
+            benchmark::DoNotOptimize(result.data());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(elementWiseExpression)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    void elementWiseScalarInPlace(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        Array array = randomMatrix(size, size);
+        for (auto _ : state) {
+            array *= 1.000001;
+            array += 1e-9;
+            benchmark::DoNotOptimize(array.data());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(elementWiseScalarInPlace)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    void elementWisePow2(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Array array = randomMatrix(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(array.pow2());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(elementWisePow2)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    void transpose(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = randomMatrix(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(matrix.transposed<Matrix>());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(transpose)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    void normalize(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = randomMatrix(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(matrix.normalized());
+        }
+        setElementsProcessed(state, size * size);
+    }
+    BENCHMARK(normalize)->RangeMultiplier(4)->Range(4, 1024)->Complexity(benchmark::oN);
+
+    // *** Matrix ***
+
+    void multiply(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix left = randomMatrix(size, size, 1);
+        const Matrix right = randomMatrix(size, size, 2);
+        Matrix result(size, size);
+        for (auto _ : state) {
+            Matrix::multiply(left, right, result);
+            benchmark::DoNotOptimize(result.data());
+        }
+        state.counters["flops"] = benchmark::Counter(2.0 * size * size * size, benchmark::Counter::kIsIterationInvariantRate);
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(multiply)->RangeMultiplier(2)->Range(2, 512)->Complexity(benchmark::oNCubed);
+
+    // second argument: ThreadPool thread count
+    void multiplyThreaded(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix left = randomMatrix(size, size, 1);
+        const Matrix right = randomMatrix(size, size, 2);
+        Matrix result(size, size);
+        ThreadPool::instance().setThreadCount(static_cast<unsigned int>(state.range(1)));
+        for (auto _ : state) {
+            Matrix::multiply(left, right, result);
+            benchmark::DoNotOptimize(result.data());
+        }
+        ThreadPool::instance().setThreadCount(1);
+        state.counters["flops"] = benchmark::Counter(2.0 * size * size * size, benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(multiplyThreaded)->ArgsProduct({ { 256, 512 }, { 1, 2, 4 } })->UseRealTime();
+
+    // second argument: Strassen cutoff, 0 for the classical kernel. Where a cutoff beats 0 is the crossover point.
+    void multiplyStrassen(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix left = randomMatrix(size, size, 1);
+        const Matrix right = randomMatrix(size, size, 2);
+        Matrix result(size, size);
+        const auto cutoff = static_cast<Dimension>(state.range(1));
+        if (cutoff > 0) {
+            MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::StrassenWinograd);
+            MatrixMultiplier::setStrassenCutoff(cutoff);
+        }
+        for (auto _ : state) {
+            Matrix::multiply(left, right, result);
+            benchmark::DoNotOptimize(result.data());
+        }
+        MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::Classical);
+        MatrixMultiplier::setStrassenCutoff(MatrixMultiplier::DefaultStrassenCutoff);
+        state.counters["flops"] = benchmark::Counter(2.0 * size * size * size, benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(multiplyStrassen)->ArgsProduct({ { 256, 512, 1024, 2048 }, { 0, 128, 256, 512 } })->Unit(benchmark::kMillisecond);
+
+    void determinant(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = invertibleMatrix(size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(matrix.getDeterminant());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(determinant)->DenseRange(2, 4)->RangeMultiplier(4)->Range(8, 512)->Complexity(benchmark::oNCubed);
+
+    void inverse(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = invertibleMatrix(size);
+        Matrix result(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(matrix.inverted(result));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(inverse)->DenseRange(2, 4)->RangeMultiplier(4)->Range(8, 512)->Complexity(benchmark::oNCubed);
+
+    // reusing the factorization against n right hand sides, versus inverting and multiplying
+    void solveFactorized(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const LuDecomposition lu(invertibleMatrix(size));
+        const Matrix rightHandSides = randomMatrix(size, size, 7);
+        Matrix result(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(lu.solve(rightHandSides, result));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(solveFactorized)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void solveByInverse(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = invertibleMatrix(size);
+        const Matrix rightHandSides = randomMatrix(size, size, 7);
+        Matrix inverse(size, size);
+        Matrix result(size, size);
+        for (auto _ : state) {
+            matrix.inverted(inverse);
+            Matrix::multiply(inverse, rightHandSides, result);
+            benchmark::DoNotOptimize(result.data());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(solveByInverse)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void luDecomposition(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = Matrix(symmetricMatrix(size) + Matrix::getIdentity(size) * (2.0 * size));
+        LuDecomposition lu(size);
+        for (auto _ : state) {
+            lu.decompose(matrix);
+            benchmark::DoNotOptimize(lu.getDeterminant());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(luDecomposition)->RangeMultiplier(4)->Range(4, 512)->Complexity(benchmark::oNCubed);
+
+    // same (positive definite) matrices as luDecomposition
+    void choleskyDecomposition(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = Matrix(symmetricMatrix(size) + Matrix::getIdentity(size) * (2.0 * size));
+        CholeskyDecomposition cholesky(size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(cholesky.decompose(matrix));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(choleskyDecomposition)->RangeMultiplier(4)->Range(4, 512)->Complexity(benchmark::oNCubed);
+
+    // *** SolverMatrix ***
+
+    void reducedRowEchelonForm(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = randomMatrix(size, size);
+        for (auto _ : state) {
+            SolverMatrix solver(matrix);
+            benchmark::DoNotOptimize(solver.toReducedRowEchelonFormWithPivot());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(reducedRowEchelonForm)->RangeMultiplier(2)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void nullSpace(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        // rank deficient: the last column repeats the first
+        Matrix matrix = randomMatrix(size, size);
+        matrix.setColumn(size - 1, matrix.column(0));
+        for (auto _ : state) {
+            // getNullSpace works on the reduced row echelon form, as in getEigenvectorFor
+            SolverMatrix solver(matrix);
+            const auto permutation = solver.toReducedRowEchelonFormWithPivot();
+            benchmark::DoNotOptimize(solver.getNullSpace(permutation));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(nullSpace)->RangeMultiplier(2)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    // wide constraint Jacobians: RREF versus a single rank revealing QR
+    void nullSpaceWideRref(benchmark::State& state) {
+        const Matrix matrix = wideJacobian(sizeOf(state));
+        for (auto _ : state) {
+            SolverMatrix solver(matrix);
+            const auto permutation = solver.toReducedRowEchelonFormWithPivot();
+            benchmark::DoNotOptimize(solver.getNullSpace(permutation));
+        }
+    }
+    BENCHMARK(nullSpaceWideRref)->Arg(10)->Arg(50)->Arg(100);
+
+    void nullSpaceWideQr(benchmark::State& state) {
+        const Matrix matrix = wideJacobian(sizeOf(state));
+        QrDecomposition qr(matrix.rowCount(), matrix.columnCount());
+        for (auto _ : state) {
+            qr.decompose(matrix);
+            benchmark::DoNotOptimize(qr.getNullSpace());
+        }
+    }
+    BENCHMARK(nullSpaceWideQr)->Arg(10)->Arg(50)->Arg(100);
+
+    void eigenvalues(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const SolverMatrix solver(symmetricMatrix(size));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(solver.getEigenvalues());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(eigenvalues)->DenseRange(2, 3)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void eigenvectors(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const SolverMatrix solver(symmetricMatrix(size));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(solver.getEigenvectors());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(eigenvectors)->DenseRange(2, 3)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void symmetricEigenDecomposition(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = symmetricMatrix(size);
+        SymmetricEigenDecomposition decomposition(size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(decomposition.decompose(matrix));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(symmetricEigenDecomposition)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    void singularValueDecomposition(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = randomMatrix(size, size);
+        SingularValueDecomposition decomposition(size, size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(decomposition.decompose(matrix));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(singularValueDecomposition)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    // over-determined calibration systems: many rows, 20 parameters
+    void leastSquaresTall(benchmark::State& state) {
+        const Dimension rows = sizeOf(state);
+        const Matrix matrix = randomMatrix(rows, 20);
+        const Matrix observations = randomMatrix(rows, 1, 7);
+        SingularValueDecomposition decomposition(rows, 20);
+        for (auto _ : state) {
+            decomposition.decompose(matrix);
+            benchmark::DoNotOptimize(decomposition.solve(observations));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(leastSquaresTall)->RangeMultiplier(4)->Range(256, 16384)->Complexity(benchmark::oN);
+
+    void generalEigenDecomposition(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const Matrix matrix = randomMatrix(size, size);
+        GeneralEigenDecomposition decomposition(size);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(decomposition.decompose(matrix));
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(generalEigenDecomposition)->RangeMultiplier(4)->Range(4, 256)->Complexity(benchmark::oNCubed);
+
+    // argument: number of 3x3 matrices
+    void eigen3x3Batch(benchmark::State& state) {
+        const Dimension count = sizeOf(state);
+        const Matrix input = randomMatrix(9, count);
+        Matrix eigenvalues(3, count);
+        Matrix eigenvectors(9, count);
+        Eigen3x3Batch::Input in{};
+        Eigen3x3Batch::Output out{};
+        for (Dimension cell = 0; cell < 9; cell++) {
+            in.element[cell / 3][cell % 3] = input.data() + cell * count;
+            out.eigenvector[cell / 3][cell % 3] = eigenvectors.data() + cell * count;
+        }
+        for (Dimension index = 0; index < 3; index++) out.eigenvalue[index] = eigenvalues.data() + index * count;
+        for (auto _ : state) {
+            Eigen3x3Batch::getEigenvectors(in, out, count);
+            benchmark::DoNotOptimize(eigenvectors.data());
+        }
+        setElementsProcessed(state, count);
+    }
+    BENCHMARK(eigen3x3Batch)->RangeMultiplier(8)->Range(64, 32768)->Complexity(benchmark::oN);
+
+    // *** Text files ***
+
+    void loadCsv(benchmark::State& state) {
+        const Dimension size = sizeOf(state);
+        const char* path = "MatrixBenchmark.csv";
+        if (!MatrixTextFile::saveCsv(path, randomMatrix(size, size))) {
+            state.SkipWithError("can't write the CSV file");
+            return;
+        }
+        std::FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) {
+            std::remove(path);
+            state.SkipWithError("can't open the CSV file");
+            return;
+        }
+        std::fseek(file, 0, SEEK_END);
+        const long fileSize = std::ftell(file);
+        std::fclose(file);
+        Matrix result(1, 1);
+        for (auto _ : state) {
+            if (!MatrixTextFile::loadCsv(path, result)) {
+                state.SkipWithError("can't load the CSV file");
+                break;
+            }
+            benchmark::DoNotOptimize(result.data());
+        }
+        std::remove(path);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * fileSize);
+    }
+    BENCHMARK(loadCsv)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "AllocationTracker.h"
+#include <atomic>
+
+namespace RixMatrix {
+
+    namespace {
+        // the counters are independent, so relaxed ordering is enough
+        std::atomic<bool> isTracking(false);
+        std::atomic<std::int64_t> allocations(0);
+        std::atomic<std::int64_t> deallocations(0);
+        std::atomic<std::int64_t> allocatedBytes(0);
+        std::atomic<std::int64_t> liveBuffers(0);
+        std::atomic<std::int64_t> liveBytes(0);
+        std::atomic<std::int64_t> peakBytes(0);
+    }
+
+    AllocationTracker::Statistics AllocationTracker::getStatistics() {
+        return Statistics {
+            allocations.load(std::memory_order_relaxed),
+            deallocations.load(std::memory_order_relaxed),
+            allocatedBytes.load(std::memory_order_relaxed),
+            liveBuffers.load(std::memory_order_relaxed),
+            liveBytes.load(std::memory_order_relaxed),
+            peakBytes.load(std::memory_order_relaxed)
+        };
+    }
+
+    bool AllocationTracker::isEnabled() {
+        return isTracking.load(std::memory_order_relaxed);
+    }
+
+    void AllocationTracker::reset() {
+        allocations.store(0, std::memory_order_relaxed);
+        deallocations.store(0, std::memory_order_relaxed);
+        allocatedBytes.store(0, std::memory_order_relaxed);
+        liveBuffers.store(0, std::memory_order_relaxed);
+        liveBytes.store(0, std::memory_order_relaxed);
+        peakBytes.store(0, std::memory_order_relaxed);
+    }
+
+    void AllocationTracker::setEnabled(const bool isEnabled) {
+        isTracking.store(isEnabled, std::memory_order_relaxed);
+    }
+
+    void AllocationTracker::recordAllocation(const std::size_t bytes) {
+        if (!isEnabled()) return;
+        const auto size = static_cast<std::int64_t>(bytes);
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        liveBuffers.fetch_add(1, std::memory_order_relaxed);
+        const std::int64_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        std::int64_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    void AllocationTracker::recordDeallocation(const std::size_t bytes) {
+        if (!isEnabled()) return;
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        liveBuffers.fetch_sub(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    AllocationScope::AllocationScope() : _wasEnabled(AllocationTracker::isEnabled()) {
+        AllocationTracker::reset();
+        AllocationTracker::setEnabled(true);
+    }
+
+    AllocationScope::~AllocationScope() {
+        AllocationTracker::setEnabled(_wasEnabled);
+    }
+
+    AllocationTracker::Statistics AllocationScope::getStatistics() const {
+        return AllocationTracker::getStatistics();
+    }
+}
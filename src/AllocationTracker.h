@@ -0,0 +1,96 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace RixMatrix {
+
+    /// Counts the allocations of array storage (and so of matrices), to prove that hot paths don't allocate
+    /// and to find out how much memory an operation needs at most. Opt-in: while disabled (the default),
+    /// the only cost is checking a flag per allocation. The counters are shared by all threads.
+    /// Only the element storage of arrays is tracked, not the scratch space of e.g. the multiplication kernel.
+    class AllocationTracker {
+    public:
+        // Counts since the last reset. The live counts are net changes, so buffers that were allocated before
+        // the reset and freed after it make them negative.
+        struct Statistics {
+            std::int64_t allocations;
+            std::int64_t deallocations;
+            std::int64_t allocatedBytes;
+            std::int64_t liveBuffers;
+            std::int64_t liveBytes;
+            // high-water mark of liveBytes
+            std::int64_t peakBytes;
+        };
+
+        static Statistics getStatistics();
+        static bool isEnabled();
+        static void reset();
+        static void setEnabled(bool isEnabled);
+
+        // called by TrackingAllocator
+        static void recordAllocation(std::size_t bytes);
+        static void recordDeallocation(std::size_t bytes);
+    };
+
+    /// Enables tracking and resets the counters for the duration of a scope, e.g. a single operation.
+    /// Scopes don't nest: an inner scope resets the counters of the outer one.
+    class AllocationScope {
+    public:
+        AllocationScope();
+        ~AllocationScope();
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+        AllocationTracker::Statistics getStatistics() const;
+
+    private:
+        bool _wasEnabled;
+    };
+
+    /// std::allocator that reports to the AllocationTracker. Used for the storage of arrays.
+    template <class Value>
+    struct TrackingAllocator {
+        using value_type = Value;
+
+        TrackingAllocator() = default;
+
+        template <class Other>
+        TrackingAllocator(const TrackingAllocator<Other>&) {}
+
+        Value* allocate(const std::size_t count) {
+            Value* result = std::allocator<Value>().allocate(count);
+            AllocationTracker::recordAllocation(count * sizeof(Value));
+            return result;
+        }
+
+        void deallocate(Value* pointer, const std::size_t count) {
+            AllocationTracker::recordDeallocation(count * sizeof(Value));
+            std::allocator<Value>().deallocate(pointer, count);
+        }
+    };
+
+    template <class Value, class Other>
+    bool operator==(const TrackingAllocator<Value>&, const TrackingAllocator<Other>&) {
+        return true;
+    }
+
+    template <class Value, class Other>
+    bool operator!=(const TrackingAllocator<Value>&, const TrackingAllocator<Other>&) {
+        return false;
+    }
+}
+#endif
@@ -10,22 +10,32 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include "Array.h"
+#include "ElementKernels.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <utility>
 
 namespace RixMatrix {
-	Array::Array(const Dimension rows, const Dimension columns) :
+	constexpr double Precision<double>::Epsilon;
+	constexpr double Precision<double>::EigenEpsilon;
+	constexpr float Precision<float>::Epsilon;
+	constexpr float Precision<float>::EigenEpsilon;
+
+	template <class Value>
+	BasicArray<Value>::BasicArray(const Dimension rows, const Dimension columns) :
 		_data(rows* columns),
 		_rows(rows),
 		_columns(columns),
 		_arraySize(rows* columns) {
 	}
 
-	Array::Array(const std::initializer_list<std::initializer_list<double>> list) :
+	template <class Value>
+	BasicArray<Value>::BasicArray(const std::initializer_list<std::initializer_list<Value>> list) :
+		_data(list.size() * list.begin()->size()),
 		_rows(static_cast<Dimension>(list.size())),
 		_columns(static_cast<Dimension>(list.begin()->size())),
 		_arraySize(_rows* _columns) {
-		_data = std::vector<double>(_rows * _columns);
 		Dimension row = 0;
 		for (auto rowList : list) {
 			Dimension column = 0;
@@ -37,237 +47,308 @@ namespace RixMatrix {
 		}
 	}
 
-	double& Array::operator[](const Dimension cell) {
+	template <class Value>
+	BasicArray<Value>::BasicArray(BasicArray&& other) noexcept :
+		_data(std::move(other._data)),
+		_rows(other._rows),
+		_columns(other._columns),
+		_arraySize(other._arraySize) {
+		other._rows = 0;
+		other._columns = 0;
+		other._arraySize = 0;
+	}
+
+	template <class Value>
+	BasicArray<Value>& BasicArray<Value>::operator=(BasicArray&& other) noexcept {
+		if (this == &other) return *this;
+		_data = std::move(other._data);
+		_rows = other._rows;
+		_columns = other._columns;
+		_arraySize = other._arraySize;
+		other._data.clear();
+		other._rows = 0;
+		other._columns = 0;
+		other._arraySize = 0;
+		return *this;
+	}
+
+	template <class Value>
+	Value& BasicArray<Value>::operator[](const Dimension cell) {
 		assert(cell < _arraySize);
 		return _data[cell];
 	}
 
-	const double& Array::operator[](const Dimension cell) const {
+	template <class Value>
+	const Value& BasicArray<Value>::operator[](const Dimension cell) const {
 		assert(cell < _arraySize);
 		return _data[cell];
 	}
 
-	double& Array::operator()(const Dimension row, const Dimension column) {
+	template <class Value>
+	Value& BasicArray<Value>::operator()(const Dimension row, const Dimension column) {
 		assert(row < _rows && column < _columns);
 		return _data[row * _columns + column];
 	}
 
-	const double& Array::operator()(const Dimension row, const Dimension column) const {
+	template <class Value>
+	const Value& BasicArray<Value>::operator()(const Dimension row, const Dimension column) const {
 		assert(row < _rows && column < _columns);
 		return _data[row * _columns + column];
 	}
 
-	void Array::operator+=(const Array& other) {
+	template <class Value>
+	void BasicArray<Value>::operator+=(const BasicArray& other) {
 		assert(other.sizeIsEqual(*this));
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] += other[cell];
-		}
+		ElementKernels::add(_data.data(), other.data(), _arraySize);
 	}
 
-	void Array::operator-=(const Array& other) {
+	template <class Value>
+	void BasicArray<Value>::operator-=(const BasicArray& other) {
 		assert(other.sizeIsEqual(*this));
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] -= other[cell];
-		}
+		ElementKernels::subtract(_data.data(), other.data(), _arraySize);
 	}
 
-	void Array::operator*=(const Array& other) {
+	template <class Value>
+	void BasicArray<Value>::operator*=(const BasicArray& other) {
 		assert(other.sizeIsEqual(*this));
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] *= other[cell];
-		}
+		ElementKernels::multiply(_data.data(), other.data(), _arraySize);
 	}
 
-	void Array::operator/=(const double other) {
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] /= other;
-		}
+	template <class Value>
+	void BasicArray<Value>::operator/=(const Value other) {
+		ElementKernels::divideScalar(_data.data(), other, _arraySize);
 	}
 
-	void Array::operator+=(const double other) {
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] += other;
-		}
+	template <class Value>
+	void BasicArray<Value>::operator+=(const Value other) {
+		ElementKernels::addScalar(_data.data(), other, _arraySize);
 	}
 
-	void Array::operator-=(const double other) {
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] -= other;
-		}
+	template <class Value>
+	void BasicArray<Value>::operator-=(const Value other) {
+		// x - v equals x + (-v) exactly in IEEE arithmetic
+		ElementKernels::addScalar(_data.data(), -other, _arraySize);
 	}
 
-	void Array::operator*=(const double other) {
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			_data[cell] *= other;
-		}
+	template <class Value>
+	void BasicArray<Value>::operator*=(const Value other) {
+		ElementKernels::multiplyScalar(_data.data(), other, _arraySize);
 	}
 
-	bool Array::operator==(const Array& other) const {
+	template <class Value>
+	bool BasicArray<Value>::operator==(const BasicArray& other) const {
 		if (!sizeIsEqual(other)) {
 			return false;
 		}
 		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			if (abs(_data[cell] - other[cell]) > Epsilon) {
+			if (fabs(_data[cell] - other[cell]) > Epsilon) {
 				return false;
 			}
 		}
 		return true;
 	}
 
-	Dimension Array::columnCount() const {
+	template <class Value>
+	Dimension BasicArray<Value>::columnCount() const {
 		return _columns;
 	}
 
-	Array Array::getColumn(const Dimension column) const {
+	template <class Value>
+	Value* BasicArray<Value>::data() {
+		return _data.data();
+	}
+
+	template <class Value>
+	const Value* BasicArray<Value>::data() const {
+		return _data.data();
+	}
+
+	template <class Value>
+	BasicArray<Value> BasicArray<Value>::getColumn(const Dimension column) const {
 		assert(column < _columns);
-		Array result(_rows, 1);
+		BasicArray result(_rows, 1);
 		for (Dimension row = 0; row < _rows; row++) {
 			result(row, 0) = me(row, column);
 		}
 		return result;
 	}
 
-	Array Array::getRow(const Dimension row) const {
+	template <class Value>
+	BasicArray<Value> BasicArray<Value>::getRow(const Dimension row) const {
 		assert(row < _rows);
-		Array result(1, _columns);
+		BasicArray result(1, _columns);
 		for (Dimension column = 0; column < _columns; column++) {
 			result(0, column) = me(row, column);
 		}
 		return result;
 	}
 
-	bool Array::isSquare() const {
+	template <class Value>
+	typename BasicArray<Value>::View BasicArray<Value>::column(const Dimension column) {
+		assert(column < _columns);
+		return View(_data.data() + column, _rows, 1, _columns);
+	}
+
+	template <class Value>
+	typename BasicArray<Value>::ConstView BasicArray<Value>::column(const Dimension column) const {
+		assert(column < _columns);
+		return ConstView(_data.data() + column, _rows, 1, _columns);
+	}
+
+	template <class Value>
+	typename BasicArray<Value>::View BasicArray<Value>::row(const Dimension row) {
+		assert(row < _rows);
+		return View(_data.data() + row * _columns, 1, _columns, _columns);
+	}
+
+	template <class Value>
+	typename BasicArray<Value>::ConstView BasicArray<Value>::row(const Dimension row) const {
+		assert(row < _rows);
+		return ConstView(_data.data() + row * _columns, 1, _columns, _columns);
+	}
+
+	template <class Value>
+	typename BasicArray<Value>::View BasicArray<Value>::block(const Dimension row, const Dimension column, const Dimension rows, const Dimension columns) {
+		assert(row + rows <= _rows && column + columns <= _columns);
+		return View(_data.data() + row * _columns + column, rows, columns, _columns);
+	}
+
+	template <class Value>
+	typename BasicArray<Value>::ConstView BasicArray<Value>::block(const Dimension row, const Dimension column, const Dimension rows, const Dimension columns) const {
+		assert(row + rows <= _rows && column + columns <= _columns);
+		return ConstView(_data.data() + row * _columns + column, rows, columns, _columns);
+	}
+
+	template <class Value>
+	bool BasicArray<Value>::isSquare() const {
 		return _rows == _columns;
 	}
 
-	double Array::me(const Dimension row, const Dimension column) const {
+	template <class Value>
+	Value BasicArray<Value>::me(const Dimension row, const Dimension column) const {
 		assert(row < _rows && column < _columns);
 		return _data[row * _columns + column];
 	}
 
-	Array Array::pow2() const {
-		Array result(*this);
-		for (Dimension cell = 0; cell < _arraySize; cell++) {
-			result[cell] *= _data[cell];
-		}
+	template <class Value>
+	BasicArray<Value> BasicArray<Value>::pow2() const & {
+		BasicArray result(_rows, _columns);
+		ElementKernels::square(result.data(), _data.data(), _arraySize);
 		return result;
 	}
 
-	Dimension Array::rowCount() const {
+	template <class Value>
+	BasicArray<Value> BasicArray<Value>::pow2() && {
+		ElementKernels::square(_data.data(), _data.data(), _arraySize);
+		return std::move(*this);
+	}
+
+	template <class Value>
+	Dimension BasicArray<Value>::rowCount() const {
 		return _rows;
 	}
 
-	void Array::setColumn(const Dimension column, const Array& input) {
+	template <class Value>
+	void BasicArray<Value>::setColumn(const Dimension column, const BasicArray& input) {
 		assert(column < _columns && input.rowCount() == _rows);
 		for (Dimension row = 0; row < _rows; row++) {
 			(*this)(row, column) = input(row, 0);
 		}
 	}
 
-	void Array::setColumn(const Dimension column, const double value) {
+	template <class Value>
+	void BasicArray<Value>::setColumn(const Dimension column, const Value value) {
 		assert(column < _columns);
 		for (Dimension row = 0; row < _rows; row++) {
 			(*this)(row, column) = value;
 		}
 	}
 
-	void Array::setColumnCount(const Dimension columns) {
+	/// @brief Row-major storage, so the rows move: forward when shrinking, backward when growing
+	template <class Value>
+	void BasicArray<Value>::setColumnCount(const Dimension columns) {
 		if (columns == _columns) {
 			return;
 		}
-		Array result(_rows, columns);
-		const Dimension maxColumns = std::min(_columns, columns);
-		for (Dimension row = 0; row < _rows; row++) {
-			for (Dimension column = 0; column < maxColumns; column++) {
-				result(row, column) = me(row, column);
+		const Dimension oldColumns = _columns;
+		if (columns < oldColumns) {
+			for (Dimension row = 1; row < _rows; row++) {
+				std::copy_n(_data.begin() + row * oldColumns, columns, _data.begin() + row * columns);
+			}
+			_data.resize(_rows * columns);
+		} else {
+			_data.resize(_rows * columns);
+			for (Dimension row = _rows; row-- > 0;) {
+				const auto source = _data.begin() + row * oldColumns;
+				const auto target = _data.begin() + row * columns;
+				std::copy_backward(source, source + oldColumns, target + oldColumns);
+				std::fill(target + oldColumns, target + columns, Value(0));
 			}
 		}
-		*this = result;
+		_columns = columns;
+		_arraySize = _rows * columns;
 	}
 
-	void Array::setRow(const Dimension row, const Array& input) {
+	template <class Value>
+	void BasicArray<Value>::setRow(const Dimension row, const BasicArray& input) {
 		assert(row < _rows && input.columnCount() == _columns);
 		for (Dimension column = 0; column < _columns; column++) {
 			(*this)(row, column) = input(0, column);
 		}
 	}
 
-	void Array::setRow(const Dimension row, const double value) {
+	template <class Value>
+	void BasicArray<Value>::setRow(const Dimension row, const Value value) {
 		assert(row < _rows);
 		for (Dimension column = 0; column < _columns; column++) {
 			(*this)(row, column) = value;
 		}
 	}
 
-	void Array::setRowCount(const Dimension rows) {
+	template <class Value>
+	void BasicArray<Value>::setRowCount(const Dimension rows) {
 		if (rows == _rows) {
 			return;
 		}
-		Array result(rows, _columns);
-		const Dimension maxRows = std::min(_rows, rows);
-		for (Dimension row = 0; row < maxRows; row++) {
-			for (Dimension column = 0; column < _columns; column++) {
-				result(row, column) = me(row, column);
-			}
-		}
-		*this = result;
+		// the rows are contiguous, so this only adds or drops the tail
+		_data.resize(rows * _columns, Value(0));
+		_rows = rows;
+		_arraySize = rows * _columns;
 	}
 
-	Dimension Array::size() const {
+	template <class Value>
+	Dimension BasicArray<Value>::size() const {
 		return _arraySize;
 	}
 
-	bool Array::sizeIsEqual(const Array& other) const {
+	template <class Value>
+	bool BasicArray<Value>::sizeIsEqual(const BasicArray& other) const {
 		return _rows == other._rows && _columns == other._columns;
 	}
 
-	void Array::swapColumns(const Dimension column1, const Dimension column2) {
+	template <class Value>
+	void BasicArray<Value>::swapColumns(const Dimension column1, const Dimension column2) {
 		assert(column1 < _columns && column2 < _columns);
 		if (column1 == column2) return;
 		for (Dimension row = 0; row < _rows; row++) {
-			const double temp = me(row, column1);
+			const Value temp = me(row, column1);
 			(*this)(row, column1) = me(row, column2);
 			(*this)(row, column2) = temp;
 		}
 	}
 
-	void Array::swapRows(const Dimension row1, const Dimension row2) {
+	template <class Value>
+	void BasicArray<Value>::swapRows(const Dimension row1, const Dimension row2) {
 		assert(row1 < _rows && row2 < _rows);
 		if (row1 == row2) return;
 		for (Dimension column = 0; column < _columns; column++) {
-			const double temp = me(row1, column);
+			const Value temp = me(row1, column);
 			(*this)(row1, column) = me(row2, column);
 			(*this)(row2, column) = temp;
 		}
 	}
 
-	Array operator+(Array left, const Array& right) {
-		left += right;
-		return left;
-	}
-
-	Array operator-(Array left, const Array& right) {
-		left -= right;
-		return left;
-	}
-
-	Array operator*(Array left, const Array& right) {
-		left *= right;
-		return left;
-	}
-
-	Array operator*(Array left, const double right) {
-		left *= right;
-		return left;
-	}
-
-	Array operator/(Array left, const double right) {
-		left /= right;
-		return left;
-	}
-
-	Array operator*(const double left, Array right) {
-		right *= left;
-		return right;
-	}
-}
\ No newline at end of file
+	// the members are defined here, so instantiate the scalar types the library supports
+	template class BasicArray<float>;
+	template class BasicArray<double>;
+}
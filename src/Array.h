@@ -13,54 +13,125 @@
 #define ARRAY_H
 
 #include <vector>
+#include "AllocationTracker.h"
+#include "ArrayExpression.h"
+#include "ArrayView.h"
 
 namespace RixMatrix {
     using Dimension = unsigned int;
 
-    /// Class for array manipulations (coefficient wise)
-	class Array {
+    /// Tolerances per scalar type.
+    /// Not std::numeric_limits<Value>::epsilon(), because that is too small for results of a few operations.
+    template <class Value>
+    struct Precision;
+
+    template <>
+    struct Precision<double> {
+        static constexpr double Epsilon = 1e-12;
+        // for pivots and null spaces (see SolverMatrix), where rounding errors have added up
+        static constexpr double EigenEpsilon = 1e-6;
+    };
+
+    template <>
+    struct Precision<float> {
+        static constexpr float Epsilon = 1e-5f;
+        static constexpr float EigenEpsilon = 1e-3f;
+    };
+
+    /// Class for array manipulations (coefficient wise), on float or double elements.
+    /// The float and double versions are instantiated in the library; use the Array and FloatArray aliases.
+    template <class Value>
+	class BasicArray : public ArrayOperand {
     public:
-        Array(Dimension rows, Dimension columns);
-        explicit Array(std::initializer_list<std::initializer_list<double>> list);
+        using ValueType = Value;
+        // the type element wise expressions on this class evaluate to
+        using ResultType = BasicArray;
+        using View = BasicArrayView<Value>;
+        using ConstView = BasicArrayView<const Value>;
+
+        BasicArray(Dimension rows, Dimension columns);
+        explicit BasicArray(std::initializer_list<std::initializer_list<Value>> list);
 
-        double& operator[](Dimension cell);
-        const double& operator[](Dimension cell) const;
+        // moves take over the storage and leave the source empty (0x0); copy assignment reuses the capacity
+        BasicArray(const BasicArray& other) = default;
+        BasicArray(BasicArray&& other) noexcept;
+        BasicArray& operator=(const BasicArray& other) = default;
+        BasicArray& operator=(BasicArray&& other) noexcept;
 
-        double& operator()(Dimension row, Dimension column);
-        const double& operator()(Dimension row, Dimension column) const;
+        // convert from the other scalar type
+        template <class Other, class = typename std::enable_if<!std::is_same<Other, Value>::value>::type>
+        explicit BasicArray(const BasicArray<Other>& other);
 
-        void operator+=(const Array& other);
-        void operator+=(double other);
+        // evaluate an element wise expression (see ArrayExpression.h) in a single pass
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        BasicArray(const Expression& expression);
 
-        void operator-=(const Array& other);
-        void operator-=(double other);
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        BasicArray& operator=(const Expression& expression);
 
-        void operator*=(const Array& other);
-        void operator*=(double other);
-        void operator/=(double other);
-        bool operator==(const Array& other) const;
+        Value& operator[](Dimension cell);
+        const Value& operator[](Dimension cell) const;
+
+        Value& operator()(Dimension row, Dimension column);
+        const Value& operator()(Dimension row, Dimension column) const;
+
+        void operator+=(const BasicArray& other);
+        void operator+=(Value other);
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        void operator+=(const Expression& other);
+
+        void operator-=(const BasicArray& other);
+        void operator-=(Value other);
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        void operator-=(const Expression& other);
+
+        void operator*=(const BasicArray& other);
+        void operator*=(Value other);
+        void operator/=(Value other);
+        bool operator==(const BasicArray& other) const;
 
         Dimension columnCount() const;
-        Array getColumn(Dimension column) const;
-        Array getRow(Dimension row) const;
+
+        // raw row-major storage, for the computation kernels
+        Value* data();
+        const Value* data() const;
+
+        // copies; use column, row or block to work on the array itself
+        BasicArray getColumn(Dimension column) const;
+        BasicArray getRow(Dimension row) const;
+
+        // views on part of the array, without copying (see ArrayView.h)
+        View column(Dimension column);
+        ConstView column(Dimension column) const;
+        View row(Dimension row);
+        ConstView row(Dimension row) const;
+        View block(Dimension row, Dimension column, Dimension rows, Dimension columns);
+        ConstView block(Dimension row, Dimension column, Dimension rows, Dimension columns) const;
 
         bool isSquare() const;
-        double me(Dimension row, Dimension column) const;
-        Array pow2() const;
+        Value me(Dimension row, Dimension column) const;
+        BasicArray pow2() const &;
+        // squares in place when the array is a temporary
+        BasicArray pow2() &&;
         Dimension rowCount() const;
 
-        void setColumn(Dimension column, const Array& input);
-        void setColumn(Dimension column, double value);
+        void setColumn(Dimension column, const BasicArray& input);
+        void setColumn(Dimension column, Value value);
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        void setColumn(Dimension column, const Expression& input);
+        // resize in place, keeping the existing elements and the capacity; new elements are 0
         void setColumnCount(Dimension columns);
 
-        void setRow(Dimension row, const Array& input);
-        void setRow(Dimension row, double value);
+        void setRow(Dimension row, const BasicArray& input);
+        void setRow(Dimension row, Value value);
+        template <class Expression, class = typename std::enable_if<IsExpression<Expression>::value>::type>
+        void setRow(Dimension row, const Expression& input);
         void setRowCount(Dimension rows);
 
         void swapRows(Dimension row1, Dimension row2);
         void swapColumns(Dimension column1, Dimension column2);
 
-        template<class T = Array>
+        template<class T = BasicArray>
         T transposed() const {
             T result(columnCount(), rowCount());
             for (Dimension row = 0; row < rowCount(); row++) {
@@ -72,24 +143,99 @@ namespace RixMatrix {
         }
 
         Dimension size() const;
-        bool sizeIsEqual(const Array& other) const;
-
-        friend Array operator+(Array left, const Array& right);
-        friend Array operator-(Array left, const Array& right);
-        friend Array operator*(Array left, const Array& right);
-        friend Array operator*(Array left, double right);
-        friend Array operator*(double left, Array right);
-        friend Array operator/(Array left, double right);
+        bool sizeIsEqual(const BasicArray& other) const;
 
-        // not using std::numeric_limits<double>::epsilon() because it is too small
-        static constexpr double Epsilon = 1e-12;
+        static constexpr Value Epsilon = Precision<Value>::Epsilon;
 
     private:
-        std::vector<double> _data;
+        // the allocator only counts when the AllocationTracker is enabled
+        std::vector<Value, TrackingAllocator<Value>> _data;
 
         Dimension _rows;
         Dimension _columns;
         Dimension _arraySize;
     };
+
+    using Array = BasicArray<double>;
+    using FloatArray = BasicArray<float>;
+
+    template <class Value>
+    constexpr Value BasicArray<Value>::Epsilon;
+
+    template <class Value>
+    template <class Other, class>
+    BasicArray<Value>::BasicArray(const BasicArray<Other>& other) :
+        _data(other.size()),
+        _rows(other.rowCount()),
+        _columns(other.columnCount()),
+        _arraySize(other.size()) {
+        const Other* source = other.data();
+        for (Dimension cell = 0; cell < _arraySize; cell++) {
+            _data[cell] = static_cast<Value>(source[cell]);
+        }
+    }
+
+    template <class Value>
+    template <class Expression, class>
+    BasicArray<Value>::BasicArray(const Expression& expression) :
+        _data(static_cast<std::size_t>(expression.rowCount()) * expression.columnCount()),
+        _rows(expression.rowCount()),
+        _columns(expression.columnCount()),
+        _arraySize(_rows * _columns) {
+        for (Dimension cell = 0; cell < _arraySize; cell++) {
+            _data[cell] = expression[cell];
+        }
+    }
+
+    /// @brief Evaluates in place if the size matches. That is safe even if this array is one of the operands,
+    /// as every cell only depends on the same cell of the operands.
+    template <class Value>
+    template <class Expression, class>
+    BasicArray<Value>& BasicArray<Value>::operator=(const Expression& expression) {
+        if (_rows != expression.rowCount() || _columns != expression.columnCount()) {
+            return *this = BasicArray(expression);
+        }
+        for (Dimension cell = 0; cell < _arraySize; cell++) {
+            _data[cell] = expression[cell];
+        }
+        return *this;
+    }
+
+    template <class Value>
+    template <class Expression, class>
+    void BasicArray<Value>::operator+=(const Expression& other) {
+        assert(_rows == other.rowCount() && _columns == other.columnCount());
+        for (Dimension cell = 0; cell < _arraySize; cell++) {
+            _data[cell] += other[cell];
+        }
+    }
+
+    /// @brief set a column from an expression or view; the input is a column (or anything with rowCount() elements)
+    template <class Value>
+    template <class Expression, class>
+    void BasicArray<Value>::setColumn(const Dimension column, const Expression& input) {
+        assert(column < _columns && input.rowCount() == _rows);
+        for (Dimension row = 0; row < _rows; row++) {
+            _data[row * _columns + column] = input[row];
+        }
+    }
+
+    template <class Value>
+    template <class Expression, class>
+    void BasicArray<Value>::setRow(const Dimension row, const Expression& input) {
+        assert(row < _rows && input.columnCount() == _columns);
+        for (Dimension column = 0; column < _columns; column++) {
+            _data[row * _columns + column] = input[column];
+        }
+    }
+
+    template <class Value>
+    template <class Expression, class>
+    void BasicArray<Value>::operator-=(const Expression& other) {
+        assert(_rows == other.rowCount() && _columns == other.columnCount());
+        for (Dimension cell = 0; cell < _arraySize; cell++) {
+            _data[cell] -= other[cell];
+        }
+    }
 }
 #endif
\ No newline at end of file
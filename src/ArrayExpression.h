@@ -0,0 +1,190 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef ARRAYEXPRESSION_H
+#define ARRAYEXPRESSION_H
+
+#include <cassert>
+#include <type_traits>
+
+namespace RixMatrix {
+    using Dimension = unsigned int;
+
+    template <class Value>
+    class BasicArray;
+
+    /// Lazy element wise expressions. Operators on arrays return a small expression object instead of a new array;
+    /// the whole expression is evaluated in a single pass when it gets assigned to an Array or Matrix.
+    /// So a + b * 2 - c needs one result buffer and no temporaries.
+    /// @note Expressions hold pointers into the storage of their operands, so don't keep them (e.g. via auto)
+    /// beyond the lifetime of the arrays they refer to. Assign them to an Array or Matrix instead.
+    /// All operands of an expression must have the same scalar type (ValueType); there is no implicit mixed precision.
+
+    /// Base for everything that can take part in an element wise expression (arrays and expression nodes)
+    struct ExpressionOperand {};
+
+    /// Base for the operands that own their storage (BasicArray and everything derived from it)
+    struct ArrayOperand : ExpressionOperand {};
+
+    template <class T>
+    struct IsOperand : std::is_base_of<ExpressionOperand, T> {};
+
+    template <class T>
+    struct IsArray : std::is_base_of<ArrayOperand, T> {};
+
+    // an operand that is not an array itself, i.e. something that still needs evaluating
+    template <class T>
+    struct IsExpression : std::integral_constant<bool, IsOperand<T>::value && !IsArray<T>::value> {};
+
+    /// Leaf referring to an array's storage, so evaluation doesn't need the (asserting, out of line) accessors
+    template <class T>
+    class ArrayReference {
+    public:
+        using ResultType = typename T::ResultType;
+        using ValueType = typename T::ValueType;
+
+        ArrayReference(const T& array) :
+            _data(array.data()), _rows(array.rowCount()), _columns(array.columnCount()) {}
+
+        ValueType operator[](const Dimension cell) const { return _data[cell]; }
+        Dimension rowCount() const { return _rows; }
+        Dimension columnCount() const { return _columns; }
+
+    private:
+        const ValueType* _data;
+        Dimension _rows;
+        Dimension _columns;
+    };
+
+    // arrays are stored as references to their data, expression nodes by value (they are small)
+    template <class T, bool = IsArray<T>::value>
+    struct OperandStorage {
+        using Type = T;
+    };
+
+    template <class T>
+    struct OperandStorage<T, true> {
+        using Type = ArrayReference<T>;
+    };
+
+    // an expression on two matrices is a matrix, anything else involving an array is an array
+    template <class Left, class Right>
+    struct CombinedResult {
+        using ValueType = typename Left::ValueType;
+        static_assert(std::is_same<ValueType, typename Right::ValueType>::value, "operands must have the same scalar type");
+        using Type = typename std::conditional<
+            std::is_same<typename Left::ResultType, typename Right::ResultType>::value,
+            typename Left::ResultType, BasicArray<ValueType>>::type;
+    };
+
+    // element wise product: only when not both operands are matrices. Only looks at ResultType if both are operands.
+    template <class Left, class Right, bool = IsOperand<Left>::value && IsOperand<Right>::value>
+    struct IsElementWiseProduct : std::false_type {};
+
+    template <class Left, class Right>
+    struct IsElementWiseProduct<Left, Right, true> :
+        std::is_same<typename CombinedResult<Left, Right>::Type, BasicArray<typename CombinedResult<Left, Right>::ValueType>> {};
+
+    struct AddOperation {
+        template <class Value>
+        static Value apply(const Value left, const Value right) { return left + right; }
+    };
+
+    struct SubtractOperation {
+        template <class Value>
+        static Value apply(const Value left, const Value right) { return left - right; }
+    };
+
+    struct MultiplyOperation {
+        template <class Value>
+        static Value apply(const Value left, const Value right) { return left * right; }
+    };
+
+    struct DivideOperation {
+        template <class Value>
+        static Value apply(const Value left, const Value right) { return left / right; }
+    };
+
+    template <class Operation, class Left, class Right>
+    class BinaryExpression : public ExpressionOperand {
+    public:
+        using ResultType = typename CombinedResult<Left, Right>::Type;
+        using ValueType = typename CombinedResult<Left, Right>::ValueType;
+
+        BinaryExpression(const Left& left, const Right& right) : _left(left), _right(right) {
+            assert(_left.rowCount() == _right.rowCount() && _left.columnCount() == _right.columnCount());
+        }
+
+        ValueType operator[](const Dimension cell) const { return Operation::apply(_left[cell], _right[cell]); }
+        Dimension rowCount() const { return _left.rowCount(); }
+        Dimension columnCount() const { return _left.columnCount(); }
+
+    private:
+        typename OperandStorage<Left>::Type _left;
+        typename OperandStorage<Right>::Type _right;
+    };
+
+    template <class Operation, class Operand>
+    class ScalarExpression : public ExpressionOperand {
+    public:
+        using ResultType = typename Operand::ResultType;
+        using ValueType = typename Operand::ValueType;
+
+        ScalarExpression(const Operand& operand, const ValueType scalar) : _operand(operand), _scalar(scalar) {}
+
+        ValueType operator[](const Dimension cell) const { return Operation::apply(_operand[cell], _scalar); }
+        Dimension rowCount() const { return _operand.rowCount(); }
+        Dimension columnCount() const { return _operand.columnCount(); }
+
+    private:
+        typename OperandStorage<Operand>::Type _operand;
+        ValueType _scalar;
+    };
+
+    template <class Left, class Right>
+    typename std::enable_if<IsOperand<Left>::value && IsOperand<Right>::value, BinaryExpression<AddOperation, Left, Right>>::type
+    operator+(const Left& left, const Right& right) {
+        return BinaryExpression<AddOperation, Left, Right>(left, right);
+    }
+
+    template <class Left, class Right>
+    typename std::enable_if<IsOperand<Left>::value && IsOperand<Right>::value, BinaryExpression<SubtractOperation, Left, Right>>::type
+    operator-(const Left& left, const Right& right) {
+        return BinaryExpression<SubtractOperation, Left, Right>(left, right);
+    }
+
+    // element wise multiplication. Not for two matrices: there * is the matrix product (see Matrix.h).
+    template <class Left, class Right>
+    typename std::enable_if<IsElementWiseProduct<Left, Right>::value, BinaryExpression<MultiplyOperation, Left, Right>>::type
+    operator*(const Left& left, const Right& right) {
+        return BinaryExpression<MultiplyOperation, Left, Right>(left, right);
+    }
+
+    // the scalar is converted to the scalar type of the operand, so 2.0 * a stays in float for a float array
+    template <class Operand>
+    typename std::enable_if<IsOperand<Operand>::value, ScalarExpression<MultiplyOperation, Operand>>::type
+    operator*(const Operand& left, const typename Operand::ValueType right) {
+        return ScalarExpression<MultiplyOperation, Operand>(left, right);
+    }
+
+    template <class Operand>
+    typename std::enable_if<IsOperand<Operand>::value, ScalarExpression<MultiplyOperation, Operand>>::type
+    operator*(const typename Operand::ValueType left, const Operand& right) {
+        return ScalarExpression<MultiplyOperation, Operand>(right, left);
+    }
+
+    template <class Operand>
+    typename std::enable_if<IsOperand<Operand>::value, ScalarExpression<DivideOperation, Operand>>::type
+    operator/(const Operand& left, const typename Operand::ValueType right) {
+        return ScalarExpression<DivideOperation, Operand>(left, right);
+    }
+}
+#endif
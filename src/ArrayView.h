@@ -0,0 +1,128 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef ARRAYVIEW_H
+#define ARRAYVIEW_H
+
+#include <cassert>
+#include <type_traits>
+#include "ArrayExpression.h"
+
+namespace RixMatrix {
+
+    /// Non-owning view on a rectangular part (a row, a column or a block) of an array's storage.
+    /// Creating one doesn't allocate or copy; reads and writes go straight to the parent array.
+    /// Views take part in element wise expressions like arrays do, and evaluate to a BasicArray of their scalar type.
+    /// @note A view is only valid as long as its array exists and isn't resized.
+    /// Assigning to a view copies the elements, it doesn't rebind the view.
+    template <class Value>
+    class BasicArrayView : public ExpressionOperand {
+    public:
+        using ValueType = typename std::remove_const<Value>::type;
+        using ResultType = BasicArray<ValueType>;
+
+        /// @param data the first element of the view
+        /// @param stride distance between the starts of two consecutive rows (the column count of the parent)
+        BasicArrayView(Value* data, const Dimension rows, const Dimension columns, const Dimension stride) :
+            _data(data), _rows(rows), _columns(columns), _stride(stride) {}
+
+        // a writable view can be used where a read only view is expected
+        template <class Other, class = typename std::enable_if<std::is_same<const Other, Value>::value && !std::is_same<Other, Value>::value>::type>
+        BasicArrayView(const BasicArrayView<Other>& other) :
+            _data(other.data()), _rows(other.rowCount()), _columns(other.columnCount()), _stride(other.stride()) {}
+
+        BasicArrayView(const BasicArrayView& other) = default;
+
+        BasicArrayView& operator=(const BasicArrayView& other) {
+            assign(other);
+            return *this;
+        }
+
+        template <class Operand, class = typename std::enable_if<IsOperand<Operand>::value>::type>
+        BasicArrayView& operator=(const Operand& other) {
+            assign(other);
+            return *this;
+        }
+
+        BasicArrayView& operator=(const ValueType value) {
+            static_assert(!std::is_const<Value>::value, "read only view");
+            for (Dimension row = 0; row < _rows; row++) {
+                for (Dimension column = 0; column < _columns; column++) {
+                    _data[row * _stride + column] = value;
+                }
+            }
+            return *this;
+        }
+
+        template <class Operand, class = typename std::enable_if<IsOperand<Operand>::value>::type>
+        void operator+=(const Operand& other) {
+            *this = *this + other;
+        }
+
+        template <class Operand, class = typename std::enable_if<IsOperand<Operand>::value>::type>
+        void operator-=(const Operand& other) {
+            *this = *this - other;
+        }
+
+        void operator*=(const ValueType other) {
+            *this = *this * other;
+        }
+
+        void operator/=(const ValueType other) {
+            *this = *this / other;
+        }
+
+        // element in row major order, as if the view were an array of its own
+        Value& operator[](const Dimension cell) const {
+            assert(cell < _rows * _columns);
+            return _data[offset(cell)];
+        }
+
+        Value& operator()(const Dimension row, const Dimension column) const {
+            assert(row < _rows && column < _columns);
+            return _data[row * _stride + column];
+        }
+
+        Dimension rowCount() const { return _rows; }
+        Dimension columnCount() const { return _columns; }
+        Dimension stride() const { return _stride; }
+        Value* data() const { return _data; }
+
+    private:
+        Dimension offset(const Dimension cell) const {
+            if (_columns == 1) return cell * _stride;
+            if (_rows == 1 || _columns == _stride) return cell;
+            return cell / _columns * _stride + cell % _columns;
+        }
+
+        template <class Operand>
+        void assign(const Operand& other) {
+            static_assert(!std::is_const<Value>::value, "read only view");
+            assert(_rows == other.rowCount() && _columns == other.columnCount());
+            const typename OperandStorage<Operand>::Type source(other);
+            Dimension cell = 0;
+            for (Dimension row = 0; row < _rows; row++) {
+                for (Dimension column = 0; column < _columns; column++) {
+                    _data[row * _stride + column] = source[cell++];
+                }
+            }
+        }
+
+        Value* _data;
+        Dimension _rows;
+        Dimension _columns;
+        Dimension _stride;
+    };
+
+    using ArrayView = BasicArrayView<double>;
+    using ConstArrayView = BasicArrayView<const double>;
+}
+#endif
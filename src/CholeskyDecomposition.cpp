@@ -0,0 +1,231 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "CholeskyDecomposition.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace RixMatrix {
+
+    template <class Value>
+    BasicCholeskyDecomposition<Value>::BasicCholeskyDecomposition(const Dimension size) :
+        _lower(size, size) {}
+
+    template <class Value>
+    BasicCholeskyDecomposition<Value>::BasicCholeskyDecomposition(const BasicMatrix<Value>& matrix) :
+        _lower(matrix) {
+        assert(matrix.isSquare());
+        _isPositiveDefinite = factorize(_lower.data(), size());
+    }
+
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::decompose(const BasicMatrix<Value>& matrix) {
+        assert(matrix.isSquare() && matrix.rowCount() == size());
+        _lower = matrix;
+        _isPositiveDefinite = factorize(_lower.data(), size());
+        return _isPositiveDefinite;
+    }
+
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::decomposeInPlace(BasicMatrix<Value>& matrix) {
+        assert(matrix.isSquare());
+        return factorize(matrix.data(), matrix.rowCount());
+    }
+
+    /// @brief the product of the squared diagonal of L
+    template <class Value>
+    Value BasicCholeskyDecomposition<Value>::getDeterminant() const {
+        assert(_isPositiveDefinite);
+        const Dimension n = size();
+        const Value* lower = _lower.data();
+        Value result = 1;
+        for (Dimension diagonal = 0; diagonal < n; diagonal++) {
+            result *= lower[diagonal * n + diagonal];
+        }
+        return result * result;
+    }
+
+    /// @brief Solve L L^T X = I in place in the result.
+    /// @return whether the matrix was positive definite. If not, the result is left untouched.
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::getInverse(BasicMatrix<Value>& result) const {
+        const Dimension n = size();
+        assert(result.rowCount() == n && result.columnCount() == n);
+        if (!_isPositiveDefinite) return false;
+        Value* inverse = result.data();
+        for (Dimension cell = 0; cell < n * n; cell++) {
+            inverse[cell] = 0;
+        }
+        for (Dimension diagonal = 0; diagonal < n; diagonal++) {
+            inverse[diagonal * n + diagonal] = 1;
+        }
+        return solve(result);
+    }
+
+    template <class Value>
+    Value BasicCholeskyDecomposition<Value>::getLogDeterminant() const {
+        assert(_isPositiveDefinite);
+        const Dimension n = size();
+        const Value* lower = _lower.data();
+        Value result = 0;
+        for (Dimension diagonal = 0; diagonal < n; diagonal++) {
+            result += std::log(lower[diagonal * n + diagonal]);
+        }
+        return 2 * result;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicCholeskyDecomposition<Value>::getLower() const {
+        return _lower;
+    }
+
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::isPositiveDefinite() const {
+        return _isPositiveDefinite;
+    }
+
+    template <class Value>
+    Dimension BasicCholeskyDecomposition<Value>::size() const {
+        return _lower.rowCount();
+    }
+
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::solve(BasicMatrix<Value>& rightHandSides) const {
+        assert(rightHandSides.rowCount() == size());
+        if (!_isPositiveDefinite) return false;
+        const Dimension columns = rightHandSides.columnCount();
+        Value* values = rightHandSides.data();
+        for (Dimension column = 0; column < columns; column += SolveBlockColumns) {
+            substitute(values + column, columns, columns - column < SolveBlockColumns ? columns - column : SolveBlockColumns);
+        }
+        return true;
+    }
+
+    /// @brief Solve without touching the right hand sides. The result can be reused over calls, so this doesn't allocate.
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::solve(const BasicMatrix<Value>& rightHandSides, BasicMatrix<Value>& result) const {
+        assert(result.sizeIsEqual(rightHandSides));
+        if (!_isPositiveDefinite) return false;
+        result = rightHandSides;
+        return solve(result);
+    }
+
+    /// @brief Right looking blocked factorization of the lower triangle, in place. Per diagonal block of BlockSize:
+    /// factor the block itself, solve the panel below it, and subtract the panel's contribution from the trailing lower triangle.
+    /// Row-major storage, so all inner loops are dot products over contiguous parts of two rows.
+    /// A pivot counts as positive if it exceeds Epsilon times the largest diagonal element of A, so the test scales with the
+    /// matrix: a covariance matrix of tiny values is still positive definite, and a large one with a rounding level pivot isn't.
+    /// @return false as soon as a pivot isn't positive; the values are then partly factorized
+    template <class Value>
+    bool BasicCholeskyDecomposition<Value>::factorize(Value* values, const Dimension size) {
+        const auto row = [=](const Dimension index) { return values + index * size; };
+        const auto dot = [](const Value* left, const Value* right, const Dimension begin, const Dimension end) {
+            Value sum = 0;
+            for (Dimension index = begin; index < end; index++) {
+                sum += left[index] * right[index];
+            }
+            return sum;
+        };
+
+        // the diagonal gets overwritten by the trailing updates, so take its scale up front
+        Value scale = 0;
+        for (Dimension index = 0; index < size; index++) {
+            scale = std::max(scale, std::fabs(row(index)[index]));
+        }
+        const Value minimumPivot = BasicArray<Value>::Epsilon * scale;
+
+        for (Dimension block = 0; block < size; block += BlockSize) {
+            const Dimension blockEnd = size - block < BlockSize ? size : block + BlockSize;
+
+            // diagonal block
+            for (Dimension column = block; column < blockEnd; column++) {
+                Value* columnRow = row(column);
+                const Value pivot = columnRow[column] - dot(columnRow, columnRow, block, column);
+                if (!(pivot > minimumPivot)) return false;
+                columnRow[column] = std::sqrt(pivot);
+                for (Dimension target = column + 1; target < blockEnd; target++) {
+                    Value* targetRow = row(target);
+                    targetRow[column] = (targetRow[column] - dot(targetRow, columnRow, block, column)) / columnRow[column];
+                }
+            }
+
+            // panel below it: L21 = A21 L11^-T
+            for (Dimension target = blockEnd; target < size; target++) {
+                Value* targetRow = row(target);
+                for (Dimension column = block; column < blockEnd; column++) {
+                    const Value* columnRow = row(column);
+                    targetRow[column] = (targetRow[column] - dot(targetRow, columnRow, block, column)) / columnRow[column];
+                }
+            }
+
+            // trailing lower triangle: A22 -= L21 L21^T
+            for (Dimension target = blockEnd; target < size; target++) {
+                Value* targetRow = row(target);
+                for (Dimension column = blockEnd; column <= target; column++) {
+                    targetRow[column] -= dot(targetRow, row(column), block, blockEnd);
+                }
+            }
+        }
+
+        // the upper triangle still holds A
+        for (Dimension target = 0; target < size; target++) {
+            Value* targetRow = row(target);
+            for (Dimension column = target + 1; column < size; column++) {
+                targetRow[column] = 0;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Forward substitution with L (L Y = B), then backward with L^T (L^T X = Y), on a panel of width columns.
+    /// Row operations only, so the inner loops run over contiguous memory.
+    template <class Value>
+    void BasicCholeskyDecomposition<Value>::substitute(Value* panel, const Dimension stride, const Dimension width) const {
+        const Dimension n = size();
+        const Value* lower = _lower.data();
+
+        for (Dimension row = 0; row < n; row++) {
+            Value* targetRow = panel + row * stride;
+            for (Dimension k = 0; k < row; k++) {
+                const Value factor = lower[row * n + k];
+                if (factor == 0.0) continue;
+                const Value* sourceRow = panel + k * stride;
+                for (Dimension column = 0; column < width; column++) {
+                    targetRow[column] -= factor * sourceRow[column];
+                }
+            }
+            const Value divisor = lower[row * n + row];
+            for (Dimension column = 0; column < width; column++) {
+                targetRow[column] /= divisor;
+            }
+        }
+
+        for (Dimension row = n; row-- > 0;) {
+            Value* targetRow = panel + row * stride;
+            for (Dimension k = row + 1; k < n; k++) {
+                const Value factor = lower[k * n + row];
+                if (factor == 0.0) continue;
+                const Value* sourceRow = panel + k * stride;
+                for (Dimension column = 0; column < width; column++) {
+                    targetRow[column] -= factor * sourceRow[column];
+                }
+            }
+            const Value divisor = lower[row * n + row];
+            for (Dimension column = 0; column < width; column++) {
+                targetRow[column] /= divisor;
+            }
+        }
+    }
+
+    template class BasicCholeskyDecomposition<float>;
+    template class BasicCholeskyDecomposition<double>;
+}
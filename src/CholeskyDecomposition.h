@@ -0,0 +1,71 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef CHOLESKYDECOMPOSITION_H
+#define CHOLESKYDECOMPOSITION_H
+
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Cholesky decomposition A = L L^T of a symmetric positive definite matrix (e.g. a covariance matrix).
+    /// About half the work of an LU decomposition, and no pivoting. Only the lower triangle of A is read.
+    /// If A turns out not to be positive definite, isPositiveDefinite returns false, so decompose doubles as a cheap check.
+    /// As with LuDecomposition, the workspace can be reused: construct with a size and call decompose.
+    template <class Value>
+    class BasicCholeskyDecomposition {
+    public:
+        explicit BasicCholeskyDecomposition(Dimension size);
+        explicit BasicCholeskyDecomposition(const BasicMatrix<Value>& matrix);
+
+        // decompose another matrix of the same size. Returns whether it is positive definite.
+        bool decompose(const BasicMatrix<Value>& matrix);
+
+        // overwrite the matrix with L (the upper triangle becomes 0), without a workspace. Returns whether it is positive definite;
+        // if not, the matrix is left partly factorized.
+        static bool decomposeInPlace(BasicMatrix<Value>& matrix);
+
+        Value getDeterminant() const;
+        bool getInverse(BasicMatrix<Value>& result) const;
+        // log of the determinant, which doesn't overflow or underflow for large matrices
+        Value getLogDeterminant() const;
+        const BasicMatrix<Value>& getLower() const;
+        bool isPositiveDefinite() const;
+        Dimension size() const;
+
+        // solve A X = B for all columns of B at once, overwriting B with X
+        bool solve(BasicMatrix<Value>& rightHandSides) const;
+        // same, into an existing result with the size of B
+        bool solve(const BasicMatrix<Value>& rightHandSides, BasicMatrix<Value>& result) const;
+
+        // rows and columns per diagonal block of the factorization
+        static constexpr Dimension BlockSize = 64;
+        // right hand side columns per panel in solve
+        static constexpr Dimension SolveBlockColumns = 64;
+
+    private:
+        static bool factorize(Value* values, Dimension size);
+        void substitute(Value* panel, Dimension stride, Dimension width) const;
+
+        BasicMatrix<Value> _lower;
+        bool _isPositiveDefinite = false;
+    };
+
+    template <class Value>
+    constexpr Dimension BasicCholeskyDecomposition<Value>::BlockSize;
+
+    template <class Value>
+    constexpr Dimension BasicCholeskyDecomposition<Value>::SolveBlockColumns;
+
+    using CholeskyDecomposition = BasicCholeskyDecomposition<double>;
+    using FloatCholeskyDecomposition = BasicCholeskyDecomposition<float>;
+}
+#endif
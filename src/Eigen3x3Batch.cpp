@@ -0,0 +1,211 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "Eigen3x3Batch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace RixMatrix {
+
+    namespace {
+        constexpr Dimension Lanes = Eigen3x3Batch::ChunkSize;
+
+        // relative tolerances for a (numerically) positive discriminant and for a rank deficient A - lambda I
+        constexpr double DiscriminantTolerance = 1e-10;
+        constexpr double RankTolerance = 1e-10;
+
+        // The loops run over the lanes of a chunk with only selects (?:) in their bodies, and work on local
+        // arrays only (no aliasing), which is what the auto vectorizers need.
+        struct Chunk {
+            double a[3][3][Lanes];
+            double value[3][Lanes];
+            double vector[3][3][Lanes];
+        };
+
+        void load(const Eigen3x3Batch::Input& input, const Dimension offset, const Dimension count, Chunk& chunk) {
+            for (Dimension row = 0; row < 3; row++) {
+                for (Dimension column = 0; column < 3; column++) {
+                    const double* source = input.element[row][column] + offset;
+                    double* target = chunk.a[row][column];
+                    for (Dimension lane = 0; lane < count; lane++) target[lane] = source[lane];
+                }
+            }
+        }
+
+        /// @brief Same characteristic polynomial and cubic formula as SolverMatrix::getEigenvalues.
+        /// The transcendental functions have no vector versions we can rely on, so they get a loop of their own,
+        /// and the arithmetic around them stays vectorizable.
+        void computeEigenvalues(Chunk& chunk, const Dimension count) {
+            const auto& a = chunk.a;
+            auto& minusQ = chunk.value[0];
+            auto& r = chunk.value[1];
+            auto& offset = chunk.value[2];
+            for (Dimension lane = 0; lane < count; lane++) {
+                const double a00 = a[0][0][lane], a01 = a[0][1][lane], a02 = a[0][2][lane];
+                const double a10 = a[1][0][lane], a11 = a[1][1][lane], a12 = a[1][2][lane];
+                const double a20 = a[2][0][lane], a21 = a[2][1][lane], a22 = a[2][2][lane];
+
+                const double trace = a00 + a11 + a22;
+                const double minorSum = a00 * a11 - a01 * a10 + a00 * a22 - a02 * a20 + a11 * a22 - a12 * a21;
+                const double determinant = a00 * (a11 * a22 - a12 * a21) - a01 * (a10 * a22 - a12 * a20) + a02 * (a10 * a21 - a11 * a20);
+
+                // x^3 + a2 x^2 + a1 x + a0
+                const double a2 = -trace;
+                const double a1 = minorSum;
+                const double a0 = -determinant;
+                minusQ[lane] = -(3 * a1 - a2 * a2) / 9.0;
+                r[lane] = (9 * a2 * a1 - 27 * a0 - 2 * a2 * a2 * a2) / 54.0;
+                offset[lane] = trace / 3.0;
+            }
+
+            const double pi = acos(-1.0);
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            for (Dimension lane = 0; lane < count; lane++) {
+                const double minusQCubed = minusQ[lane] * minusQ[lane] * minusQ[lane];
+                const double rSquared = r[lane] * r[lane];
+                const double discriminant = rSquared - minusQCubed;
+                const double laneOffset = offset[lane];
+                if (discriminant > DiscriminantTolerance * (rSquared + std::max(minusQCubed, 0.0))) {
+                    // one real root and a complex conjugate pair
+                    const double rootDiscriminant = sqrt(discriminant);
+                    chunk.value[0][lane] = cbrt(r[lane] + rootDiscriminant) + cbrt(r[lane] - rootDiscriminant) + laneOffset;
+                    chunk.value[1][lane] = nan;
+                    chunk.value[2][lane] = nan;
+                    continue;
+                }
+                // three real roots (some of which may coincide)
+                const double ratio = minusQCubed > 0 ? std::min(std::max(r[lane] / sqrt(minusQCubed), -1.0), 1.0) : 0.0;
+                const double theta = acos(ratio);
+                const double factor = 2 * sqrt(std::max(minusQ[lane], 0.0));
+                chunk.value[0][lane] = factor * cos(theta / 3.0) + laneOffset;
+                chunk.value[1][lane] = factor * cos((theta + 2 * pi) / 3.0) + laneOffset;
+                chunk.value[2][lane] = factor * cos((theta + 4 * pi) / 3.0) + laneOffset;
+            }
+        }
+
+        /// @brief The eigenvector is orthogonal to the rows of A - lambda I, so it is the largest cross product of two rows.
+        /// If all cross products vanish, the eigenvalue is repeated. Then the last eigenvector is the cross product of the
+        /// other two, and the others are taken orthogonal to the largest row (or a unit vector if A - lambda I is 0).
+        void computeEigenvector(Chunk& chunk, const Dimension index, const Dimension count) {
+            const auto& a = chunk.a;
+            auto& vector = chunk.vector;
+            for (Dimension lane = 0; lane < count; lane++) {
+                const double lambda = chunk.value[index][lane];
+                const double r00 = a[0][0][lane] - lambda, r01 = a[0][1][lane], r02 = a[0][2][lane];
+                const double r10 = a[1][0][lane], r11 = a[1][1][lane] - lambda, r12 = a[1][2][lane];
+                const double r20 = a[2][0][lane], r21 = a[2][1][lane], r22 = a[2][2][lane] - lambda;
+
+                // cross products of the row pairs
+                const double c0x = r01 * r12 - r02 * r11, c0y = r02 * r10 - r00 * r12, c0z = r00 * r11 - r01 * r10;
+                const double c1x = r01 * r22 - r02 * r21, c1y = r02 * r20 - r00 * r22, c1z = r00 * r21 - r01 * r20;
+                const double c2x = r11 * r22 - r12 * r21, c2y = r12 * r20 - r10 * r22, c2z = r10 * r21 - r11 * r20;
+                const double n0 = c0x * c0x + c0y * c0y + c0z * c0z;
+                const double n1 = c1x * c1x + c1y * c1y + c1z * c1z;
+                const double n2 = c2x * c2x + c2y * c2y + c2z * c2z;
+                const bool use1 = n1 > n0;
+                double x = use1 ? c1x : c0x, y = use1 ? c1y : c0y, z = use1 ? c1z : c0z;
+                double best = use1 ? n1 : n0;
+                const bool use2 = n2 > best;
+                x = use2 ? c2x : x;
+                y = use2 ? c2y : y;
+                z = use2 ? c2z : z;
+                best = use2 ? n2 : best;
+
+                // largest row, to test the rank against and for the fallback
+                const double m0 = r00 * r00 + r01 * r01 + r02 * r02;
+                const double m1 = r10 * r10 + r11 * r11 + r12 * r12;
+                const double m2 = r20 * r20 + r21 * r21 + r22 * r22;
+                const bool row1 = m1 > m0;
+                double rx = row1 ? r10 : r00, ry = row1 ? r11 : r01, rz = row1 ? r12 : r02;
+                double rowNorm = row1 ? m1 : m0;
+                const bool row2 = m2 > rowNorm;
+                rx = row2 ? r20 : rx;
+                ry = row2 ? r21 : ry;
+                rz = row2 ? r22 : rz;
+                rowNorm = row2 ? m2 : rowNorm;
+                const bool isDegenerate = best <= RankTolerance * RankTolerance * rowNorm * rowNorm;
+
+                double fx, fy, fz;
+                if (index == 2) {
+                    // the same for all lanes, so not a branch in the vectorized loop
+                    fx = vector[0][1][lane] * vector[1][2][lane] - vector[0][2][lane] * vector[1][1][lane];
+                    fy = vector[0][2][lane] * vector[1][0][lane] - vector[0][0][lane] * vector[1][2][lane];
+                    fz = vector[0][0][lane] * vector[1][1][lane] - vector[0][1][lane] * vector[1][0][lane];
+                }
+                else {
+                    // cross product with the unit vector along the smallest component of the row
+                    const double ax = fabs(rx), ay = fabs(ry), az = fabs(rz);
+                    const bool alongX = ax <= ay && ax <= az;
+                    const bool alongY = !alongX && ay <= az;
+                    const bool alongZ = !alongX && !alongY;
+                    fx = alongY ? -rz : (alongZ ? ry : 0.0);
+                    fy = alongX ? rz : (alongZ ? -rx : 0.0);
+                    fz = alongX ? -ry : (alongY ? rx : 0.0);
+                    // A - lambda I is 0: any vector will do, so take the unit vectors
+                    const bool isZero = rowNorm == 0.0;
+                    fx = isZero ? (index == 0 ? 1.0 : 0.0) : fx;
+                    fy = isZero ? (index == 1 ? 1.0 : 0.0) : fy;
+                    fz = isZero ? 0.0 : fz;
+                }
+                x = isDegenerate ? fx : x;
+                y = isDegenerate ? fy : y;
+                z = isDegenerate ? fz : z;
+
+                double norm = sqrt(x * x + y * y + z * z);
+                norm = x < 0 ? -norm : norm;
+                vector[index][0][lane] = x / norm;
+                vector[index][1][lane] = y / norm;
+                vector[index][2][lane] = z / norm;
+            }
+        }
+
+        void storeEigenvalues(const Chunk& chunk, const Dimension offset, const Dimension count, const Eigen3x3Batch::Output& output) {
+            for (Dimension index = 0; index < 3; index++) {
+                double* target = output.eigenvalue[index] + offset;
+                for (Dimension lane = 0; lane < count; lane++) target[lane] = chunk.value[index][lane];
+            }
+        }
+
+        void storeEigenvectors(const Chunk& chunk, const Dimension offset, const Dimension count, const Eigen3x3Batch::Output& output) {
+            for (Dimension index = 0; index < 3; index++) {
+                for (Dimension component = 0; component < 3; component++) {
+                    double* target = output.eigenvector[index][component] + offset;
+                    for (Dimension lane = 0; lane < count; lane++) target[lane] = chunk.vector[index][component][lane];
+                }
+            }
+        }
+    }
+
+    void Eigen3x3Batch::getEigenvalues(const Input& input, const Output& output, const Dimension count) {
+        Chunk chunk;
+        for (Dimension offset = 0; offset < count; offset += Lanes) {
+            const Dimension lanes = std::min(Lanes, count - offset);
+            load(input, offset, lanes, chunk);
+            computeEigenvalues(chunk, lanes);
+            storeEigenvalues(chunk, offset, lanes, output);
+        }
+    }
+
+    void Eigen3x3Batch::getEigenvectors(const Input& input, const Output& output, const Dimension count) {
+        Chunk chunk;
+        for (Dimension offset = 0; offset < count; offset += Lanes) {
+            const Dimension lanes = std::min(Lanes, count - offset);
+            load(input, offset, lanes, chunk);
+            computeEigenvalues(chunk, lanes);
+            for (Dimension index = 0; index < 3; index++) {
+                computeEigenvector(chunk, index, lanes);
+            }
+            storeEigenvalues(chunk, offset, lanes, output);
+            storeEigenvectors(chunk, offset, lanes, output);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef EIGEN3X3BATCH_H
+#define EIGEN3X3BATCH_H
+
+#include "Array.h"
+
+namespace RixMatrix {
+
+    /// Eigenvalues and eigenvectors of many independent 3x3 matrices at once, in structure of arrays layout:
+    /// every matrix element (and every output value) has its own array with one entry per matrix.
+    /// The closed forms of SolverMatrix are evaluated without branches on consecutive matrices,
+    /// so the compiler can run them lane parallel in SIMD registers. Nothing gets allocated.
+    ///
+    /// Eigenvalues come in the same order as SolverMatrix::getEigenvalues. Eigenvectors are normalized with
+    /// a non-negative first element, as Matrix::normalized does. Matrices with repeated eigenvalues
+    /// still get three eigenvectors (orthonormal for symmetric matrices).
+    /// If a matrix has complex eigenvalues, only the first eigenvalue is set (to the real one), the rest is NaN.
+    class Eigen3x3Batch {
+    public:
+        /// element[row][column] points to the values of that element for all matrices
+        struct Input {
+            const double* element[3][3];
+        };
+
+        /// eigenvalue[i] gets eigenvalue i of all matrices, eigenvector[i][component] component of the matching eigenvector
+        struct Output {
+            double* eigenvalue[3];
+            double* eigenvector[3][3];
+        };
+
+        // only fills the eigenvalues of the output
+        static void getEigenvalues(const Input& input, const Output& output, Dimension count);
+        static void getEigenvectors(const Input& input, const Output& output, Dimension count);
+
+        // number of matrices processed together; their intermediate values stay in L1 cache
+        static constexpr Dimension ChunkSize = 64;
+    };
+}
+#endif
@@ -0,0 +1,678 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "ElementKernels.h"
+#include "ThreadPool.h"
+
+// SSE2 is part of the x86-64 baseline, so that is where we enable the vector kernels.
+// AVX2 and AVX-512 code is compiled with target attributes (gcc/clang) so the library itself doesn't need -mavx flags.
+#if defined(__x86_64__) || defined(_M_X64)
+#define RIXMATRIX_X86_64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RIXMATRIX_TARGET(isa)
+#else
+#define RIXMATRIX_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace RixMatrix {
+
+    namespace {
+        template <class Value>
+        using BinaryKernel = void (*)(Value*, const Value*, Dimension);
+        template <class Value>
+        using ScalarKernel = void (*)(Value*, Value, Dimension);
+        template <class Value>
+        using ReduceKernel = Value (*)(const Value*, Dimension);
+
+        template <class Value>
+        struct KernelTable {
+            InstructionSet instructionSet;
+            BinaryKernel<Value> add;
+            BinaryKernel<Value> subtract;
+            BinaryKernel<Value> multiply;
+            ScalarKernel<Value> addScalar;
+            ScalarKernel<Value> multiplyScalar;
+            ScalarKernel<Value> divideScalar;
+            BinaryKernel<Value> square;
+            ReduceKernel<Value> sumOfSquares;
+        };
+
+        // *** Scalar ***
+
+        template <class Value>
+        void addScalarLoop(Value* target, const Value* source, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] += source[i];
+        }
+
+        template <class Value>
+        void subtractScalarLoop(Value* target, const Value* source, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] -= source[i];
+        }
+
+        template <class Value>
+        void multiplyScalarLoop(Value* target, const Value* source, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] *= source[i];
+        }
+
+        template <class Value>
+        void addValueScalarLoop(Value* target, const Value value, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] += value;
+        }
+
+        template <class Value>
+        void multiplyValueScalarLoop(Value* target, const Value value, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] *= value;
+        }
+
+        template <class Value>
+        void divideValueScalarLoop(Value* target, const Value value, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] /= value;
+        }
+
+        template <class Value>
+        void squareScalarLoop(Value* target, const Value* source, const Dimension count) {
+            for (Dimension i = 0; i < count; i++) target[i] = source[i] * source[i];
+        }
+
+        template <class Value>
+        Value sumOfSquaresScalarLoop(const Value* source, const Dimension count) {
+            Value result = 0;
+            for (Dimension i = 0; i < count; i++) result += source[i] * source[i];
+            return result;
+        }
+
+        template <class Value>
+        const KernelTable<Value>* scalarKernels() {
+            static const KernelTable<Value> kernels = {
+                InstructionSet::Scalar,
+                addScalarLoop<Value>, subtractScalarLoop<Value>, multiplyScalarLoop<Value>,
+                addValueScalarLoop<Value>, multiplyValueScalarLoop<Value>, divideValueScalarLoop<Value>,
+                squareScalarLoop<Value>, sumOfSquaresScalarLoop<Value>
+            };
+            return &kernels;
+        }
+
+#ifdef RIXMATRIX_X86_64
+
+        // The registers and intrinsics of an instruction set, for doubles and for floats.
+        // The kernels below are written once against these, so float gets twice the lanes of double.
+
+        template <class Value>
+        struct Sse2;
+
+        template <>
+        struct Sse2<double> {
+            using Register = __m128d;
+            static constexpr Dimension Width = 2;
+            static Register load(const double* source) { return _mm_loadu_pd(source); }
+            static void store(double* target, const Register value) { _mm_storeu_pd(target, value); }
+            static Register set(const double value) { return _mm_set1_pd(value); }
+            static Register zero() { return _mm_setzero_pd(); }
+            static Register add(const Register left, const Register right) { return _mm_add_pd(left, right); }
+            static Register subtract(const Register left, const Register right) { return _mm_sub_pd(left, right); }
+            static Register multiply(const Register left, const Register right) { return _mm_mul_pd(left, right); }
+            static Register divide(const Register left, const Register right) { return _mm_div_pd(left, right); }
+        };
+
+        template <>
+        struct Sse2<float> {
+            using Register = __m128;
+            static constexpr Dimension Width = 4;
+            static Register load(const float* source) { return _mm_loadu_ps(source); }
+            static void store(float* target, const Register value) { _mm_storeu_ps(target, value); }
+            static Register set(const float value) { return _mm_set1_ps(value); }
+            static Register zero() { return _mm_setzero_ps(); }
+            static Register add(const Register left, const Register right) { return _mm_add_ps(left, right); }
+            static Register subtract(const Register left, const Register right) { return _mm_sub_ps(left, right); }
+            static Register multiply(const Register left, const Register right) { return _mm_mul_ps(left, right); }
+            static Register divide(const Register left, const Register right) { return _mm_div_ps(left, right); }
+        };
+
+        template <class Value>
+        struct Avx2;
+
+        template <>
+        struct Avx2<double> {
+            using Register = __m256d;
+            static constexpr Dimension Width = 4;
+            RIXMATRIX_TARGET("avx2") static Register load(const double* source) { return _mm256_loadu_pd(source); }
+            RIXMATRIX_TARGET("avx2") static void store(double* target, const Register value) { _mm256_storeu_pd(target, value); }
+            RIXMATRIX_TARGET("avx2") static Register set(const double value) { return _mm256_set1_pd(value); }
+            RIXMATRIX_TARGET("avx2") static Register zero() { return _mm256_setzero_pd(); }
+            RIXMATRIX_TARGET("avx2") static Register add(const Register left, const Register right) { return _mm256_add_pd(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register subtract(const Register left, const Register right) { return _mm256_sub_pd(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register multiply(const Register left, const Register right) { return _mm256_mul_pd(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register divide(const Register left, const Register right) { return _mm256_div_pd(left, right); }
+        };
+
+        template <>
+        struct Avx2<float> {
+            using Register = __m256;
+            static constexpr Dimension Width = 8;
+            RIXMATRIX_TARGET("avx2") static Register load(const float* source) { return _mm256_loadu_ps(source); }
+            RIXMATRIX_TARGET("avx2") static void store(float* target, const Register value) { _mm256_storeu_ps(target, value); }
+            RIXMATRIX_TARGET("avx2") static Register set(const float value) { return _mm256_set1_ps(value); }
+            RIXMATRIX_TARGET("avx2") static Register zero() { return _mm256_setzero_ps(); }
+            RIXMATRIX_TARGET("avx2") static Register add(const Register left, const Register right) { return _mm256_add_ps(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register subtract(const Register left, const Register right) { return _mm256_sub_ps(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register multiply(const Register left, const Register right) { return _mm256_mul_ps(left, right); }
+            RIXMATRIX_TARGET("avx2") static Register divide(const Register left, const Register right) { return _mm256_div_ps(left, right); }
+        };
+
+        template <class Value>
+        struct Avx512;
+
+        template <>
+        struct Avx512<double> {
+            using Register = __m512d;
+            static constexpr Dimension Width = 8;
+            RIXMATRIX_TARGET("avx512f") static Register load(const double* source) { return _mm512_loadu_pd(source); }
+            RIXMATRIX_TARGET("avx512f") static void store(double* target, const Register value) { _mm512_storeu_pd(target, value); }
+            RIXMATRIX_TARGET("avx512f") static Register set(const double value) { return _mm512_set1_pd(value); }
+            RIXMATRIX_TARGET("avx512f") static Register zero() { return _mm512_setzero_pd(); }
+            RIXMATRIX_TARGET("avx512f") static Register add(const Register left, const Register right) { return _mm512_add_pd(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register subtract(const Register left, const Register right) { return _mm512_sub_pd(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register multiply(const Register left, const Register right) { return _mm512_mul_pd(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register divide(const Register left, const Register right) { return _mm512_div_pd(left, right); }
+        };
+
+        template <>
+        struct Avx512<float> {
+            using Register = __m512;
+            static constexpr Dimension Width = 16;
+            RIXMATRIX_TARGET("avx512f") static Register load(const float* source) { return _mm512_loadu_ps(source); }
+            RIXMATRIX_TARGET("avx512f") static void store(float* target, const Register value) { _mm512_storeu_ps(target, value); }
+            RIXMATRIX_TARGET("avx512f") static Register set(const float value) { return _mm512_set1_ps(value); }
+            RIXMATRIX_TARGET("avx512f") static Register zero() { return _mm512_setzero_ps(); }
+            RIXMATRIX_TARGET("avx512f") static Register add(const Register left, const Register right) { return _mm512_add_ps(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register subtract(const Register left, const Register right) { return _mm512_sub_ps(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register multiply(const Register left, const Register right) { return _mm512_mul_ps(left, right); }
+            RIXMATRIX_TARGET("avx512f") static Register divide(const Register left, const Register right) { return _mm512_div_ps(left, right); }
+        };
+
+        // *** SSE2 (2 doubles or 4 floats per register) ***
+
+        template <class Value>
+        void addSse2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Sse2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), Vector::load(source + i)));
+            }
+            addScalarLoop(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        void subtractSse2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Sse2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::subtract(Vector::load(target + i), Vector::load(source + i)));
+            }
+            subtractScalarLoop(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        void multiplySse2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Sse2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), Vector::load(source + i)));
+            }
+            multiplyScalarLoop(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        void addValueSse2(Value* target, const Value value, const Dimension count) {
+            using Vector = Sse2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), values));
+            }
+            addValueScalarLoop(target + i, value, count - i);
+        }
+
+        template <class Value>
+        void multiplyValueSse2(Value* target, const Value value, const Dimension count) {
+            using Vector = Sse2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), values));
+            }
+            multiplyValueScalarLoop(target + i, value, count - i);
+        }
+
+        template <class Value>
+        void divideValueSse2(Value* target, const Value value, const Dimension count) {
+            using Vector = Sse2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::divide(Vector::load(target + i), values));
+            }
+            divideValueScalarLoop(target + i, value, count - i);
+        }
+
+        template <class Value>
+        void squareSse2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Sse2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                const typename Vector::Register values = Vector::load(source + i);
+                Vector::store(target + i, Vector::multiply(values, values));
+            }
+            squareScalarLoop(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        Value sumOfSquaresSse2(const Value* source, const Dimension count) {
+            using Vector = Sse2<Value>;
+            // two accumulators to hide the latency of the adds
+            typename Vector::Register sum1 = Vector::zero();
+            typename Vector::Register sum2 = Vector::zero();
+            Dimension i = 0;
+            for (; i + 2 * Vector::Width <= count; i += 2 * Vector::Width) {
+                const typename Vector::Register values1 = Vector::load(source + i);
+                const typename Vector::Register values2 = Vector::load(source + i + Vector::Width);
+                sum1 = Vector::add(sum1, Vector::multiply(values1, values1));
+                sum2 = Vector::add(sum2, Vector::multiply(values2, values2));
+            }
+            Value parts[Vector::Width];
+            Vector::store(parts, Vector::add(sum1, sum2));
+            Value result = 0;
+            for (const Value part : parts) result += part;
+            return result + sumOfSquaresScalarLoop(source + i, count - i);
+        }
+
+        template <class Value>
+        const KernelTable<Value>* sse2Kernels() {
+            static const KernelTable<Value> kernels = {
+                InstructionSet::Sse2,
+                addSse2<Value>, subtractSse2<Value>, multiplySse2<Value>,
+                addValueSse2<Value>, multiplyValueSse2<Value>, divideValueSse2<Value>,
+                squareSse2<Value>, sumOfSquaresSse2<Value>
+            };
+            return &kernels;
+        }
+
+        // *** AVX2 (4 doubles or 8 floats per register) ***
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void addAvx2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), Vector::load(source + i)));
+            }
+            addSse2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void subtractAvx2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::subtract(Vector::load(target + i), Vector::load(source + i)));
+            }
+            subtractSse2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void multiplyAvx2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), Vector::load(source + i)));
+            }
+            multiplySse2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void addValueAvx2(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), values));
+            }
+            addValueSse2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void multiplyValueAvx2(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), values));
+            }
+            multiplyValueSse2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void divideValueAvx2(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx2<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::divide(Vector::load(target + i), values));
+            }
+            divideValueSse2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") void squareAvx2(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx2<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                const typename Vector::Register values = Vector::load(source + i);
+                Vector::store(target + i, Vector::multiply(values, values));
+            }
+            squareSse2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx2") Value sumOfSquaresAvx2(const Value* source, const Dimension count) {
+            using Vector = Avx2<Value>;
+            typename Vector::Register sum1 = Vector::zero();
+            typename Vector::Register sum2 = Vector::zero();
+            Dimension i = 0;
+            for (; i + 2 * Vector::Width <= count; i += 2 * Vector::Width) {
+                const typename Vector::Register values1 = Vector::load(source + i);
+                const typename Vector::Register values2 = Vector::load(source + i + Vector::Width);
+                sum1 = Vector::add(sum1, Vector::multiply(values1, values1));
+                sum2 = Vector::add(sum2, Vector::multiply(values2, values2));
+            }
+            Value parts[Vector::Width];
+            Vector::store(parts, Vector::add(sum1, sum2));
+            Value result = 0;
+            for (const Value part : parts) result += part;
+            return result + sumOfSquaresSse2(source + i, count - i);
+        }
+
+        template <class Value>
+        const KernelTable<Value>* avx2Kernels() {
+            static const KernelTable<Value> kernels = {
+                InstructionSet::Avx2,
+                addAvx2<Value>, subtractAvx2<Value>, multiplyAvx2<Value>,
+                addValueAvx2<Value>, multiplyValueAvx2<Value>, divideValueAvx2<Value>,
+                squareAvx2<Value>, sumOfSquaresAvx2<Value>
+            };
+            return &kernels;
+        }
+
+        // *** AVX-512 (8 doubles or 16 floats per register) ***
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void addAvx512(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx512<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), Vector::load(source + i)));
+            }
+            addAvx2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void subtractAvx512(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx512<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::subtract(Vector::load(target + i), Vector::load(source + i)));
+            }
+            subtractAvx2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void multiplyAvx512(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx512<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), Vector::load(source + i)));
+            }
+            multiplyAvx2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void addValueAvx512(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx512<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::add(Vector::load(target + i), values));
+            }
+            addValueAvx2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void multiplyValueAvx512(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx512<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::multiply(Vector::load(target + i), values));
+            }
+            multiplyValueAvx2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void divideValueAvx512(Value* target, const Value value, const Dimension count) {
+            using Vector = Avx512<Value>;
+            const typename Vector::Register values = Vector::set(value);
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                Vector::store(target + i, Vector::divide(Vector::load(target + i), values));
+            }
+            divideValueAvx2(target + i, value, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") void squareAvx512(Value* target, const Value* source, const Dimension count) {
+            using Vector = Avx512<Value>;
+            Dimension i = 0;
+            for (; i + Vector::Width <= count; i += Vector::Width) {
+                const typename Vector::Register values = Vector::load(source + i);
+                Vector::store(target + i, Vector::multiply(values, values));
+            }
+            squareAvx2(target + i, source + i, count - i);
+        }
+
+        template <class Value>
+        RIXMATRIX_TARGET("avx512f") Value sumOfSquaresAvx512(const Value* source, const Dimension count) {
+            using Vector = Avx512<Value>;
+            typename Vector::Register sum1 = Vector::zero();
+            typename Vector::Register sum2 = Vector::zero();
+            Dimension i = 0;
+            for (; i + 2 * Vector::Width <= count; i += 2 * Vector::Width) {
+                const typename Vector::Register values1 = Vector::load(source + i);
+                const typename Vector::Register values2 = Vector::load(source + i + Vector::Width);
+                sum1 = Vector::add(sum1, Vector::multiply(values1, values1));
+                sum2 = Vector::add(sum2, Vector::multiply(values2, values2));
+            }
+            Value parts[Vector::Width];
+            Vector::store(parts, Vector::add(sum1, sum2));
+            Value result = 0;
+            for (const Value part : parts) result += part;
+            return result + sumOfSquaresAvx2(source + i, count - i);
+        }
+
+        template <class Value>
+        const KernelTable<Value>* avx512Kernels() {
+            static const KernelTable<Value> kernels = {
+                InstructionSet::Avx512,
+                addAvx512<Value>, subtractAvx512<Value>, multiplyAvx512<Value>,
+                addValueAvx512<Value>, multiplyValueAvx512<Value>, divideValueAvx512<Value>,
+                squareAvx512<Value>, sumOfSquaresAvx512<Value>
+            };
+            return &kernels;
+        }
+
+        // the OS must save the wide registers too, that is why we check XCR0 and not just the CPUID feature bits
+        InstructionSet detectInstructionSet() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x06) == 0x06;
+            if (!osSavesYmm || maxLeaf < 7) return InstructionSet::Sse2;
+            __cpuidex(info, 7, 0);
+            const bool hasAvx2 = (info[1] & (1 << 5)) != 0;
+            const bool hasAvx512 = (info[1] & (1 << 16)) != 0 && (_xgetbv(0) & 0xE6) == 0xE6;
+            if (hasAvx512) return InstructionSet::Avx512;
+            return hasAvx2 ? InstructionSet::Avx2 : InstructionSet::Sse2;
+#else
+            // gcc and clang check the OS support as part of this
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return InstructionSet::Avx512;
+            if (__builtin_cpu_supports("avx2")) return InstructionSet::Avx2;
+            return InstructionSet::Sse2;
+#endif
+        }
+#else
+        InstructionSet detectInstructionSet() {
+            return InstructionSet::Scalar;
+        }
+#endif
+
+        template <class Value>
+        const KernelTable<Value>* tableFor(const InstructionSet instructionSet) {
+            switch (instructionSet) {
+#ifdef RIXMATRIX_X86_64
+            case InstructionSet::Avx512: return avx512Kernels<Value>();
+            case InstructionSet::Avx2: return avx2Kernels<Value>();
+            case InstructionSet::Sse2: return sse2Kernels<Value>();
+#endif
+            default: return scalarKernels<Value>();
+            }
+        }
+
+        template <class Value>
+        const KernelTable<Value>*& activeKernels() {
+            static const KernelTable<Value>* kernels = tableFor<Value>(ElementKernels::getBestInstructionSet());
+            return kernels;
+        }
+
+        /// @brief Large ranges are split over the thread pool (if enabled) in fixed size chunks; small ones stay on this thread.
+        /// Each element is handled by exactly one chunk, so the results don't depend on the thread count.
+        template <class Value>
+        void run(const BinaryKernel<Value> kernel, Value* target, const Value* source, const Dimension count) {
+            ThreadPool& pool = ThreadPool::instance();
+            if (count < ElementKernels::ParallelLimit || !pool.isParallel()) {
+                kernel(target, source, count);
+                return;
+            }
+            pool.parallelFor(count, ElementKernels::ParallelGrain, [=](const Dimension begin, const Dimension end) {
+                kernel(target + begin, source + begin, end - begin);
+            });
+        }
+
+        template <class Value>
+        void run(const ScalarKernel<Value> kernel, Value* target, const Value value, const Dimension count) {
+            ThreadPool& pool = ThreadPool::instance();
+            if (count < ElementKernels::ParallelLimit || !pool.isParallel()) {
+                kernel(target, value, count);
+                return;
+            }
+            pool.parallelFor(count, ElementKernels::ParallelGrain, [=](const Dimension begin, const Dimension end) {
+                kernel(target + begin, value, end - begin);
+            });
+        }
+    }
+
+    constexpr Dimension ElementKernels::ParallelLimit;
+    constexpr Dimension ElementKernels::ParallelGrain;
+
+    void ElementKernels::add(double* target, const double* source, const Dimension count) {
+        run(activeKernels<double>()->add, target, source, count);
+    }
+
+    void ElementKernels::add(float* target, const float* source, const Dimension count) {
+        run(activeKernels<float>()->add, target, source, count);
+    }
+
+    void ElementKernels::subtract(double* target, const double* source, const Dimension count) {
+        run(activeKernels<double>()->subtract, target, source, count);
+    }
+
+    void ElementKernels::subtract(float* target, const float* source, const Dimension count) {
+        run(activeKernels<float>()->subtract, target, source, count);
+    }
+
+    void ElementKernels::multiply(double* target, const double* source, const Dimension count) {
+        run(activeKernels<double>()->multiply, target, source, count);
+    }
+
+    void ElementKernels::multiply(float* target, const float* source, const Dimension count) {
+        run(activeKernels<float>()->multiply, target, source, count);
+    }
+
+    void ElementKernels::addScalar(double* target, const double value, const Dimension count) {
+        run(activeKernels<double>()->addScalar, target, value, count);
+    }
+
+    void ElementKernels::addScalar(float* target, const float value, const Dimension count) {
+        run(activeKernels<float>()->addScalar, target, value, count);
+    }
+
+    void ElementKernels::multiplyScalar(double* target, const double value, const Dimension count) {
+        run(activeKernels<double>()->multiplyScalar, target, value, count);
+    }
+
+    void ElementKernels::multiplyScalar(float* target, const float value, const Dimension count) {
+        run(activeKernels<float>()->multiplyScalar, target, value, count);
+    }
+
+    void ElementKernels::divideScalar(double* target, const double value, const Dimension count) {
+        run(activeKernels<double>()->divideScalar, target, value, count);
+    }
+
+    void ElementKernels::divideScalar(float* target, const float value, const Dimension count) {
+        run(activeKernels<float>()->divideScalar, target, value, count);
+    }
+
+    void ElementKernels::square(double* target, const double* source, const Dimension count) {
+        run(activeKernels<double>()->square, target, source, count);
+    }
+
+    void ElementKernels::square(float* target, const float* source, const Dimension count) {
+        run(activeKernels<float>()->square, target, source, count);
+    }
+
+    double ElementKernels::sumOfSquares(const double* source, const Dimension count) {
+        return activeKernels<double>()->sumOfSquares(source, count);
+    }
+
+    float ElementKernels::sumOfSquares(const float* source, const Dimension count) {
+        return activeKernels<float>()->sumOfSquares(source, count);
+    }
+
+    InstructionSet ElementKernels::getBestInstructionSet() {
+        static const InstructionSet best = detectInstructionSet();
+        return best;
+    }
+
+    InstructionSet ElementKernels::getInstructionSet() {
+        return activeKernels<double>()->instructionSet;
+    }
+
+    bool ElementKernels::setInstructionSet(const InstructionSet instructionSet) {
+        if (instructionSet > getBestInstructionSet()) return false;
+        activeKernels<double>() = tableFor<double>(instructionSet);
+        activeKernels<float>() = tableFor<float>(instructionSet);
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef ELEMENTKERNELS_H
+#define ELEMENTKERNELS_H
+
+#include "Array.h"
+
+namespace RixMatrix {
+
+    enum class InstructionSet { Scalar, Sse2, Avx2, Avx512 };
+
+    /// Element wise kernels on raw double or float storage, vectorized with SSE2, AVX2 or AVX-512 on x86-64.
+    /// A register holds twice as many floats as doubles, so the float versions process twice the elements per instruction.
+    /// The best instruction set the CPU supports is selected at first use; other platforms (e.g. esp32) use the scalar loops.
+    /// With the ThreadPool enabled, large ranges are also split over its threads (except for the sumOfSquares reduction).
+    class ElementKernels {
+    public:
+        // target[i] op= source[i]
+        static void add(double* target, const double* source, Dimension count);
+        static void add(float* target, const float* source, Dimension count);
+        static void subtract(double* target, const double* source, Dimension count);
+        static void subtract(float* target, const float* source, Dimension count);
+        static void multiply(double* target, const double* source, Dimension count);
+        static void multiply(float* target, const float* source, Dimension count);
+
+        // target[i] op= value
+        static void addScalar(double* target, double value, Dimension count);
+        static void addScalar(float* target, float value, Dimension count);
+        static void multiplyScalar(double* target, double value, Dimension count);
+        static void multiplyScalar(float* target, float value, Dimension count);
+        static void divideScalar(double* target, double value, Dimension count);
+        static void divideScalar(float* target, float value, Dimension count);
+
+        // target[i] = source[i] * source[i]
+        static void square(double* target, const double* source, Dimension count);
+        static void square(float* target, const float* source, Dimension count);
+        static double sumOfSquares(const double* source, Dimension count);
+        static float sumOfSquares(const float* source, Dimension count);
+
+        static InstructionSet getBestInstructionSet();
+        static InstructionSet getInstructionSet();
+
+        // mainly for testing and benchmarking (for both scalar types). Returns false if the CPU doesn't support the instruction set.
+        static bool setInstructionSet(InstructionSet instructionSet);
+
+        // ranges of at least ParallelLimit elements are split in chunks of ParallelGrain when the ThreadPool is enabled.
+        // Below that, the operation is memory bound and finishes before other threads would get started.
+        static constexpr Dimension ParallelLimit = 1 << 16;
+        static constexpr Dimension ParallelGrain = 1 << 14;
+    };
+}
+#endif
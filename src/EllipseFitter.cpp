@@ -0,0 +1,152 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "EllipseFitter.h"
+#include <cassert>
+#include <cmath>
+#include "SolverMatrix.h"
+
+namespace RixMatrix {
+
+    /// @brief Points are stored relative to the first one, so large coordinates don't cancel out in the fourth powers
+    void EllipseFitter::addPoint(const double x, const double y) {
+        if (_pointCount == 0) {
+            _originX = x;
+            _originY = y;
+        }
+        const double u = x - _originX;
+        const double v = y - _originY;
+        const double z[6] = { u * u, u * v, v * v, u, v, 1 };
+        for (Dimension row = 0; row < 6; row++) {
+            for (Dimension column = row; column < 6; column++) {
+                _scatter(row, column) += z[row] * z[column];
+            }
+        }
+        _pointCount++;
+    }
+
+    void EllipseFitter::reset() {
+        _scatter = FixedMatrix<6, 6>();
+        _pointCount = 0;
+    }
+
+    /// @brief Halir and Flusser: split the scatter matrix into S1 (quadratic terms), S2 (mixed) and S3 (linear terms).
+    /// The linear part of the solution follows from the quadratic one as T a1 with T = -S3^-1 S2^T, which leaves
+    /// the 3x3 eigenproblem C1^-1 (S1 + S2 T) a1 = lambda a1. Exactly one eigenvector satisfies the ellipse constraint.
+    /// The scatter matrix is centered and scaled first, which is a linear transformation of it.
+    bool EllipseFitter::fit(Matrix& coefficients) const {
+        assert(coefficients.rowCount() == 6 && coefficients.columnCount() == 1);
+        if (_pointCount < 5) return false;
+
+        const FixedMatrix<6, 6> scatter = getScatterMatrix();
+        const double count = static_cast<double>(_pointCount);
+        const double meanX = scatter(3, 5) / count;
+        const double meanY = scatter(4, 5) / count;
+        const double variance = (scatter(0, 5) / count - meanX * meanX + scatter(2, 5) / count - meanY * meanY) / 2;
+        if (!(variance > Array::Epsilon)) return false;
+
+        const FixedMatrix<6, 6> transformation = getTransformation(meanX, meanY, std::sqrt(variance));
+        const FixedMatrix<6, 6> normalized = transformation * scatter * transformation.transposed() / count;
+
+        FixedMatrix<3, 3> s1;
+        FixedMatrix<3, 3> s2;
+        FixedMatrix<3, 3> s3;
+        for (Dimension row = 0; row < 3; row++) {
+            for (Dimension column = 0; column < 3; column++) {
+                s1(row, column) = normalized(row, column);
+                s2(row, column) = normalized(row, column + 3);
+                s3(row, column) = normalized(row + 3, column + 3);
+            }
+        }
+        if (!s3.isInvertible()) return false;
+        const FixedMatrix<3, 3> t = s3.inverted() * s2.transposed() * -1.0;
+        const FixedMatrix<3, 3> m = s1 + s2 * t;
+
+        // C1^-1 = {{0, 0, 1/2}, {0, -1, 0}, {1/2, 0, 0}}
+        SolverMatrix reduced(Matrix(3, 3));
+        for (Dimension column = 0; column < 3; column++) {
+            reduced(0, column) = m(2, column) / 2;
+            reduced(1, column) = -m(1, column);
+            reduced(2, column) = m(0, column) / 2;
+        }
+
+        FixedMatrix<3, 1> quadratic;
+        bool isFound = false;
+        const Matrix eigenvalues = reduced.getEigenvalues();
+        for (Dimension index = 0; index < eigenvalues.rowCount() && !isFound; index++) {
+            const Matrix eigenvectors = reduced.getEigenvectorFor(eigenvalues(index, 0));
+            for (Dimension column = 0; column < eigenvectors.columnCount() && !isFound; column++) {
+                const double a = eigenvectors(0, column);
+                const double b = eigenvectors(1, column);
+                const double c = eigenvectors(2, column);
+                if (4 * a * c - b * b > 0) {
+                    quadratic = FixedMatrix<3, 1>({ {a}, {b}, {c} });
+                    isFound = true;
+                }
+            }
+        }
+        if (!isFound) return false;
+
+        // back to the coordinates of the scatter matrix, then to the original ones
+        const FixedMatrix<3, 1> linear = t * quadratic;
+        FixedMatrix<6, 1> conic;
+        for (Dimension row = 0; row < 3; row++) {
+            conic(row, 0) = quadratic(row, 0);
+            conic(row + 3, 0) = linear(row, 0);
+        }
+        conic = getTransformation(_originX, _originY, 1).transposed() * (transformation.transposed() * conic);
+
+        double norm = 0;
+        for (Dimension row = 0; row < 6; row++) {
+            norm += conic(row, 0) * conic(row, 0);
+        }
+        norm = std::sqrt(norm);
+        if (conic(0, 0) < 0) norm = -norm;
+        for (Dimension row = 0; row < 6; row++) {
+            coefficients(row, 0) = conic(row, 0) / norm;
+        }
+        return true;
+    }
+
+    /// @brief as fit(Matrix&), but returns a 0x1 matrix if there is no ellipse
+    Matrix EllipseFitter::fit() const {
+        Matrix result(6, 1);
+        if (!fit(result)) result.setRowCount(0);
+        return result;
+    }
+
+    unsigned long EllipseFitter::getPointCount() const {
+        return _pointCount;
+    }
+
+    FixedMatrix<6, 6> EllipseFitter::getScatterMatrix() const {
+        FixedMatrix<6, 6> result = _scatter;
+        for (Dimension row = 1; row < 6; row++) {
+            for (Dimension column = 0; column < row; column++) {
+                result(row, column) = result(column, row);
+            }
+        }
+        return result;
+    }
+
+    /// @brief z' = T z for u' = (u - shiftX) / scale and v' = (v - shiftY) / scale, expanding the squares and product
+    FixedMatrix<6, 6> EllipseFitter::getTransformation(const double shiftX, const double shiftY, const double scale) {
+        const double square = scale * scale;
+        return FixedMatrix<6, 6>({
+            { 1 / square, 0, 0, -2 * shiftX / square, 0, shiftX * shiftX / square },
+            { 0, 1 / square, 0, -shiftY / square, -shiftX / square, shiftX * shiftY / square },
+            { 0, 0, 1 / square, 0, -2 * shiftY / square, shiftY * shiftY / square },
+            { 0, 0, 0, 1 / scale, 0, -shiftX / scale },
+            { 0, 0, 0, 0, 1 / scale, -shiftY / scale },
+            { 0, 0, 0, 0, 0, 1 }
+        });
+    }
+}
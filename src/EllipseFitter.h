@@ -0,0 +1,49 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef ELLIPSEFITTER_H
+#define ELLIPSEFITTER_H
+
+#include "FixedMatrix.h"
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Direct least squares ellipse fit (Fitzgibbon, in the numerically stable form of Halir and Flusser) on a stream of points.
+    /// Every point is a rank-1 update of the 6x6 scatter matrix, so memory and time per point are constant and no points are kept.
+    /// fit solves the constrained generalized eigenproblem for the conic a x^2 + b xy + c y^2 + d x + e y + f = 0 with 4ac - b^2 > 0.
+    class EllipseFitter {
+    public:
+        void addPoint(double x, double y);
+        void reset();
+
+        // fills a 6x1 column with (a, b, c, d, e, f), normalized with a positive. Returns false if there is no ellipse
+        // (fewer than 5 points, or points on a line)
+        bool fit(Matrix& coefficients) const;
+        Matrix fit() const;
+
+        unsigned long getPointCount() const;
+        // sum of z z^T with z = (x^2, xy, y^2, x, y, 1), in coordinates relative to the first point
+        FixedMatrix<6, 6> getScatterMatrix() const;
+
+    private:
+        // the scatter matrix of the points shifted by (shiftX, shiftY) and scaled by 1/scale is T S T^T, and the conic
+        // coefficients transform back with T^T
+        static FixedMatrix<6, 6> getTransformation(double shiftX, double shiftY, double scale);
+
+        // upper triangle only
+        FixedMatrix<6, 6> _scatter;
+        double _originX = 0;
+        double _originY = 0;
+        unsigned long _pointCount = 0;
+    };
+}
+#endif
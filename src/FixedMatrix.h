@@ -0,0 +1,296 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef FIXEDMATRIX_H
+#define FIXEDMATRIX_H
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <initializer_list>
+#include <utility>
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Matrix with dimensions known at compile time, stored on the stack (no heap allocations).
+    /// Meant for the small (2x2, 3x3) matrices in hot paths. All loop counts are compile time constants,
+    /// so the compiler can unroll them completely. The elements are double by default, float is the other option.
+    template <Dimension Rows, Dimension Columns, class Value = double>
+    class FixedMatrix {
+    public:
+        FixedMatrix() : _data() {}
+
+        explicit FixedMatrix(const std::initializer_list<std::initializer_list<Value>> list) : _data() {
+            assert(list.size() == Rows);
+            Dimension row = 0;
+            for (const auto& rowList : list) {
+                assert(rowList.size() == Columns);
+                Dimension column = 0;
+                for (const auto value : rowList) {
+                    _data[row * Columns + column] = value;
+                    column++;
+                }
+                row++;
+            }
+        }
+
+        explicit FixedMatrix(const BasicMatrix<Value>& other) {
+            assert(other.rowCount() == Rows && other.columnCount() == Columns);
+            const Value* source = other.data();
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) {
+                _data[cell] = source[cell];
+            }
+        }
+
+        Value& operator()(const Dimension row, const Dimension column) {
+            assert(row < Rows && column < Columns);
+            return _data[row * Columns + column];
+        }
+
+        const Value& operator()(const Dimension row, const Dimension column) const {
+            assert(row < Rows && column < Columns);
+            return _data[row * Columns + column];
+        }
+
+        void operator+=(const FixedMatrix& other) {
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) _data[cell] += other._data[cell];
+        }
+
+        void operator-=(const FixedMatrix& other) {
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) _data[cell] -= other._data[cell];
+        }
+
+        void operator*=(const Value other) {
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) _data[cell] *= other;
+        }
+
+        void operator/=(const Value other) {
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) _data[cell] /= other;
+        }
+
+        bool operator==(const FixedMatrix& other) const {
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) {
+                if (fabs(_data[cell] - other._data[cell]) > Precision<Value>::Epsilon) return false;
+            }
+            return true;
+        }
+
+        static constexpr Dimension rowCount() { return Rows; }
+        static constexpr Dimension columnCount() { return Columns; }
+        static constexpr bool isSquare() { return Rows == Columns; }
+
+        Value* data() { return _data.data(); }
+        const Value* data() const { return _data.data(); }
+
+        Value me(const Dimension row, const Dimension column) const {
+            return (*this)(row, column);
+        }
+
+        static FixedMatrix getIdentity() {
+            static_assert(Rows == Columns, "identity must be square");
+            FixedMatrix result;
+            for (Dimension diagonal = 0; diagonal < Rows; diagonal++) result._data[diagonal * Columns + diagonal] = 1;
+            return result;
+        }
+
+        Value getDeterminant() const;
+
+        Value getTrace() const {
+            static_assert(Rows == Columns, "trace needs a square matrix");
+            Value result = 0;
+            for (Dimension diagonal = 0; diagonal < Rows; diagonal++) result += _data[diagonal * Columns + diagonal];
+            return result;
+        }
+
+        FixedMatrix inverted() const;
+
+        bool isInvertible() const {
+            return fabs(getDeterminant()) > Precision<Value>::Epsilon;
+        }
+
+        BasicMatrix<Value> toMatrix() const {
+            BasicMatrix<Value> result(Rows, Columns);
+            Value* target = result.data();
+            for (Dimension cell = 0; cell < Rows * Columns; cell++) {
+                target[cell] = _data[cell];
+            }
+            return result;
+        }
+
+        FixedMatrix<Columns, Rows, Value> transposed() const {
+            FixedMatrix<Columns, Rows, Value> result;
+            for (Dimension row = 0; row < Rows; row++) {
+                for (Dimension column = 0; column < Columns; column++) {
+                    result(column, row) = _data[row * Columns + column];
+                }
+            }
+            return result;
+        }
+
+        friend FixedMatrix operator+(FixedMatrix left, const FixedMatrix& right) {
+            left += right;
+            return left;
+        }
+
+        friend FixedMatrix operator-(FixedMatrix left, const FixedMatrix& right) {
+            left -= right;
+            return left;
+        }
+
+        friend FixedMatrix operator*(FixedMatrix left, const Value right) {
+            left *= right;
+            return left;
+        }
+
+        friend FixedMatrix operator*(const Value left, FixedMatrix right) {
+            right *= left;
+            return right;
+        }
+
+        friend FixedMatrix operator/(FixedMatrix left, const Value right) {
+            left /= right;
+            return left;
+        }
+
+    private:
+        std::array<Value, Rows * Columns> _data;
+    };
+
+    template <Dimension Rows, Dimension Inner, Dimension Columns, class Value>
+    FixedMatrix<Rows, Columns, Value> operator*(const FixedMatrix<Rows, Inner, Value>& left, const FixedMatrix<Inner, Columns, Value>& right) {
+        FixedMatrix<Rows, Columns, Value> result;
+        for (Dimension row = 0; row < Rows; row++) {
+            for (Dimension k = 0; k < Inner; k++) {
+                const Value leftValue = left(row, k);
+                for (Dimension column = 0; column < Columns; column++) {
+                    result(row, column) += leftValue * right(k, column);
+                }
+            }
+        }
+        return result;
+    }
+
+    namespace FixedMatrixDetail {
+        /// closed forms for the sizes we use most, Gaussian elimination with partial pivoting (on the stack) for the rest
+        template <Dimension Size, class Value>
+        struct Solver {
+            static Value determinant(FixedMatrix<Size, Size, Value> m) {
+                Value result = 1;
+                for (Dimension pivot = 0; pivot < Size; pivot++) {
+                    Dimension maxRow = pivot;
+                    for (Dimension row = pivot + 1; row < Size; row++) {
+                        if (fabs(m(row, pivot)) > fabs(m(maxRow, pivot))) maxRow = row;
+                    }
+                    if (m(maxRow, pivot) == 0.0) return 0;
+                    if (maxRow != pivot) {
+                        for (Dimension column = 0; column < Size; column++) std::swap(m(pivot, column), m(maxRow, column));
+                        result = -result;
+                    }
+                    result *= m(pivot, pivot);
+                    for (Dimension row = pivot + 1; row < Size; row++) {
+                        const Value factor = m(row, pivot) / m(pivot, pivot);
+                        for (Dimension column = pivot; column < Size; column++) m(row, column) -= factor * m(pivot, column);
+                    }
+                }
+                return result;
+            }
+
+            // Gauss-Jordan on [m | I]
+            static FixedMatrix<Size, Size, Value> inverse(FixedMatrix<Size, Size, Value> m) {
+                auto result = FixedMatrix<Size, Size, Value>::getIdentity();
+                for (Dimension pivot = 0; pivot < Size; pivot++) {
+                    Dimension maxRow = pivot;
+                    for (Dimension row = pivot + 1; row < Size; row++) {
+                        if (fabs(m(row, pivot)) > fabs(m(maxRow, pivot))) maxRow = row;
+                    }
+                    assert(fabs(m(maxRow, pivot)) > Precision<Value>::Epsilon);
+                    if (maxRow != pivot) {
+                        for (Dimension column = 0; column < Size; column++) {
+                            std::swap(m(pivot, column), m(maxRow, column));
+                            std::swap(result(pivot, column), result(maxRow, column));
+                        }
+                    }
+                    const Value divisor = m(pivot, pivot);
+                    for (Dimension column = 0; column < Size; column++) {
+                        m(pivot, column) /= divisor;
+                        result(pivot, column) /= divisor;
+                    }
+                    for (Dimension row = 0; row < Size; row++) {
+                        if (row == pivot) continue;
+                        const Value factor = m(row, pivot);
+                        for (Dimension column = 0; column < Size; column++) {
+                            m(row, column) -= factor * m(pivot, column);
+                            result(row, column) -= factor * result(pivot, column);
+                        }
+                    }
+                }
+                return result;
+            }
+        };
+
+        template <class Value>
+        struct Solver<1, Value> {
+            static Value determinant(const FixedMatrix<1, 1, Value>& m) { return m(0, 0); }
+
+            static FixedMatrix<1, 1, Value> inverse(const FixedMatrix<1, 1, Value>& m) {
+                assert(fabs(m(0, 0)) > Precision<Value>::Epsilon);
+                return FixedMatrix<1, 1, Value>({ { Value(1) / m(0, 0) } });
+            }
+        };
+
+        template <class Value>
+        struct Solver<2, Value> {
+            static Value determinant(const FixedMatrix<2, 2, Value>& m) {
+                return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+            }
+
+            static FixedMatrix<2, 2, Value> inverse(const FixedMatrix<2, 2, Value>& m) {
+                const Value determinant = Solver<2, Value>::determinant(m);
+                assert(fabs(determinant) > Precision<Value>::Epsilon);
+                return FixedMatrix<2, 2, Value>({ { m(1, 1), -m(0, 1) }, { -m(1, 0), m(0, 0) } }) / determinant;
+            }
+        };
+
+        template <class Value>
+        struct Solver<3, Value> {
+            static Value determinant(const FixedMatrix<3, 3, Value>& m) {
+                return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) -
+                    m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0)) +
+                    m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+            }
+
+            // adjugate divided by the determinant
+            static FixedMatrix<3, 3, Value> inverse(const FixedMatrix<3, 3, Value>& m) {
+                const Value determinant = Solver<3, Value>::determinant(m);
+                assert(fabs(determinant) > Precision<Value>::Epsilon);
+                return FixedMatrix<3, 3, Value>({
+                    { m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1), m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2), m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1) },
+                    { m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2), m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0), m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2) },
+                    { m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0), m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1), m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0) }
+                    }) / determinant;
+            }
+        };
+    }
+
+    template <Dimension Rows, Dimension Columns, class Value>
+    Value FixedMatrix<Rows, Columns, Value>::getDeterminant() const {
+        static_assert(Rows == Columns, "determinant needs a square matrix");
+        return FixedMatrixDetail::Solver<Rows, Value>::determinant(*this);
+    }
+
+    template <Dimension Rows, Dimension Columns, class Value>
+    FixedMatrix<Rows, Columns, Value> FixedMatrix<Rows, Columns, Value>::inverted() const {
+        static_assert(Rows == Columns, "inverse needs a square matrix");
+        return FixedMatrixDetail::Solver<Rows, Value>::inverse(*this);
+    }
+}
+#endif
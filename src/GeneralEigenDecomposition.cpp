@@ -0,0 +1,327 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+// Hessenberg reduction and Francis double shift QR, after orthes/hqr (Martin, Peters and Wilkinson,
+// Handbook for Automatic Computation Vol. II) as used in EISPACK and the public domain JAMA library.
+
+#include "GeneralEigenDecomposition.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace RixMatrix {
+
+    GeneralEigenDecomposition::GeneralEigenDecomposition(const Dimension size) :
+        _hessenberg(size, size),
+        _realParts(size, 1),
+        _imaginaryParts(size, 1),
+        _householder(size) {}
+
+    GeneralEigenDecomposition::GeneralEigenDecomposition(const Matrix& matrix) :
+        GeneralEigenDecomposition(matrix.rowCount()) {
+        decompose(matrix);
+    }
+
+    bool GeneralEigenDecomposition::decompose(const Matrix& matrix) {
+        assert(matrix.isSquare() && matrix.rowCount() == size());
+        _hessenberg = matrix;
+        reduceToHessenberg();
+        _hasConverged = findEigenvalues();
+        sort();
+        return _hasConverged;
+    }
+
+    const Matrix& GeneralEigenDecomposition::getRealParts() const {
+        return _realParts;
+    }
+
+    const Matrix& GeneralEigenDecomposition::getImaginaryParts() const {
+        return _imaginaryParts;
+    }
+
+    Matrix GeneralEigenDecomposition::getRealEigenvalues() const {
+        Dimension realCount = 0;
+        for (Dimension i = 0; i < size(); i++) {
+            if (_imaginaryParts[i] == 0.0) realCount++;
+        }
+        Matrix result(realCount, 1);
+        Dimension resultRow = 0;
+        for (Dimension i = 0; i < size(); i++) {
+            if (_imaginaryParts[i] == 0.0) result[resultRow++] = _realParts[i];
+        }
+        return result;
+    }
+
+    bool GeneralEigenDecomposition::hasConverged() const {
+        return _hasConverged;
+    }
+
+    Dimension GeneralEigenDecomposition::size() const {
+        return _realParts.rowCount();
+    }
+
+    /// @brief Householder similarity transformations to upper Hessenberg form (zero below the subdiagonal)
+    void GeneralEigenDecomposition::reduceToHessenberg() {
+        const Dimension n = size();
+        if (n < 3) return;
+        double* h = _hessenberg.data();
+        double* u = _householder.data();
+        const Dimension high = n - 1;
+
+        for (Dimension m = 1; m < high; m++) {
+            double scale = 0;
+            for (Dimension i = m; i <= high; i++) {
+                scale += fabs(h[i * n + m - 1]);
+            }
+            if (scale == 0.0) continue;
+
+            // Householder vector for column m - 1, below the subdiagonal
+            double norm = 0;
+            for (Dimension i = high + 1; i-- > m;) {
+                u[i] = h[i * n + m - 1] / scale;
+                norm += u[i] * u[i];
+            }
+            double g = sqrt(norm);
+            if (u[m] > 0) g = -g;
+            norm -= u[m] * g;
+            u[m] -= g;
+
+            // H = (I - u u' / norm) H (I - u u' / norm)
+            for (Dimension j = m; j < n; j++) {
+                double f = 0;
+                for (Dimension i = high + 1; i-- > m;) {
+                    f += u[i] * h[i * n + j];
+                }
+                f /= norm;
+                for (Dimension i = m; i <= high; i++) {
+                    h[i * n + j] -= f * u[i];
+                }
+            }
+            for (Dimension i = 0; i <= high; i++) {
+                double* row = h + i * n;
+                double f = 0;
+                for (Dimension j = high + 1; j-- > m;) {
+                    f += u[j] * row[j];
+                }
+                f /= norm;
+                for (Dimension j = m; j <= high; j++) {
+                    row[j] -= f * u[j];
+                }
+            }
+            h[m * n + m - 1] = scale * g;
+            for (Dimension i = m + 1; i <= high; i++) {
+                h[i * n + m - 1] = 0;
+            }
+        }
+    }
+
+    /// @brief Francis double shift QR on the Hessenberg matrix, deflating one or two eigenvalues at a time.
+    /// Only the active window is updated, as we don't need the Schur vectors.
+    /// @return false if it didn't converge within MaxIterationsPerEigenvalue iterations per eigenvalue (on average)
+    bool GeneralEigenDecomposition::findEigenvalues() {
+        const int size = static_cast<int>(this->size());
+        double* hessenberg = _hessenberg.data();
+        double* real = _realParts.data();
+        double* imaginary = _imaginaryParts.data();
+        auto h = [hessenberg, size](const int row, const int column) -> double& {
+            return hessenberg[row * size + column];
+        };
+        constexpr double eps = std::numeric_limits<double>::epsilon();
+
+        double norm = 0;
+        for (int i = 0; i < size; i++) {
+            for (int j = std::max(i - 1, 0); j < size; j++) {
+                norm += fabs(h(i, j));
+            }
+        }
+
+        int n = size - 1;
+        double exceptionalShift = 0;
+        unsigned int iteration = 0;
+        unsigned int totalIterations = 0;
+        const unsigned int maxIterations = MaxIterationsPerEigenvalue * static_cast<unsigned int>(size);
+        double p = 0, q = 0, r = 0, s = 0, w = 0, x = 0, y = 0, z = 0;
+
+        while (n >= 0) {
+            // look for a single small subdiagonal element
+            int l = n;
+            while (l > 0) {
+                s = fabs(h(l - 1, l - 1)) + fabs(h(l, l));
+                if (s == 0.0) s = norm;
+                if (fabs(h(l, l - 1)) < eps * s) break;
+                l--;
+            }
+
+            if (l == n) {
+                // one real root
+                real[n] = h(n, n) + exceptionalShift;
+                imaginary[n] = 0;
+                n--;
+                iteration = 0;
+            }
+            else if (l == n - 1) {
+                // two roots, from the trailing 2x2 block
+                w = h(n, n - 1) * h(n - 1, n);
+                p = (h(n - 1, n - 1) - h(n, n)) / 2.0;
+                q = p * p + w;
+                z = sqrt(fabs(q));
+                x = h(n, n) + exceptionalShift;
+                if (q >= 0) {
+                    z = p >= 0 ? p + z : p - z;
+                    real[n - 1] = x + z;
+                    real[n] = z != 0.0 ? x - w / z : real[n - 1];
+                    imaginary[n - 1] = 0;
+                    imaginary[n] = 0;
+                }
+                else {
+                    real[n - 1] = x + p;
+                    real[n] = x + p;
+                    imaginary[n - 1] = z;
+                    imaginary[n] = -z;
+                }
+                n -= 2;
+                iteration = 0;
+            }
+            else {
+                if (++totalIterations > maxIterations) return false;
+
+                // form the shift
+                x = h(n, n);
+                y = h(n - 1, n - 1);
+                w = h(n, n - 1) * h(n - 1, n);
+
+                // Wilkinson's ad hoc shift, to get out of cycles
+                if (iteration == 10) {
+                    exceptionalShift += x;
+                    for (int i = 0; i <= n; i++) {
+                        h(i, i) -= x;
+                    }
+                    s = fabs(h(n, n - 1)) + fabs(h(n - 1, n - 2));
+                    x = y = 0.75 * s;
+                    w = -0.4375 * s * s;
+                }
+
+                // and a second one if that didn't help
+                if (iteration == 30) {
+                    s = (y - x) / 2.0;
+                    s = s * s + w;
+                    if (s > 0) {
+                        s = sqrt(s);
+                        if (y < x) s = -s;
+                        s = x - w / ((y - x) / 2.0 + s);
+                        for (int i = 0; i <= n; i++) {
+                            h(i, i) -= s;
+                        }
+                        exceptionalShift += s;
+                        x = y = w = 0.964;
+                    }
+                }
+                iteration++;
+
+                // look for two consecutive small subdiagonal elements
+                int m = n - 2;
+                while (m >= l) {
+                    z = h(m, m);
+                    r = x - z;
+                    s = y - z;
+                    p = (r * s - w) / h(m + 1, m) + h(m, m + 1);
+                    q = h(m + 1, m + 1) - z - r - s;
+                    r = h(m + 2, m + 1);
+                    s = fabs(p) + fabs(q) + fabs(r);
+                    p /= s;
+                    q /= s;
+                    r /= s;
+                    if (m == l) break;
+                    if (fabs(h(m, m - 1)) * (fabs(q) + fabs(r)) <
+                        eps * (fabs(p) * (fabs(h(m - 1, m - 1)) + fabs(z) + fabs(h(m + 1, m + 1))))) {
+                        break;
+                    }
+                    m--;
+                }
+
+                for (int i = m + 2; i <= n; i++) {
+                    h(i, i - 2) = 0;
+                    if (i > m + 2) h(i, i - 3) = 0;
+                }
+
+                // double QR step on rows l..n and columns m..n, chasing the bulge down
+                for (int k = m; k <= n - 1; k++) {
+                    const bool notLast = k != n - 1;
+                    if (k != m) {
+                        p = h(k, k - 1);
+                        q = h(k + 1, k - 1);
+                        r = notLast ? h(k + 2, k - 1) : 0.0;
+                        x = fabs(p) + fabs(q) + fabs(r);
+                        if (x == 0.0) continue;
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                    s = sqrt(p * p + q * q + r * r);
+                    if (p < 0) s = -s;
+                    if (s == 0.0) continue;
+
+                    if (k != m) {
+                        h(k, k - 1) = -s * x;
+                    }
+                    else if (l != m) {
+                        h(k, k - 1) = -h(k, k - 1);
+                    }
+                    p += s;
+                    x = p / s;
+                    y = q / s;
+                    z = r / s;
+                    q /= p;
+                    r /= p;
+
+                    // row modification
+                    for (int j = k; j <= n; j++) {
+                        p = h(k, j) + q * h(k + 1, j);
+                        if (notLast) {
+                            p += r * h(k + 2, j);
+                            h(k + 2, j) -= p * z;
+                        }
+                        h(k, j) -= p * x;
+                        h(k + 1, j) -= p * y;
+                    }
+
+                    // column modification
+                    for (int i = l; i <= std::min(n, k + 3); i++) {
+                        p = x * h(i, k) + y * h(i, k + 1);
+                        if (notLast) {
+                            p += z * h(i, k + 2);
+                            h(i, k + 2) -= p * r;
+                        }
+                        h(i, k) -= p;
+                        h(i, k + 1) -= p * q;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /// @brief sort by descending real part, then descending imaginary part (insertion sort, as the pairs must move together)
+    void GeneralEigenDecomposition::sort() {
+        double* real = _realParts.data();
+        double* imaginary = _imaginaryParts.data();
+        for (Dimension i = 1; i < size(); i++) {
+            for (Dimension j = i; j > 0; j--) {
+                const bool inOrder = real[j - 1] > real[j] || (real[j - 1] == real[j] && imaginary[j - 1] >= imaginary[j]);
+                if (inOrder) break;
+                std::swap(real[j - 1], real[j]);
+                std::swap(imaginary[j - 1], imaginary[j]);
+            }
+        }
+    }
+}
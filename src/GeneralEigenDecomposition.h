@@ -0,0 +1,56 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef GENERALEIGENDECOMPOSITION_H
+#define GENERALEIGENDECOMPOSITION_H
+
+#include <vector>
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Eigenvalues of a general (non-symmetric) square matrix of any size, in O(n^3):
+    /// Householder reduction to upper Hessenberg form followed by the Francis double shift QR algorithm.
+    /// Complex eigenvalues come in conjugate pairs. The eigenvalues are sorted by descending real part,
+    /// and within a pair the one with the positive imaginary part comes first.
+    /// Like LuDecomposition, the workspace can be reused: construct with a size and call decompose.
+    class GeneralEigenDecomposition {
+    public:
+        explicit GeneralEigenDecomposition(Dimension size);
+        explicit GeneralEigenDecomposition(const Matrix& matrix);
+
+        // returns false if QR didn't converge
+        bool decompose(const Matrix& matrix);
+
+        // column vectors, element i of both together is eigenvalue i
+        const Matrix& getRealParts() const;
+        const Matrix& getImaginaryParts() const;
+
+        // column vector with just the real eigenvalues
+        Matrix getRealEigenvalues() const;
+        bool hasConverged() const;
+        Dimension size() const;
+
+        static constexpr unsigned int MaxIterationsPerEigenvalue = 30;
+
+    private:
+        void reduceToHessenberg();
+        bool findEigenvalues();
+        void sort();
+
+        Matrix _hessenberg;
+        Matrix _realParts;
+        Matrix _imaginaryParts;
+        std::vector<double> _householder;
+        bool _hasConverged = false;
+    };
+}
+#endif
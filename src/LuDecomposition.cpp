@@ -0,0 +1,242 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuDecomposition.h"
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace RixMatrix {
+
+    template <class Value>
+    BasicLuDecomposition<Value>::BasicLuDecomposition(const Dimension size) :
+        _lu(size, size),
+        _permutation(size),
+        _pivotRows(size) {}
+
+    template <class Value>
+    BasicLuDecomposition<Value>::BasicLuDecomposition(const BasicMatrix<Value>& matrix) :
+        _lu(matrix),
+        _permutation(matrix.rowCount()),
+        _pivotRows(matrix.rowCount()) {
+        assert(matrix.isSquare());
+        decompose();
+    }
+
+    template <class Value>
+    BasicLuDecomposition<Value>::BasicLuDecomposition(const BasicMatrix<Value>& matrix, const Dimension skipRow, const Dimension skipColumn) :
+        _lu(matrix.rowCount() - 1, matrix.columnCount() - 1),
+        _permutation(matrix.rowCount() - 1),
+        _pivotRows(matrix.rowCount() - 1) {
+        assert(matrix.isSquare() && matrix.rowCount() > 1 && skipRow < matrix.rowCount() && skipColumn < matrix.columnCount());
+        const Dimension size = matrix.rowCount();
+        const Value* source = matrix.data();
+        Value* target = _lu.data();
+        for (Dimension row = 0; row < size; row++) {
+            if (row == skipRow) continue;
+            for (Dimension column = 0; column < size; column++) {
+                if (column == skipColumn) continue;
+                *target++ = source[row * size + column];
+            }
+        }
+        decompose();
+    }
+
+    /// @brief decompose another matrix of the same size, reusing the workspace
+    template <class Value>
+    void BasicLuDecomposition<Value>::decompose(const BasicMatrix<Value>& matrix) {
+        assert(matrix.isSquare() && matrix.rowCount() == size());
+        _lu = matrix;
+        decompose();
+    }
+
+    template <class Value>
+    Value BasicLuDecomposition<Value>::getDeterminant() const {
+        Value result = _permutationSign;
+        const Dimension n = size();
+        const Value* lu = _lu.data();
+        for (Dimension diagonal = 0; diagonal < n; diagonal++) {
+            result *= lu[diagonal * n + diagonal];
+        }
+        return result;
+    }
+
+    /// @brief Solve LU X = P in place in the result.
+    /// @param result the matrix to write the inverse into. Must have the same size as the decomposed matrix.
+    /// @return whether the matrix was invertible. If not, the result is left untouched.
+    template <class Value>
+    bool BasicLuDecomposition<Value>::getInverse(BasicMatrix<Value>& result) const {
+        const Dimension n = size();
+        assert(result.rowCount() == n && result.columnCount() == n);
+        if (_isSingular) return false;
+
+        Value* inverse = result.data();
+
+        // start with the permutation matrix P
+        for (Dimension row = 0; row < n; row++) {
+            Value* resultRow = inverse + row * n;
+            for (Dimension column = 0; column < n; column++) {
+                resultRow[column] = 0;
+            }
+            resultRow[_permutation[row]] = 1;
+        }
+
+        substitutePanels(result);
+        return true;
+    }
+
+    template <class Value>
+    bool BasicLuDecomposition<Value>::solve(BasicMatrix<Value>& rightHandSides) const {
+        const Dimension n = size();
+        assert(rightHandSides.rowCount() == n);
+        if (_isSingular) return false;
+
+        // P B, with the swaps in the order decompose did them
+        for (Dimension pivot = 0; pivot < n; pivot++) {
+            rightHandSides.swapRows(pivot, _pivotRows[pivot]);
+        }
+
+        substitutePanels(rightHandSides);
+        return true;
+    }
+
+    /// @brief Solve without touching the right hand sides. The result can be reused over calls, so this doesn't allocate.
+    template <class Value>
+    bool BasicLuDecomposition<Value>::solve(const BasicMatrix<Value>& rightHandSides, BasicMatrix<Value>& result) const {
+        assert(result.sizeIsEqual(rightHandSides));
+        if (_isSingular) return false;
+        result = rightHandSides;
+        return solve(result);
+    }
+
+    template <class Value>
+    bool BasicLuDecomposition<Value>::isSingular() const {
+        return _isSingular;
+    }
+
+    template <class Value>
+    Dimension BasicLuDecomposition<Value>::size() const {
+        return _lu.rowCount();
+    }
+
+    /// @brief Substitute in panels of SolveBlockColumns columns. The panels are independent,
+    /// and each one stays in cache while the factors stream past it.
+    template <class Value>
+    void BasicLuDecomposition<Value>::substitutePanels(BasicMatrix<Value>& values) const {
+        const Dimension n = size();
+        const Dimension columns = values.columnCount();
+        Value* data = values.data();
+        const Dimension panelCount = (columns + SolveBlockColumns - 1) / SolveBlockColumns;
+        const auto solvePanels = [=](const Dimension begin, const Dimension end) {
+            for (Dimension panel = begin; panel < end; panel++) {
+                const Dimension column = panel * SolveBlockColumns;
+                const Dimension width = columns - column < SolveBlockColumns ? columns - column : SolveBlockColumns;
+                substitute(data + column, columns, width);
+            }
+        };
+        ThreadPool& pool = ThreadPool::instance();
+        const unsigned long work = static_cast<unsigned long>(n) * n * columns;
+        if (panelCount > 1 && work >= MatrixMultiplier::ParallelProductLimit && pool.isParallel()) {
+            pool.parallelFor(panelCount, 1, solvePanels);
+        } else {
+            solvePanels(0, panelCount);
+        }
+    }
+
+    /// @brief Forward substitution with the unit lower triangle (L Y = B), then backward with the upper one (U X = Y),
+    /// on a panel of width columns. Row operations only, so the inner loops run over contiguous memory.
+    template <class Value>
+    void BasicLuDecomposition<Value>::substitute(Value* panel, const Dimension stride, const Dimension width) const {
+        const Dimension n = size();
+        const Value* lu = _lu.data();
+
+        for (Dimension row = 1; row < n; row++) {
+            Value* targetRow = panel + row * stride;
+            for (Dimension k = 0; k < row; k++) {
+                const Value factor = lu[row * n + k];
+                if (factor == 0.0) continue;
+                const Value* sourceRow = panel + k * stride;
+                for (Dimension column = 0; column < width; column++) {
+                    targetRow[column] -= factor * sourceRow[column];
+                }
+            }
+        }
+
+        for (Dimension row = n; row-- > 0;) {
+            Value* targetRow = panel + row * stride;
+            for (Dimension k = row + 1; k < n; k++) {
+                const Value factor = lu[row * n + k];
+                if (factor == 0.0) continue;
+                const Value* sourceRow = panel + k * stride;
+                for (Dimension column = 0; column < width; column++) {
+                    targetRow[column] -= factor * sourceRow[column];
+                }
+            }
+            const Value divisor = lu[row * n + row];
+            for (Dimension column = 0; column < width; column++) {
+                targetRow[column] /= divisor;
+            }
+        }
+    }
+
+    /// @brief Doolittle elimination with partial pivoting on the workspace.
+    /// Rows are swapped physically so the factors stay contiguous; the swaps are recorded in the permutation.
+    template <class Value>
+    void BasicLuDecomposition<Value>::decompose() {
+        const Dimension n = size();
+        Value* lu = _lu.data();
+        for (Dimension row = 0; row < n; row++) {
+            _permutation[row] = row;
+            _pivotRows[row] = row;
+        }
+        _permutationSign = 1;
+        _isSingular = false;
+
+        for (Dimension pivot = 0; pivot < n; pivot++) {
+            Dimension maxRow = pivot;
+            Value maxValue = fabs(lu[pivot * n + pivot]);
+            for (Dimension row = pivot + 1; row < n; row++) {
+                const Value value = fabs(lu[row * n + pivot]);
+                if (value > maxValue) {
+                    maxValue = value;
+                    maxRow = row;
+                }
+            }
+            if (maxValue <= BasicArray<Value>::Epsilon) {
+                // nothing to eliminate with. The determinant picks up the (near) zero pivot.
+                _isSingular = true;
+                continue;
+            }
+            if (maxRow != pivot) {
+                _lu.swapRows(pivot, maxRow);
+                std::swap(_permutation[pivot], _permutation[maxRow]);
+                _pivotRows[pivot] = maxRow;
+                _permutationSign = -_permutationSign;
+            }
+            const Value* pivotRow = lu + pivot * n;
+            const Value pivotValue = pivotRow[pivot];
+            for (Dimension row = pivot + 1; row < n; row++) {
+                Value* currentRow = lu + row * n;
+                const Value factor = currentRow[pivot] / pivotValue;
+                currentRow[pivot] = factor;
+                if (factor == 0.0) continue;
+                for (Dimension column = pivot + 1; column < n; column++) {
+                    currentRow[column] -= factor * pivotRow[column];
+                }
+            }
+        }
+    }
+
+    template class BasicLuDecomposition<float>;
+    template class BasicLuDecomposition<double>;
+}
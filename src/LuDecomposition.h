@@ -0,0 +1,66 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef LUDECOMPOSITION_H
+#define LUDECOMPOSITION_H
+
+#include <vector>
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// LU decomposition with partial pivoting (PA = LU), done in place in a single workspace.
+    /// L (unit diagonal, not stored) and U share the workspace; P is kept as a row index vector.
+    /// The workspace can be reused: construct with a size and call decompose, and nothing gets allocated after that.
+    /// Once decomposed, solve handles any number of right hand sides without factorizing again.
+    template <class Value>
+    class BasicLuDecomposition {
+    public:
+        explicit BasicLuDecomposition(Dimension size);
+        explicit BasicLuDecomposition(const BasicMatrix<Value>& matrix);
+
+        // decompose the minor of the matrix (without row and column) without creating it first
+        BasicLuDecomposition(const BasicMatrix<Value>& matrix, Dimension skipRow, Dimension skipColumn);
+
+        void decompose(const BasicMatrix<Value>& matrix);
+        Value getDeterminant() const;
+        bool getInverse(BasicMatrix<Value>& result) const;
+        bool isSingular() const;
+        Dimension size() const;
+
+        // solve A X = B for all columns of B at once, overwriting B with X
+        bool solve(BasicMatrix<Value>& rightHandSides) const;
+        // same, into an existing result with the size of B
+        bool solve(const BasicMatrix<Value>& rightHandSides, BasicMatrix<Value>& result) const;
+
+        // right hand side columns per panel in solve: a panel (size x SolveBlockColumns) should fit in L2
+        static constexpr Dimension SolveBlockColumns = 64;
+
+    private:
+        void decompose();
+        void substitute(Value* panel, Dimension stride, Dimension width) const;
+        void substitutePanels(BasicMatrix<Value>& values) const;
+
+        BasicMatrix<Value> _lu;
+        std::vector<Dimension> _permutation;
+        // the row swapped with each pivot, so P can be applied to B in place
+        std::vector<Dimension> _pivotRows;
+        int _permutationSign = 1;
+        bool _isSingular = false;
+    };
+
+    template <class Value>
+    constexpr Dimension BasicLuDecomposition<Value>::SolveBlockColumns;
+
+    using LuDecomposition = BasicLuDecomposition<double>;
+    using FloatLuDecomposition = BasicLuDecomposition<float>;
+}
+#endif
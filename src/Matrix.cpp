@@ -10,39 +10,46 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include "Matrix.h"
+#include "CholeskyDecomposition.h"
+#include "ElementKernels.h"
+#include "LuDecomposition.h"
+#include "MatrixMultiplier.h"
+#include "SingularValueDecomposition.h"
 #include <cassert>
 #include <stdexcept>
 #include <cmath>
+#include <utility>
 
 namespace RixMatrix {
 
-    Matrix::Matrix(const Dimension rows, const Dimension columns) : Array(rows, columns) {}
+    template <class Value>
+    BasicMatrix<Value>::BasicMatrix(const Dimension rows, const Dimension columns) : Base(rows, columns) {}
 
-    Matrix::Matrix(const Array& other) : Array(other) {}
+    template <class Value>
+    BasicMatrix<Value>::BasicMatrix(const Base& other) : Base(other) {}
 
-    Matrix::Matrix(const std::initializer_list<std::initializer_list<double>> list) : Array(list) {}
+    template <class Value>
+    BasicMatrix<Value>::BasicMatrix(Base&& other) : Base(std::move(other)) {}
 
-    void Matrix::operator*=(const Matrix& other) {
+    template <class Value>
+    BasicMatrix<Value>::BasicMatrix(const std::initializer_list<std::initializer_list<Value>> list) : Base(list) {}
+
+    template <class Value>
+    void BasicMatrix<Value>::operator*=(const BasicMatrix& other) {
         assert(columnCount() == other.rowCount());
-        Matrix result(rowCount(), other.columnCount());
-        for (Dimension row = 0; row < rowCount(); row++) {
-            for (Dimension otherColumn = 0; otherColumn < other.columnCount(); otherColumn++) {
-                double sum = 0;
-                for (Dimension column = 0; column < columnCount(); column++) {
-                    sum += me(row, column) * other(column, otherColumn);
-                }
-                result(row, otherColumn) = sum;
-            }
-        }
-        *this = result;
+        BasicMatrix result(rowCount(), other.columnCount());
+        multiply(*this, other, result);
+        *this = std::move(result);
     }
 
-    void Matrix::operator*=(const double other) {
-        Array::operator*=(other);
+    template <class Value>
+    void BasicMatrix<Value>::operator*=(const Value other) {
+        Base::operator*=(other);
     }
 
-    Matrix Matrix::getAdjoint() const {
-        Matrix result(rowCount(), columnCount());
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::getAdjoint() const {
+        BasicMatrix result(rowCount(), columnCount());
         for (Dimension row = 0; row < rowCount(); row++) {
             for (Dimension column = 0; column < columnCount(); column++) {
                 result(row, column) = getCofactor(row, column);
@@ -51,16 +58,23 @@ namespace RixMatrix {
         return result;
     }
 
-    Matrix Matrix::getAdjugate() const {
-        return getAdjoint().transposed<Matrix>();
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::getAdjugate() const {
+        return getAdjoint().template transposed<BasicMatrix>();
     }
 
-    double Matrix::getCofactor(const Dimension row, const Dimension column) const {
-        const auto determinant = getMinor(row, column).getDeterminant();
-        return determinant * pow(-1, row + column);
+    template <class Value>
+    Value BasicMatrix<Value>::getCofactor(const Dimension row, const Dimension column) const {
+        const auto determinant = getMinorDeterminant(row, column);
+        return (row + column) % 2 == 0 ? determinant : -determinant;
     }
 
-    double Matrix::getDeterminant() const {
+    /// @brief Small matrices use the closed form (exact for integer input), larger ones a Cholesky decomposition
+    /// if they are symmetric positive definite, and an LU decomposition otherwise. Both are O(n^3).
+    /// Definiteness only shows during the factorization, so a symmetric indefinite matrix first pays for the
+    /// Cholesky attempt up to its first non-positive pivot: at most half the work of the LU decomposition.
+    template <class Value>
+    Value BasicMatrix<Value>::getDeterminant() const {
         assert(isSquare());
         if (rowCount() == 1) {
             return me(0, 0);
@@ -68,18 +82,40 @@ namespace RixMatrix {
         if (rowCount() == 2) {
             return me(0, 0) * me(1, 1) - me(0, 1) * me(1, 0);
         }
-        double result = 0;
-        for (Dimension column = 0; column < columnCount(); column++) {
-            const auto cofactor = getCofactor(0, column);
-            result += me(0, column) * cofactor;
+        if (rowCount() == 3) {
+            return me(0, 0) * (me(1, 1) * me(2, 2) - me(1, 2) * me(2, 1)) -
+                me(0, 1) * (me(1, 0) * me(2, 2) - me(1, 2) * me(2, 0)) +
+                me(0, 2) * (me(1, 0) * me(2, 1) - me(1, 1) * me(2, 0));
         }
-        return result;
+        if (isSymmetric()) {
+            const BasicCholeskyDecomposition<Value> cholesky(*this);
+            if (cholesky.isPositiveDefinite()) return cholesky.getDeterminant();
+        }
+        return BasicLuDecomposition<Value>(*this).getDeterminant();
+    }
+
+    /// @brief determinant of the minor, without allocating the minor for small matrices
+    template <class Value>
+    Value BasicMatrix<Value>::getMinorDeterminant(const Dimension row, const Dimension column) const {
+        assert(isSquare() && row < rowCount() && column < columnCount() && rowCount() > 1);
+        if (rowCount() == 2) {
+            return me(1 - row, 1 - column);
+        }
+        if (rowCount() == 3) {
+            const Dimension row1 = row == 0 ? 1 : 0;
+            const Dimension row2 = row == 2 ? 1 : 2;
+            const Dimension column1 = column == 0 ? 1 : 0;
+            const Dimension column2 = column == 2 ? 1 : 2;
+            return me(row1, column1) * me(row2, column2) - me(row1, column2) * me(row2, column1);
+        }
+        return BasicLuDecomposition<Value>(*this, row, column).getDeterminant();
     }
 
-    Matrix Matrix::getMinor(const Dimension row, const Dimension column) const {
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::getMinor(const Dimension row, const Dimension column) const {
         assert(row < rowCount() && column < columnCount() &&
             rowCount() > 1 && columnCount() > 1);
-        Matrix result(rowCount() - 1, columnCount() - 1);
+        BasicMatrix result(rowCount() - 1, columnCount() - 1);
 
         for (Dimension subRow = 0; subRow < rowCount(); subRow++) {
             if (subRow == row) continue;
@@ -93,80 +129,148 @@ namespace RixMatrix {
         return result;
     }
 
-    double Matrix::getTrace() const {
+    template <class Value>
+    Value BasicMatrix<Value>::getTrace() const {
         assert(isSquare());
-        double result = 0;
+        Value result = 0;
         for (Dimension row = 0; row < rowCount(); row++) {
             result += me(row, row);
         }
         return result;
     }
 
-    Matrix Matrix::getIdentity(const Dimension size) {
-        Matrix result(size, size);
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::getIdentity(const Dimension size) {
+        BasicMatrix result(size, size);
         for (Dimension diagonalCell = 0; diagonalCell < size; diagonalCell++) {
             result(diagonalCell, diagonalCell) = 1;
         }
         return result;
     }
 
-    Matrix Matrix::inverted() const {
-        assert(isInvertible());
-        return Matrix(getAdjugate() / getDeterminant());
+    /// @brief out = left * right, without allocating a result. out must have the right size and must not be one of the operands.
+    template <class Value>
+    void BasicMatrix<Value>::multiply(const BasicMatrix& left, const BasicMatrix& right, BasicMatrix& out) {
+        assert(left.columnCount() == right.rowCount());
+        assert(out.rowCount() == left.rowCount() && out.columnCount() == right.columnCount());
+        assert(&out != &left && &out != &right);
+        MatrixMultiplier::multiply(left.rowCount(), left.columnCount(), right.columnCount(),
+            left.data(), left.columnCount(),
+            right.data(), right.columnCount(),
+            out.data(), out.columnCount());
+    }
+
+    /// @brief Invert via a Cholesky decomposition for symmetric positive definite matrices, else via an LU decomposition,
+    /// which also serves as the singularity check. O(n^3). The matrix must be invertible.
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::inverted() const {
+        assert(isSquare());
+        BasicMatrix result(rowCount(), columnCount());
+        const bool isInvertible = inverted(result);
+        assert(isInvertible);
+        (void)isInvertible;
+        return result;
+    }
+
+    /// @brief Invert into an existing matrix, so repeated inversions don't need to allocate a result.
+    /// Symmetric positive definite matrices use a Cholesky decomposition, others an LU decomposition.
+    /// A symmetric matrix that turns out not to be positive definite gets both: the Cholesky attempt stops at its first
+    /// non-positive pivot, and the LU decomposition starts over. Singular matrices always end up in LU.
+    /// For fully allocation free loops, keep one of those and use its decompose and getInverse.
+    /// @return false if the matrix is singular (the result is then left untouched)
+    template <class Value>
+    bool BasicMatrix<Value>::inverted(BasicMatrix& result) const {
+        assert(isSquare() && result.sizeIsEqual(*this));
+        if (isSymmetric()) {
+            const BasicCholeskyDecomposition<Value> cholesky(*this);
+            if (cholesky.isPositiveDefinite()) return cholesky.getInverse(result);
+        }
+        return BasicLuDecomposition<Value>(*this).getInverse(result);
     }
 
-    bool Matrix::isInvertible() const {
-        return isSquare() && abs(getDeterminant()) > Epsilon;
+    template <class Value>
+    bool BasicMatrix<Value>::isInvertible() const {
+        return isSquare() && fabs(getDeterminant()) > Epsilon;
     }
 
-    Matrix Matrix::normalized() const {
-        double norm = 0;
-        for (Dimension cell = 0; cell < size(); cell++) {
-            norm += (*this)[cell] * (*this)[cell];
+    template <class Value>
+    bool BasicMatrix<Value>::isSymmetric(const Value epsilon) const {
+        if (!isSquare()) return false;
+        for (Dimension row = 1; row < rowCount(); row++) {
+            for (Dimension column = 0; column < row; column++) {
+                if (fabs(me(row, column) - me(column, row)) > epsilon) return false;
+            }
         }
-        norm = sqrt(norm);
+        return true;
+    }
+
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::normalized() const & {
+        Value norm = std::sqrt(ElementKernels::sumOfSquares(data(), size()));
         if (norm < Epsilon) return *this;
         if ((*this)[0] < 0) norm = -norm;
-        return Matrix(*this / norm);
+        return BasicMatrix(*this / norm);
     }
 
-    Matrix Matrix::squared() const {
-        return *this * *this;
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::normalized() && {
+        Value norm = std::sqrt(ElementKernels::sumOfSquares(data(), size()));
+        if (norm >= Epsilon) {
+            Base::operator/=((*this)[0] < 0 ? -norm : norm);
+        }
+        return std::move(*this);
     }
 
-    Array Matrix::toArray() const {
-        Array result(rowCount(), columnCount());
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::pseudoInverse() const {
+        return BasicSingularValueDecomposition<Value>(*this).pseudoInverse();
+    }
 
-        for (Dimension row = 0; row < rowCount(); row++) {
-            for (Dimension column = 0; column < columnCount(); column++) {
-                result(row, column) = me(row, column);
-            }
-        }
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::solve(const BasicMatrix& rightHandSides) const {
+        BasicMatrix result(rightHandSides.rowCount(), rightHandSides.columnCount());
+        const bool isSolved = solve(rightHandSides, result);
+        assert(isSolved);
+        (void)isSolved;
         return result;
     }
 
-    Matrix operator+(Matrix left, const Matrix& right) {
-        left += right;
-        return left;
+    /// @brief Solve into an existing matrix of the same size as the right hand sides, like inverted(result).
+    /// Symmetric matrices try a Cholesky decomposition first; if that finds them not positive definite, LU takes over,
+    /// so the failed attempt is extra work (as in getDeterminant and inverted).
+    /// @return false if the matrix is singular (the result is then left untouched)
+    template <class Value>
+    bool BasicMatrix<Value>::solve(const BasicMatrix& rightHandSides, BasicMatrix& result) const {
+        assert(isSquare() && rightHandSides.rowCount() == rowCount() && result.sizeIsEqual(rightHandSides));
+        if (isSymmetric()) {
+            const BasicCholeskyDecomposition<Value> cholesky(*this);
+            if (cholesky.solve(rightHandSides, result)) return true;
+        }
+        return BasicLuDecomposition<Value>(*this).solve(rightHandSides, result);
     }
 
-    Matrix operator-(Matrix left, const Matrix& right) {
-        left -= right;
-        return left;
+    template <class Value>
+    BasicMatrix<Value> BasicMatrix<Value>::squared() const {
+        return *this * *this;
     }
 
-    Matrix operator*(Matrix left, const Matrix& right) {
-        left *= right;
-        return left;
-    }
+    template <class Value>
+    BasicArray<Value> BasicMatrix<Value>::toArray() const & {
+        Base result(rowCount(), columnCount());
 
-    Matrix operator*(Matrix left, const double right) {
-        left *= right;
-        return left;
+        for (Dimension row = 0; row < rowCount(); row++) {
+            for (Dimension column = 0; column < columnCount(); column++) {
+                result(row, column) = me(row, column);
+            }
+        }
+        return result;
     }
 
-    Matrix operator*(const double left, Matrix right) {
-        right *= left;
-        return right;
+    template <class Value>
+    BasicArray<Value> BasicMatrix<Value>::toArray() && {
+        return Base(std::move(*this));
     }
-}
\ No newline at end of file
+
+    template class BasicMatrix<float>;
+    template class BasicMatrix<double>;
+}
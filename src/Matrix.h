@@ -6,38 +6,88 @@
 
 namespace  RixMatrix {
 
-    /// Class for basic matrix manipulations
-    class Matrix : public Array {
+    /// Class for basic matrix manipulations, on float or double elements.
+    /// Use the Matrix and FloatMatrix aliases.
+    template <class Value>
+    class BasicMatrix : public BasicArray<Value> {
     public:
+        using Base = BasicArray<Value>;
+        using Base::Epsilon;
+        using Base::columnCount;
+        using Base::data;
+        using Base::isSquare;
+        using Base::me;
+        using Base::rowCount;
+        using Base::size;
+
         /// Constructors
-        Matrix(Dimension rows, Dimension columns);
-        explicit Matrix(std::initializer_list<std::initializer_list<double>> list);
-        explicit Matrix(const Array& other);
+        BasicMatrix(Dimension rows, Dimension columns);
+        explicit BasicMatrix(std::initializer_list<std::initializer_list<Value>> list);
+        explicit BasicMatrix(const Base& other);
+        // takes over the storage of a temporary array
+        explicit BasicMatrix(Base&& other);
+
+        // convert from the other scalar type
+        template <class Other, class = typename std::enable_if<!std::is_same<Other, Value>::value>::type>
+        explicit BasicMatrix(const BasicMatrix<Other>& other) : Base(other) {}
+
+        // evaluate an element wise expression on matrices
+        template <class Expression, class = typename std::enable_if<
+            IsExpression<Expression>::value && std::is_same<typename Expression::ResultType, BasicMatrix>::value>::type>
+        BasicMatrix(const Expression& expression) : Base(expression) {}
+
+        // the implicit assignments hide the one in BasicArray, which evaluates in place when the size matches
+        template <class Expression, class = typename std::enable_if<
+            IsExpression<Expression>::value && std::is_same<typename Expression::ResultType, BasicMatrix>::value>::type>
+        BasicMatrix& operator=(const Expression& expression) {
+            Base::operator=(expression);
+            return *this;
+        }
+
+        using ResultType = BasicMatrix;
 
         // *= works differently in matrices
-        void operator*=(const Matrix& other);
+        void operator*=(const BasicMatrix& other);
         // this one doesn't, but it's still needed
-        void operator*=(double other);
-
-        Matrix getAdjoint() const;
-        Matrix getAdjugate() const;
-        double getCofactor(Dimension row, Dimension column) const;
-        double getDeterminant() const;
-        double getTrace() const;
-        Matrix getMinor(Dimension row, Dimension column) const;
-        static Matrix getIdentity(Dimension size);
-        Matrix inverted() const;
+        void operator*=(Value other);
+
+        BasicMatrix getAdjoint() const;
+        BasicMatrix getAdjugate() const;
+        Value getCofactor(Dimension row, Dimension column) const;
+        Value getDeterminant() const;
+        Value getTrace() const;
+        BasicMatrix getMinor(Dimension row, Dimension column) const;
+        static BasicMatrix getIdentity(Dimension size);
+        static void multiply(const BasicMatrix& left, const BasicMatrix& right, BasicMatrix& out);
+        BasicMatrix inverted() const;
+        bool inverted(BasicMatrix& result) const;
         bool isInvertible() const;
-        Matrix normalized() const;
-        Matrix squared() const;
-        Array toArray() const;
-
-        // need to redefine these as well, didn't find a better way
-        friend Matrix operator+(Matrix left, const Matrix& right);
-        friend Matrix operator-(Matrix left, const Matrix& right);
-        friend Matrix operator*(Matrix left, const Matrix& right);
-        friend Matrix operator*(Matrix left, double right);
-        friend Matrix operator*(double left, Matrix right);
+        // Moore-Penrose pseudo-inverse, for any shape and rank. Uses a SingularValueDecomposition.
+        BasicMatrix pseudoInverse() const;
+        // solve this * X = rightHandSides. To solve against the same matrix repeatedly, keep an LuDecomposition
+        // (or a CholeskyDecomposition for symmetric positive definite matrices) instead. The matrix must be invertible;
+        // the overload with a result returns false for a singular matrix instead.
+        BasicMatrix solve(const BasicMatrix& rightHandSides) const;
+        bool solve(const BasicMatrix& rightHandSides, BasicMatrix& result) const;
+        bool isSymmetric(Value epsilon = Epsilon) const;
+        BasicMatrix normalized() const &;
+        BasicMatrix normalized() &&;
+        BasicMatrix squared() const;
+        Base toArray() const &;
+        Base toArray() &&;
+
+        // +, - and scalar * are element wise expressions (see ArrayExpression.h); * between matrices is the matrix product
+        friend BasicMatrix operator*(const BasicMatrix& left, const BasicMatrix& right) {
+            BasicMatrix result(left.rowCount(), right.columnCount());
+            multiply(left, right, result);
+            return result;
+        }
+
+    protected:
+        Value getMinorDeterminant(Dimension row, Dimension column) const;
     };
+
+    using Matrix = BasicMatrix<double>;
+    using FloatMatrix = BasicMatrix<float>;
 }
 #endif
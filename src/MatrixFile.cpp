@@ -0,0 +1,320 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "MatrixFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define RIXMATRIX_WINDOWS_MAPPING
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RIXMATRIX_POSIX_MAPPING
+#endif
+
+namespace RixMatrix {
+
+    constexpr std::size_t MatrixFile::HeaderSize;
+    constexpr std::uint8_t MatrixFile::Version;
+
+    namespace {
+        const char Magic[4] = { 'R', 'I', 'X', 'M' };
+
+        // header layout: magic, version, scalar type, byte order, (reserved), rows, columns; the rest is zero
+        constexpr std::size_t VersionOffset = 4;
+        constexpr std::size_t ScalarTypeOffset = 5;
+        constexpr std::size_t ByteOrderOffset = 6;
+        constexpr std::size_t RowsOffset = 8;
+        constexpr std::size_t ColumnsOffset = 12;
+
+        void reverseBytes(unsigned char* value, const std::size_t size) {
+            std::reverse(value, value + size);
+        }
+
+        std::uint32_t readCount(const unsigned char* bytes, const bool isSwapped) {
+            unsigned char buffer[sizeof(std::uint32_t)];
+            std::memcpy(buffer, bytes, sizeof buffer);
+            if (isSwapped) reverseBytes(buffer, sizeof buffer);
+            std::uint32_t result;
+            std::memcpy(&result, buffer, sizeof result);
+            return result;
+        }
+
+        bool parseHeader(const unsigned char* bytes, MatrixFile::Header& header) {
+            if (std::memcmp(bytes, Magic, sizeof Magic) != 0 || bytes[VersionOffset] != MatrixFile::Version) return false;
+            const auto scalarType = static_cast<ScalarType>(bytes[ScalarTypeOffset]);
+            const auto byteOrder = static_cast<ByteOrder>(bytes[ByteOrderOffset]);
+            if (scalarType != ScalarType::Float && scalarType != ScalarType::Double) return false;
+            if (byteOrder != ByteOrder::LittleEndian && byteOrder != ByteOrder::BigEndian) return false;
+            const bool isSwapped = byteOrder != MatrixFile::nativeByteOrder();
+            header.scalarType = scalarType;
+            header.byteOrder = byteOrder;
+            header.rows = readCount(bytes + RowsOffset, isSwapped);
+            header.columns = readCount(bytes + ColumnsOffset, isSwapped);
+            // an array indexes its cells with a Dimension, so more cells can't be valid
+            return static_cast<std::uint64_t>(header.rows) * header.columns <= std::numeric_limits<Dimension>::max();
+        }
+
+        // 64 bits, so it doesn't overflow on 32 bit platforms either
+        std::uint64_t dataSize(const MatrixFile::Header& header) {
+            return static_cast<std::uint64_t>(header.rows) * header.columns * static_cast<std::uint64_t>(header.scalarType);
+        }
+
+        /// @brief the size of an open file that is still at its start, or 0 if it can't be determined
+        std::uint64_t fileSize(std::FILE* file) {
+#if defined(RIXMATRIX_POSIX_MAPPING)
+            // off_t, as in mapFile: unlike the long of ftell, it holds sizes over 2 GiB on 32 bit systems with large file support
+            struct stat status;
+            return fstat(fileno(file), &status) == 0 && status.st_size > 0 ? static_cast<std::uint64_t>(status.st_size) : 0;
+#elif defined(RIXMATRIX_WINDOWS_MAPPING)
+            // long is 32 bits on Windows
+            const long long size = _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+            std::rewind(file);
+            return size > 0 ? static_cast<std::uint64_t>(size) : 0;
+#else
+            const long size = std::fseek(file, 0, SEEK_END) == 0 ? std::ftell(file) : -1;
+            std::rewind(file);
+            return size > 0 ? static_cast<std::uint64_t>(size) : 0;
+#endif
+        }
+
+        /// @brief map the whole file read only. Returns nullptr if that fails or isn't supported on this platform.
+        void* mapFile(const std::string& path, std::size_t& size) {
+#if defined(RIXMATRIX_POSIX_MAPPING)
+            const int file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0) return nullptr;
+            struct stat status;
+            void* mapping = nullptr;
+            if (fstat(file, &status) == 0 && status.st_size > 0) {
+                size = static_cast<std::size_t>(status.st_size);
+                mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+                if (mapping == MAP_FAILED) mapping = nullptr;
+            }
+            // the mapping keeps the file alive
+            ::close(file);
+            return mapping;
+#elif defined(RIXMATRIX_WINDOWS_MAPPING)
+            const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return nullptr;
+            void* mapping = nullptr;
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+                const HANDLE mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mappingHandle != nullptr) {
+                    size = static_cast<std::size_t>(fileSize.QuadPart);
+                    mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+                    // the view keeps the mapping and the file alive
+                    CloseHandle(mappingHandle);
+                }
+            }
+            CloseHandle(file);
+            return mapping;
+#else
+            (void)path;
+            (void)size;
+            return nullptr;
+#endif
+        }
+
+        void unmapFile(void* mapping, const std::size_t size) {
+#if defined(RIXMATRIX_POSIX_MAPPING)
+            munmap(mapping, size);
+#elif defined(RIXMATRIX_WINDOWS_MAPPING)
+            (void)size;
+            UnmapViewOfFile(mapping);
+#else
+            (void)mapping;
+            (void)size;
+#endif
+        }
+    }
+
+    ByteOrder MatrixFile::nativeByteOrder() {
+        const std::uint16_t probe = 1;
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        return firstByte == 1 ? ByteOrder::LittleEndian : ByteOrder::BigEndian;
+    }
+
+    template <class Value>
+    bool MatrixFile::save(const std::string& path, const BasicArray<Value>& array) {
+        unsigned char header[HeaderSize] = {};
+        std::memcpy(header, Magic, sizeof Magic);
+        header[VersionOffset] = Version;
+        header[ScalarTypeOffset] = static_cast<unsigned char>(scalarTypeOf<Value>());
+        header[ByteOrderOffset] = static_cast<unsigned char>(nativeByteOrder());
+        const std::uint32_t rows = array.rowCount();
+        const std::uint32_t columns = array.columnCount();
+        std::memcpy(header + RowsOffset, &rows, sizeof rows);
+        std::memcpy(header + ColumnsOffset, &columns, sizeof columns);
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) return false;
+        bool isWritten = std::fwrite(header, 1, HeaderSize, file) == HeaderSize &&
+            std::fwrite(array.data(), sizeof(Value), array.size(), file) == array.size();
+        isWritten = std::fclose(file) == 0 && isWritten;
+        return isWritten;
+    }
+
+    template <class Value>
+    bool MatrixFile::load(const std::string& path, BasicArray<Value>& array) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        const std::uint64_t size = fileSize(file);
+        unsigned char headerBytes[HeaderSize];
+        Header header;
+        // check the size before allocating, so a damaged header can't ask for more memory than the file holds
+        if (std::fread(headerBytes, 1, HeaderSize, file) != HeaderSize || !parseHeader(headerBytes, header) ||
+            header.scalarType != scalarTypeOf<Value>() || size < HeaderSize + dataSize(header)) {
+            std::fclose(file);
+            return false;
+        }
+        BasicArray<Value> result(header.rows, header.columns);
+        const bool isRead = std::fread(result.data(), sizeof(Value), result.size(), file) == result.size();
+        std::fclose(file);
+        if (!isRead) return false;
+
+        if (header.byteOrder != nativeByteOrder()) {
+            auto* bytes = reinterpret_cast<unsigned char*>(result.data());
+            for (Dimension cell = 0; cell < result.size(); cell++) {
+                reverseBytes(bytes + cell * sizeof(Value), sizeof(Value));
+            }
+        }
+        array = std::move(result);
+        return true;
+    }
+
+    bool MatrixFile::readHeader(const std::string& path, Header& header) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        unsigned char headerBytes[HeaderSize];
+        const bool isRead = std::fread(headerBytes, 1, HeaderSize, file) == HeaderSize;
+        std::fclose(file);
+        return isRead && parseHeader(headerBytes, header);
+    }
+
+    template <class Value>
+    BasicMappedArray<Value>::BasicMappedArray(const std::string& path) {
+        open(path);
+    }
+
+    template <class Value>
+    BasicMappedArray<Value>::~BasicMappedArray() {
+        close();
+    }
+
+    template <class Value>
+    BasicMappedArray<Value>::BasicMappedArray(BasicMappedArray&& other) noexcept :
+        _mapping(other._mapping),
+        _mappingSize(other._mappingSize),
+        _rows(other._rows),
+        _columns(other._columns) {
+        other._mapping = nullptr;
+        other._mappingSize = 0;
+        other._rows = 0;
+        other._columns = 0;
+    }
+
+    template <class Value>
+    BasicMappedArray<Value>& BasicMappedArray<Value>::operator=(BasicMappedArray&& other) noexcept {
+        if (this == &other) return *this;
+        close();
+        std::swap(_mapping, other._mapping);
+        std::swap(_mappingSize, other._mappingSize);
+        std::swap(_rows, other._rows);
+        std::swap(_columns, other._columns);
+        return *this;
+    }
+
+    template <class Value>
+    Value BasicMappedArray<Value>::operator()(const Dimension row, const Dimension column) const {
+        assert(row < _rows && column < _columns);
+        return data()[row * _columns + column];
+    }
+
+    template <class Value>
+    void BasicMappedArray<Value>::close() {
+        if (_mapping != nullptr) unmapFile(_mapping, _mappingSize);
+        _mapping = nullptr;
+        _mappingSize = 0;
+        _rows = 0;
+        _columns = 0;
+    }
+
+    template <class Value>
+    Dimension BasicMappedArray<Value>::columnCount() const {
+        return _columns;
+    }
+
+    template <class Value>
+    const Value* BasicMappedArray<Value>::data() const {
+        if (_mapping == nullptr) return nullptr;
+        return reinterpret_cast<const Value*>(static_cast<const unsigned char*>(_mapping) + MatrixFile::HeaderSize);
+    }
+
+    template <class Value>
+    bool BasicMappedArray<Value>::isOpen() const {
+        return _mapping != nullptr;
+    }
+
+    template <class Value>
+    bool BasicMappedArray<Value>::open(const std::string& path) {
+        close();
+        std::size_t size = 0;
+        void* mapping = mapFile(path, size);
+        if (mapping == nullptr) return false;
+        MatrixFile::Header header;
+        if (size < MatrixFile::HeaderSize || !parseHeader(static_cast<const unsigned char*>(mapping), header) ||
+            header.scalarType != MatrixFile::scalarTypeOf<Value>() || header.byteOrder != MatrixFile::nativeByteOrder() ||
+            size - MatrixFile::HeaderSize < dataSize(header)) {
+            unmapFile(mapping, size);
+            return false;
+        }
+        _mapping = mapping;
+        _mappingSize = size;
+        _rows = header.rows;
+        _columns = header.columns;
+        return true;
+    }
+
+    template <class Value>
+    Dimension BasicMappedArray<Value>::rowCount() const {
+        return _rows;
+    }
+
+    template <class Value>
+    BasicArray<Value> BasicMappedArray<Value>::toArray() const {
+        return BasicArray<Value>(view());
+    }
+
+    template <class Value>
+    typename BasicMappedArray<Value>::ConstView BasicMappedArray<Value>::view() const {
+        return ConstView(data(), _rows, _columns, _columns);
+    }
+
+    template bool MatrixFile::save(const std::string& path, const BasicArray<float>& array);
+    template bool MatrixFile::save(const std::string& path, const BasicArray<double>& array);
+    template bool MatrixFile::load(const std::string& path, BasicArray<float>& array);
+    template bool MatrixFile::load(const std::string& path, BasicArray<double>& array);
+    template class BasicMappedArray<float>;
+    template class BasicMappedArray<double>;
+}
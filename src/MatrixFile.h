@@ -0,0 +1,106 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef MATRIXFILE_H
+#define MATRIXFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Array.h"
+
+namespace RixMatrix {
+
+    enum class ScalarType : std::uint8_t { Float = 4, Double = 8 };
+    enum class ByteOrder : std::uint8_t { LittleEndian = 1, BigEndian = 2 };
+
+    /// Binary file format for arrays and matrices: a header of HeaderSize bytes, followed by the raw row-major elements.
+    /// The header holds the magic "RIXM", the format version, the scalar type, the byte order of the writer, and the row
+    /// and column counts (uint32, in the byte order of the writer). As the header size is a multiple of the widest SIMD
+    /// register, the elements of a memory mapped file are as well aligned as those of an array.
+    class MatrixFile {
+    public:
+        struct Header {
+            ScalarType scalarType;
+            ByteOrder byteOrder;
+            Dimension rows;
+            Dimension columns;
+        };
+
+        // Returns false if the file can't be written
+        template <class Value>
+        static bool save(const std::string& path, const BasicArray<Value>& array);
+
+        // Replaces the content of array (which can also be a matrix). Files written with the other byte order are
+        // converted. Returns false (and leaves array untouched) if the file can't be read, is not in this format,
+        // has the other scalar type, or is shorter than its header says.
+        template <class Value>
+        static bool load(const std::string& path, BasicArray<Value>& array);
+
+        // Returns false if the file can't be read or is not in this format (which includes more cells than a Dimension can count)
+        static bool readHeader(const std::string& path, Header& header);
+
+        static ByteOrder nativeByteOrder();
+
+        template <class Value>
+        static constexpr ScalarType scalarTypeOf() {
+            return sizeof(Value) == sizeof(float) ? ScalarType::Float : ScalarType::Double;
+        }
+
+        static constexpr std::size_t HeaderSize = 64;
+        static constexpr std::uint8_t Version = 1;
+    };
+
+    /// Read only array on a memory mapped MatrixFile. Opening doesn't read or copy the elements: the view refers
+    /// to the pages of the file, which the operating system loads on first access. So even very large files open instantly.
+    /// Only files with the native byte order and the same scalar type can be mapped (use MatrixFile::load for others).
+    /// Available on POSIX systems and Windows; elsewhere (e.g. esp32), open returns false.
+    /// Use the MappedArray and FloatMappedArray aliases.
+    template <class Value>
+    class BasicMappedArray {
+    public:
+        using ConstView = BasicArrayView<const Value>;
+
+        BasicMappedArray() = default;
+        // check isOpen to see whether it worked
+        explicit BasicMappedArray(const std::string& path);
+        ~BasicMappedArray();
+
+        BasicMappedArray(const BasicMappedArray&) = delete;
+        BasicMappedArray& operator=(const BasicMappedArray&) = delete;
+        BasicMappedArray(BasicMappedArray&& other) noexcept;
+        BasicMappedArray& operator=(BasicMappedArray&& other) noexcept;
+
+        Value operator()(Dimension row, Dimension column) const;
+
+        void close();
+        Dimension columnCount() const;
+        const Value* data() const;
+        bool isOpen() const;
+        // Returns false if the file can't be mapped; a previously opened file is closed in any case
+        bool open(const std::string& path);
+        Dimension rowCount() const;
+        // copy the elements into an array
+        BasicArray<Value> toArray() const;
+        // view on all elements, e.g. to use in expressions
+        ConstView view() const;
+
+    private:
+        void* _mapping = nullptr;
+        std::size_t _mappingSize = 0;
+        Dimension _rows = 0;
+        Dimension _columns = 0;
+    };
+
+    using MappedArray = BasicMappedArray<double>;
+    using FloatMappedArray = BasicMappedArray<float>;
+}
+#endif
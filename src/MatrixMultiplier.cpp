@@ -0,0 +1,384 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+#include <cassert>
+#include <vector>
+
+namespace RixMatrix {
+
+    constexpr Dimension MatrixMultiplier::BlockRows;
+    constexpr Dimension MatrixMultiplier::BlockInner;
+    constexpr Dimension MatrixMultiplier::BlockColumns;
+    constexpr unsigned long MatrixMultiplier::SmallProductLimit;
+    constexpr unsigned long MatrixMultiplier::ParallelProductLimit;
+    constexpr Dimension MatrixMultiplier::DefaultStrassenCutoff;
+
+    namespace {
+        // register tile of the micro-kernel. 4x4 accumulators fit in the registers of all targets we care about (incl. SSE2)
+        constexpr Dimension TileRows = 4;
+        constexpr Dimension TileColumns = 4;
+
+        MultiplicationAlgorithm algorithm = MultiplicationAlgorithm::Classical;
+        Dimension strassenCutoff = MatrixMultiplier::DefaultStrassenCutoff;
+
+        Dimension minimum(const Dimension a, const Dimension b) {
+            return a < b ? a : b;
+        }
+
+        bool isBelowStrassenCutoff(const Dimension rows, const Dimension inner, const Dimension columns) {
+            return minimum(rows, minimum(inner, columns)) < strassenCutoff;
+        }
+
+        /// @brief scratch of all recursion levels: per level two operand sums and one product of the half sizes
+        unsigned long strassenWorkspaceSize(const Dimension rows, const Dimension inner, const Dimension columns) {
+            if (isBelowStrassenCutoff(rows, inner, columns)) return 0;
+            const unsigned long halfRows = rows / 2;
+            const unsigned long halfInner = inner / 2;
+            const unsigned long halfColumns = columns / 2;
+            return halfRows * halfInner + halfInner * halfColumns + halfRows * halfColumns +
+                strassenWorkspaceSize(rows / 2, inner / 2, columns / 2);
+        }
+
+        template <class Value>
+        struct StrassenWorkspace {
+            std::vector<Value> values;
+            bool isInUse = false;
+        };
+
+        /// @brief one workspace per thread, which only grows. Products may run concurrently (e.g. in ThreadPool tasks).
+        /// It isn't re-entrant: while a Strassen leaf waits for its parallelFor, the thread can run a chunk of another
+        /// job that does a Strassen product of its own. isInUse tells that product to allocate its own workspace.
+        template <class Value>
+        StrassenWorkspace<Value>& strassenWorkspace() {
+#ifdef RIXMATRIX_NO_THREADS
+            static StrassenWorkspace<Value> workspace;
+#else
+            thread_local StrassenWorkspace<Value> workspace;
+#endif
+            return workspace;
+        }
+
+        // out = a + b and out = a - b on blocks. out may be a or b.
+        template <class Value>
+        void addBlocks(const Dimension rows, const Dimension columns, const Value* a, const Dimension aStride,
+            const Value* b, const Dimension bStride, Value* out, const Dimension outStride) {
+            for (Dimension row = 0; row < rows; row++) {
+                const Value* aRow = a + row * aStride;
+                const Value* bRow = b + row * bStride;
+                Value* outRow = out + row * outStride;
+                for (Dimension column = 0; column < columns; column++) {
+                    outRow[column] = aRow[column] + bRow[column];
+                }
+            }
+        }
+
+        template <class Value>
+        void subtractBlocks(const Dimension rows, const Dimension columns, const Value* a, const Dimension aStride,
+            const Value* b, const Dimension bStride, Value* out, const Dimension outStride) {
+            for (Dimension row = 0; row < rows; row++) {
+                const Value* aRow = a + row * aStride;
+                const Value* bRow = b + row * bStride;
+                Value* outRow = out + row * outStride;
+                for (Dimension column = 0; column < columns; column++) {
+                    outRow[column] = aRow[column] - bRow[column];
+                }
+            }
+        }
+
+        /// @brief pack a block of the left matrix in panels of TileRows rows, column by column (zero padded)
+        template <class Value>
+        void packLeft(const Dimension rows, const Dimension inner, const Value* left, const Dimension leftStride, Value* packed) {
+            for (Dimension panelRow = 0; panelRow < rows; panelRow += TileRows) {
+                const Dimension validRows = minimum(TileRows, rows - panelRow);
+                for (Dimension k = 0; k < inner; k++) {
+                    for (Dimension row = 0; row < TileRows; row++) {
+                        *packed++ = row < validRows ? left[(panelRow + row) * leftStride + k] : 0.0;
+                    }
+                }
+            }
+        }
+
+        /// @brief pack a block of the right matrix in panels of TileColumns columns, row by row (zero padded)
+        template <class Value>
+        void packRight(const Dimension inner, const Dimension columns, const Value* right, const Dimension rightStride, Value* packed) {
+            for (Dimension panelColumn = 0; panelColumn < columns; panelColumn += TileColumns) {
+                const Dimension validColumns = minimum(TileColumns, columns - panelColumn);
+                for (Dimension k = 0; k < inner; k++) {
+                    const Value* rightRow = right + k * rightStride + panelColumn;
+                    for (Dimension column = 0; column < TileColumns; column++) {
+                        *packed++ = column < validColumns ? rightRow[column] : 0.0;
+                    }
+                }
+            }
+        }
+
+        /// @brief out tile += left panel * right panel. The accumulators stay in registers for the whole inner loop.
+        template <class Value>
+        void microKernel(const Dimension inner, const Value* leftPanel, const Value* rightPanel,
+            Value* out, const Dimension outStride, const Dimension validRows, const Dimension validColumns) {
+            Value accumulator[TileRows][TileColumns] = {};
+            for (Dimension k = 0; k < inner; k++) {
+                for (Dimension row = 0; row < TileRows; row++) {
+                    const Value leftValue = leftPanel[row];
+                    for (Dimension column = 0; column < TileColumns; column++) {
+                        accumulator[row][column] += leftValue * rightPanel[column];
+                    }
+                }
+                leftPanel += TileRows;
+                rightPanel += TileColumns;
+            }
+            for (Dimension row = 0; row < validRows; row++) {
+                for (Dimension column = 0; column < validColumns; column++) {
+                    out[row * outStride + column] += accumulator[row][column];
+                }
+            }
+        }
+    }
+
+    void MatrixMultiplier::multiply(const Dimension rows, const Dimension inner, const Dimension columns,
+        const double* left, const Dimension leftStride,
+        const double* right, const Dimension rightStride,
+        double* out, const Dimension outStride) {
+        multiplyValues(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+    }
+
+    void MatrixMultiplier::multiply(const Dimension rows, const Dimension inner, const Dimension columns,
+        const float* left, const Dimension leftStride,
+        const float* right, const Dimension rightStride,
+        float* out, const Dimension outStride) {
+        multiplyValues(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+    }
+
+    MultiplicationAlgorithm MatrixMultiplier::getAlgorithm() {
+        return algorithm;
+    }
+
+    void MatrixMultiplier::setAlgorithm(const MultiplicationAlgorithm newAlgorithm) {
+        algorithm = newAlgorithm;
+    }
+
+    Dimension MatrixMultiplier::getStrassenCutoff() {
+        return strassenCutoff;
+    }
+
+    void MatrixMultiplier::setStrassenCutoff(const Dimension cutoff) {
+        // the recursion must stop before the blocks get empty
+        assert(cutoff >= 2);
+        strassenCutoff = cutoff;
+    }
+
+    template <class Value>
+    void MatrixMultiplier::multiplyValues(const Dimension rows, const Dimension inner, const Dimension columns,
+        const Value* left, const Dimension leftStride,
+        const Value* right, const Dimension rightStride,
+        Value* out, const Dimension outStride) {
+        if (algorithm == MultiplicationAlgorithm::Classical || isBelowStrassenCutoff(rows, inner, columns)) {
+            multiplyClassical(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+            return;
+        }
+        StrassenWorkspace<Value>& workspace = strassenWorkspace<Value>();
+        const unsigned long workspaceSize = strassenWorkspaceSize(rows, inner, columns);
+        if (workspace.isInUse) {
+            std::vector<Value> nested(workspaceSize);
+            multiplyStrassen(rows, inner, columns, left, leftStride, right, rightStride, out, outStride, nested.data());
+            return;
+        }
+        if (workspace.values.size() < workspaceSize) workspace.values.resize(workspaceSize);
+        workspace.isInUse = true;
+        multiplyStrassen(rows, inner, columns, left, leftStride, right, rightStride, out, outStride, workspace.values.data());
+        workspace.isInUse = false;
+    }
+
+    template <class Value>
+    void MatrixMultiplier::multiplyClassical(const Dimension rows, const Dimension inner, const Dimension columns,
+        const Value* left, const Dimension leftStride,
+        const Value* right, const Dimension rightStride,
+        Value* out, const Dimension outStride) {
+
+        for (Dimension row = 0; row < rows; row++) {
+            Value* outRow = out + row * outStride;
+            for (Dimension column = 0; column < columns; column++) {
+                outRow[column] = 0;
+            }
+        }
+        const unsigned long productSize = static_cast<unsigned long>(rows) * inner * columns;
+        if (productSize <= SmallProductLimit) {
+            multiplySmall(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+            return;
+        }
+        ThreadPool& pool = ThreadPool::instance();
+        if (productSize < ParallelProductLimit || !pool.isParallel()) {
+            multiplyBlocked(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+            return;
+        }
+
+        // Every task gets its own (row block, column block) tile of the output, so no two tasks write the same element.
+        // The tiles don't depend on the thread count, so neither does the result.
+        const Dimension rowBlocks = (rows + BlockRows - 1) / BlockRows;
+        const Dimension columnBlocks = (columns + BlockColumns - 1) / BlockColumns;
+        pool.parallelFor(rowBlocks * columnBlocks, 1, [=](const Dimension begin, const Dimension end) {
+            for (Dimension tile = begin; tile < end; tile++) {
+                const Dimension rowBlock = tile / columnBlocks * BlockRows;
+                const Dimension columnBlock = tile % columnBlocks * BlockColumns;
+                multiplyBlocked(minimum(BlockRows, rows - rowBlock), inner, minimum(BlockColumns, columns - columnBlock),
+                    left + rowBlock * leftStride, leftStride,
+                    right + columnBlock, rightStride,
+                    out + rowBlock * outStride + columnBlock, outStride);
+            }
+        });
+    }
+
+    /// @brief Winograd's variant of Strassen: 7 half size products and 15 block additions instead of 8 products.
+    /// The products go straight into the quadrants of out, except P1 which needs a temporary, as do the operand sums.
+    /// Those three take the start of the workspace; the recursive products share the rest, as they run one after the other.
+    /// An odd last row, column or inner index is peeled off and handled by the classical kernel.
+    template <class Value>
+    void MatrixMultiplier::multiplyStrassen(const Dimension rows, const Dimension inner, const Dimension columns,
+        const Value* left, const Dimension leftStride,
+        const Value* right, const Dimension rightStride,
+        Value* out, const Dimension outStride, Value* workspace) {
+        if (isBelowStrassenCutoff(rows, inner, columns)) {
+            multiplyClassical(rows, inner, columns, left, leftStride, right, rightStride, out, outStride);
+            return;
+        }
+        const Dimension m = rows / 2;
+        const Dimension k = inner / 2;
+        const Dimension n = columns / 2;
+
+        const Value* a11 = left;
+        const Value* a12 = left + k;
+        const Value* a21 = left + m * leftStride;
+        const Value* a22 = a21 + k;
+        const Value* b11 = right;
+        const Value* b12 = right + n;
+        const Value* b21 = right + k * rightStride;
+        const Value* b22 = b21 + n;
+        Value* c11 = out;
+        Value* c12 = out + n;
+        Value* c21 = out + m * outStride;
+        Value* c22 = c21 + n;
+
+        Value* x = workspace;
+        Value* y = x + static_cast<unsigned long>(m) * k;
+        Value* p1 = y + static_cast<unsigned long>(k) * n;
+        Value* next = p1 + static_cast<unsigned long>(m) * n;
+
+        // P7 = (A11 - A21)(B22 - B12)
+        subtractBlocks(m, k, a11, leftStride, a21, leftStride, x, k);
+        subtractBlocks(k, n, b22, rightStride, b12, rightStride, y, n);
+        multiplyStrassen(m, k, n, x, k, y, n, c21, outStride, next);
+        // P5 = S1 T1 with S1 = A21 + A22, T1 = B12 - B11
+        addBlocks(m, k, a21, leftStride, a22, leftStride, x, k);
+        subtractBlocks(k, n, b12, rightStride, b11, rightStride, y, n);
+        multiplyStrassen(m, k, n, x, k, y, n, c22, outStride, next);
+        // P6 = S2 T2 with S2 = S1 - A11, T2 = B22 - T1
+        subtractBlocks(m, k, x, k, a11, leftStride, x, k);
+        subtractBlocks(k, n, b22, rightStride, y, n, y, n);
+        multiplyStrassen(m, k, n, x, k, y, n, c12, outStride, next);
+        // P3 = (A12 - S2) B22
+        subtractBlocks(m, k, a12, leftStride, x, k, x, k);
+        multiplyStrassen(m, k, n, x, k, b22, rightStride, c11, outStride, next);
+        multiplyStrassen(m, k, n, a11, leftStride, b11, rightStride, p1, n, next);
+
+        // U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5, C22 = U3 + P5, C12 = U4 + P3
+        addBlocks(m, n, p1, n, c12, outStride, c12, outStride);
+        addBlocks(m, n, c12, outStride, c21, outStride, c21, outStride);
+        addBlocks(m, n, c12, outStride, c22, outStride, c12, outStride);
+        addBlocks(m, n, c21, outStride, c22, outStride, c22, outStride);
+        addBlocks(m, n, c12, outStride, c11, outStride, c12, outStride);
+        // C21 = U3 - P4 with P4 = A22 (T2 - B21)
+        subtractBlocks(k, n, y, n, b21, rightStride, y, n);
+        multiplyStrassen(m, k, n, a22, leftStride, y, n, c11, outStride, next);
+        subtractBlocks(m, n, c21, outStride, c11, outStride, c21, outStride);
+        // C11 = P1 + P2 with P2 = A12 B21
+        multiplyStrassen(m, k, n, a12, leftStride, b21, rightStride, c11, outStride, next);
+        addBlocks(m, n, c11, outStride, p1, n, c11, outStride);
+
+        if (inner % 2 != 0) {
+            // rank one update with the last column of left and the last row of right
+            const Value* rightRow = right + (inner - 1) * rightStride;
+            for (Dimension row = 0; row < 2 * m; row++) {
+                const Value leftValue = left[row * leftStride + inner - 1];
+                Value* outRow = out + row * outStride;
+                for (Dimension column = 0; column < 2 * n; column++) {
+                    outRow[column] += leftValue * rightRow[column];
+                }
+            }
+        }
+        if (columns % 2 != 0) {
+            multiplyClassical(2 * m, inner, 1, left, leftStride, right + columns - 1, rightStride, out + columns - 1, outStride);
+        }
+        if (rows % 2 != 0) {
+            multiplyClassical(1, inner, columns, left + (rows - 1) * leftStride, leftStride, right, rightStride,
+                out + (rows - 1) * outStride, outStride);
+        }
+    }
+
+    /// @brief i-k-j order: the inner loop runs along rows of the right matrix and the output, so it is unit stride
+    template <class Value>
+    void MatrixMultiplier::multiplySmall(const Dimension rows, const Dimension inner, const Dimension columns,
+        const Value* left, const Dimension leftStride,
+        const Value* right, const Dimension rightStride,
+        Value* out, const Dimension outStride) {
+        for (Dimension row = 0; row < rows; row++) {
+            Value* outRow = out + row * outStride;
+            const Value* leftRow = left + row * leftStride;
+            for (Dimension k = 0; k < inner; k++) {
+                const Value leftValue = leftRow[k];
+                const Value* rightRow = right + k * rightStride;
+                for (Dimension column = 0; column < columns; column++) {
+                    outRow[column] += leftValue * rightRow[column];
+                }
+            }
+        }
+    }
+
+    /// @brief Goto style blocking: a panel of the right matrix is packed once per (column block, inner block),
+    /// a block of the left matrix once per row block, and the micro-kernel walks both packed buffers sequentially.
+    template <class Value>
+    void MatrixMultiplier::multiplyBlocked(const Dimension rows, const Dimension inner, const Dimension columns,
+        const Value* left, const Dimension leftStride,
+        const Value* right, const Dimension rightStride,
+        Value* out, const Dimension outStride) {
+
+        const auto roundUp = [](const Dimension value, const Dimension multiple) {
+            return (value + multiple - 1) / multiple * multiple;
+        };
+        std::vector<Value> packedLeft(roundUp(minimum(rows, BlockRows), TileRows) * minimum(inner, BlockInner));
+        std::vector<Value> packedRight(roundUp(minimum(columns, BlockColumns), TileColumns) * minimum(inner, BlockInner));
+
+        for (Dimension columnBlock = 0; columnBlock < columns; columnBlock += BlockColumns) {
+            const Dimension blockColumns = minimum(BlockColumns, columns - columnBlock);
+            for (Dimension innerBlock = 0; innerBlock < inner; innerBlock += BlockInner) {
+                const Dimension blockInner = minimum(BlockInner, inner - innerBlock);
+                packRight(blockInner, blockColumns, right + innerBlock * rightStride + columnBlock, rightStride, packedRight.data());
+
+                for (Dimension rowBlock = 0; rowBlock < rows; rowBlock += BlockRows) {
+                    const Dimension blockRows = minimum(BlockRows, rows - rowBlock);
+                    packLeft(blockRows, blockInner, left + rowBlock * leftStride + innerBlock, leftStride, packedLeft.data());
+
+                    for (Dimension panelColumn = 0; panelColumn < blockColumns; panelColumn += TileColumns) {
+                        const Value* rightPanel = packedRight.data() + panelColumn * blockInner;
+                        const Dimension validColumns = minimum(TileColumns, blockColumns - panelColumn);
+                        for (Dimension panelRow = 0; panelRow < blockRows; panelRow += TileRows) {
+                            const Value* leftPanel = packedLeft.data() + panelRow * blockInner;
+                            const Dimension validRows = minimum(TileRows, blockRows - panelRow);
+                            Value* outTile = out + (rowBlock + panelRow) * outStride + columnBlock + panelColumn;
+                            microKernel(blockInner, leftPanel, rightPanel, outTile, outStride, validRows, validColumns);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef MATRIXMULTIPLIER_H
+#define MATRIXMULTIPLIER_H
+
+#include "Array.h"
+
+namespace RixMatrix {
+
+    enum class MultiplicationAlgorithm { Classical, StrassenWinograd };
+
+    /// Matrix multiplication kernel on raw row-major double or float storage: out = left * right.
+    /// Small products use a plain i-k-j loop; larger ones are cache blocked with packed panels and a register tiled micro-kernel.
+    /// The strides are the distance between rows, so the kernel also works on blocks inside a larger matrix.
+    /// If the ThreadPool is enabled, large products are split into blocks of the output that are computed in parallel.
+    /// Optionally, very large products use the Strassen-Winograd recursion (7 instead of 8 half size products per level)
+    /// down to the Strassen cutoff, below which the classical kernel takes over.
+    class MatrixMultiplier {
+    public:
+        static void multiply(Dimension rows, Dimension inner, Dimension columns,
+            const double* left, Dimension leftStride,
+            const double* right, Dimension rightStride,
+            double* out, Dimension outStride);
+
+        static void multiply(Dimension rows, Dimension inner, Dimension columns,
+            const float* left, Dimension leftStride,
+            const float* right, Dimension rightStride,
+            float* out, Dimension outStride);
+
+        static MultiplicationAlgorithm getAlgorithm();
+        // Classical is the default. StrassenWinograd does O(n^2.81) work, but rounds a bit differently: the error grows
+        // with the recursion depth instead of with the inner dimension.
+        static void setAlgorithm(MultiplicationAlgorithm algorithm);
+
+        // StrassenWinograd only recurses while rows, inner and columns are all at least the cutoff
+        static Dimension getStrassenCutoff();
+        static void setStrassenCutoff(Dimension cutoff);
+        static constexpr Dimension DefaultStrassenCutoff = 256;
+
+        // block sizes: a packed left block (BlockRows x BlockInner) should fit in L2, a packed right panel in L3
+        static constexpr Dimension BlockRows = 64;
+        static constexpr Dimension BlockInner = 256;
+        static constexpr Dimension BlockColumns = 512;
+
+        // below this number of multiply-adds, packing costs more than it saves
+        static constexpr unsigned long SmallProductLimit = 32 * 32 * 32;
+
+        // below this number of multiply-adds, handing out work to other threads costs more than it saves
+        static constexpr unsigned long ParallelProductLimit = 128 * 128 * 128;
+
+    private:
+        template <class Value>
+        static void multiplyValues(Dimension rows, Dimension inner, Dimension columns,
+            const Value* left, Dimension leftStride,
+            const Value* right, Dimension rightStride,
+            Value* out, Dimension outStride);
+
+        template <class Value>
+        static void multiplyClassical(Dimension rows, Dimension inner, Dimension columns,
+            const Value* left, Dimension leftStride,
+            const Value* right, Dimension rightStride,
+            Value* out, Dimension outStride);
+
+        template <class Value>
+        static void multiplyStrassen(Dimension rows, Dimension inner, Dimension columns,
+            const Value* left, Dimension leftStride,
+            const Value* right, Dimension rightStride,
+            Value* out, Dimension outStride, Value* workspace);
+
+        template <class Value>
+        static void multiplySmall(Dimension rows, Dimension inner, Dimension columns,
+            const Value* left, Dimension leftStride,
+            const Value* right, Dimension rightStride,
+            Value* out, Dimension outStride);
+
+        template <class Value>
+        static void multiplyBlocked(Dimension rows, Dimension inner, Dimension columns,
+            const Value* left, Dimension leftStride,
+            const Value* right, Dimension rightStride,
+            Value* out, Dimension outStride);
+    };
+}
+#endif
@@ -0,0 +1,650 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "MatrixTextFile.h"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace RixMatrix {
+
+    constexpr std::size_t MatrixTextFile::ChunkSize;
+
+    namespace {
+        /// @brief closes the file when going out of scope
+        class File {
+        public:
+            File(const std::string& path, const char* mode) : _file(std::fopen(path.c_str(), mode)) {}
+            ~File() {
+                if (_file != nullptr) std::fclose(_file);
+            }
+            File(const File&) = delete;
+            File& operator=(const File&) = delete;
+
+            // returns false if the data still buffered by the C library can't be written
+            bool close() {
+                const bool isClosed = std::fclose(_file) == 0;
+                _file = nullptr;
+                return isClosed;
+            }
+
+            std::FILE* get() const { return _file; }
+            bool isOpen() const { return _file != nullptr; }
+
+        private:
+            std::FILE* _file;
+        };
+
+        /// @brief Hands out the lines of a file, reading it in chunks. A line is only valid until the next call.
+        /// Lines are pointers into the buffer, so no strings get allocated.
+        class LineReader {
+        public:
+            explicit LineReader(std::FILE* file) : _file(file), _buffer(MatrixTextFile::ChunkSize) {}
+
+            // the line end (\n or \r\n) is not part of the line
+            bool nextLine(const char*& begin, const char*& end) {
+                while (true) {
+                    const char* start = _buffer.data() + _position;
+                    const auto* newline = static_cast<const char*>(std::memchr(start, '\n', _filled - _position));
+                    if (newline != nullptr) {
+                        _position = static_cast<std::size_t>(newline - _buffer.data()) + 1;
+                        return setLine(start, newline, begin, end);
+                    }
+                    if (_isEndOfFile) {
+                        if (_position == _filled) return false;
+                        _position = _filled;
+                        return setLine(start, _buffer.data() + _filled, begin, end);
+                    }
+                    fill();
+                }
+            }
+
+            bool rewind() {
+                _position = 0;
+                _filled = 0;
+                _isEndOfFile = false;
+                return std::fseek(_file, 0, SEEK_SET) == 0;
+            }
+
+        private:
+            static bool setLine(const char* start, const char* stop, const char*& begin, const char*& end) {
+                if (stop > start && stop[-1] == '\r') stop--;
+                begin = start;
+                end = stop;
+                return true;
+            }
+
+            // keep the incomplete last line, moved to the front, and append the next chunk
+            void fill() {
+                const std::size_t remaining = _filled - _position;
+                std::memmove(_buffer.data(), _buffer.data() + _position, remaining);
+                _position = 0;
+                _filled = remaining;
+                if (_filled == _buffer.size()) _buffer.resize(2 * _buffer.size());
+                const std::size_t bytesRead = std::fread(_buffer.data() + _filled, 1, _buffer.size() - _filled, _file);
+                _filled += bytesRead;
+                if (bytesRead == 0) _isEndOfFile = true;
+            }
+
+            std::FILE* _file;
+            std::vector<char> _buffer;
+            std::size_t _position = 0;
+            std::size_t _filled = 0;
+            bool _isEndOfFile = false;
+        };
+
+        /// @brief Collects output in a buffer and writes it in chunks
+        class BufferedWriter {
+        public:
+            explicit BufferedWriter(std::FILE* file) : _file(file) {
+                _buffer.reserve(MatrixTextFile::ChunkSize);
+            }
+
+            void write(const char* text, const std::size_t length) {
+                if (_buffer.size() + length > MatrixTextFile::ChunkSize) flush();
+                _buffer.insert(_buffer.end(), text, text + length);
+            }
+
+            void write(const char* text) {
+                write(text, std::strlen(text));
+            }
+
+            void write(const char character) {
+                write(&character, 1);
+            }
+
+            void write(const unsigned long number) {
+                char text[24];
+                write(text, static_cast<std::size_t>(std::snprintf(text, sizeof text, "%lu", number)));
+            }
+
+            // shortest format that reads back to the same value
+            template <class Value>
+            void writeValue(const Value value) {
+                char text[32];
+                const int length = std::snprintf(text, sizeof text, "%.*g", std::numeric_limits<Value>::max_digits10, static_cast<double>(value));
+                write(text, static_cast<std::size_t>(length));
+            }
+
+            bool flush() {
+                if (!_buffer.empty() && std::fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size()) _isFailed = true;
+                _buffer.clear();
+                return !_isFailed;
+            }
+
+        private:
+            std::FILE* _file;
+            std::vector<char> _buffer;
+            bool _isFailed = false;
+        };
+
+        // 10^0 .. 10^22 are exact in a double
+        const double PowersOfTen[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        constexpr int MaxExactPower = 22;
+        constexpr std::uint64_t MaxExactMantissa = std::uint64_t(1) << 53;
+        // more digits don't fit in the 64 bit mantissa
+        constexpr int MaxMantissaDigits = 19;
+        // the same for float: 10^0 .. 10^10 and integers up to 2^24 are exact
+        constexpr int MaxExactFloatPower = 10;
+        constexpr std::uint64_t MaxExactFloatMantissa = std::uint64_t(1) << 24;
+
+#ifdef __SIZEOF_INT128__
+        using Wide = unsigned __int128;
+
+        // 5^27 is the largest power of 5 in 64 bits that still leaves room for a 64 bit mantissa in a 128 bit product
+        constexpr int MaxWidePower = 27;
+
+        std::uint64_t powerOfFive(const int exponent) {
+            std::uint64_t result = 1;
+            for (int power = 0; power < exponent; power++) result *= 5;
+            return result;
+        }
+
+        int bitCount(const Wide value) {
+            const auto high = static_cast<std::uint64_t>(value >> 64);
+            const auto low = static_cast<std::uint64_t>(value);
+            if (high != 0) return 128 - __builtin_clzll(high);
+            return low == 0 ? 0 : 64 - __builtin_clzll(low);
+        }
+
+        /// @brief (value + a bit of sticky remainder) * 2^exponent, rounded to nearest even
+        double roundToDouble(const Wide value, const bool isInexact, const int exponent) {
+            const int bits = bitCount(value);
+            if (bits <= 53) return std::ldexp(static_cast<double>(static_cast<std::uint64_t>(value)), exponent);
+            // keep 53 bits and a guard bit; everything below goes in the sticky bit
+            const int shift = bits - 54;
+            const auto kept = static_cast<std::uint64_t>(value >> shift);
+            const bool isSticky = isInexact || (value & ((Wide(1) << shift) - 1)) != 0;
+            std::uint64_t mantissa = kept >> 1;
+            if ((kept & 1) != 0 && (isSticky || (mantissa & 1) != 0)) mantissa++;
+            return std::ldexp(static_cast<double>(mantissa), exponent + shift + 1);
+        }
+
+        /// @brief correctly rounded mantissa * 10^exponent in integer arithmetic, as 10^e = 5^e 2^e:
+        /// an exact product for positive exponents, and a long division with a sticky remainder for negative ones
+        double scaleExactly(const std::uint64_t mantissa, const int exponent) {
+            if (mantissa == 0) return 0;
+            if (exponent >= 0) return roundToDouble(Wide(mantissa) * powerOfFive(exponent), false, exponent);
+            // shift the mantissa to the top, so the quotient has more than the 54 bits we need
+            const int shift = 128 - bitCount(mantissa);
+            const Wide numerator = Wide(mantissa) << shift;
+            const std::uint64_t divisor = powerOfFive(-exponent);
+            return roundToDouble(numerator / divisor, numerator % divisor != 0, exponent - shift);
+        }
+#endif
+
+        bool isBlank(const char character) {
+            return character == ' ' || character == '\t' || character == '\r';
+        }
+
+        bool isDigit(const char character) {
+            return character >= '0' && character <= '9';
+        }
+
+        const char* skipBlanks(const char* cursor, const char* end) {
+            while (cursor < end && isBlank(*cursor)) cursor++;
+            return cursor;
+        }
+
+        bool isBlankLine(const char* begin, const char* end) {
+            return skipBlanks(begin, end) == end;
+        }
+
+        void parseToken(const char* token, char** parsedEnd, double& value) {
+            value = std::strtod(token, parsedEnd);
+        }
+
+        void parseToken(const char* token, char** parsedEnd, float& value) {
+            value = std::strtof(token, parsedEnd);
+        }
+
+        /// @brief strtod (strtof for floats) on a copy of the token, for what the fast path can't do exactly (long mantissas,
+        /// large exponents, inf, nan). The copy is on the stack unless the token is unusually long.
+        template <class Value>
+        const char* parseSlow(const char* start, const char* end, const char delimiter, Value& value) {
+            const char* tokenEnd = start;
+            while (tokenEnd < end && !isBlank(*tokenEnd) && *tokenEnd != delimiter) tokenEnd++;
+            const auto tokenLength = static_cast<std::size_t>(tokenEnd - start);
+            char buffer[64];
+            std::string longToken;
+            const char* token = buffer;
+            if (tokenLength < sizeof buffer) {
+                std::memcpy(buffer, start, tokenLength);
+                buffer[tokenLength] = 0;
+            } else {
+                longToken.assign(start, tokenEnd);
+                token = longToken.c_str();
+            }
+            char* parsedEnd;
+            parseToken(token, &parsedEnd, value);
+            const auto length = static_cast<std::size_t>(parsedEnd - token);
+            return length == 0 ? nullptr : start + length;
+        }
+
+        // a decimal number as mantissa * 10^exponent. Not exact if digits beyond the mantissa were dropped.
+        struct Decimal {
+            std::uint64_t mantissa = 0;
+            int exponent = 0;
+            bool isNegative = false;
+            bool isExact = true;
+        };
+
+        /// @brief Reads a decimal number at cursor. Returns the position after it, or nullptr if it has no digits (e.g. inf).
+        const char* scanDecimal(const char* cursor, const char* end, Decimal& decimal) {
+            if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+                decimal.isNegative = *cursor == '-';
+                cursor++;
+            }
+            int digits = 0;
+            bool hasDigits = false;
+            for (; cursor < end && isDigit(*cursor); cursor++) {
+                hasDigits = true;
+                if (digits < MaxMantissaDigits) {
+                    decimal.mantissa = decimal.mantissa * 10 + static_cast<unsigned>(*cursor - '0');
+                    if (decimal.mantissa != 0) digits++;
+                } else {
+                    decimal.exponent++;
+                    if (*cursor != '0') decimal.isExact = false;
+                }
+            }
+            if (cursor < end && *cursor == '.') {
+                for (cursor++; cursor < end && isDigit(*cursor); cursor++) {
+                    hasDigits = true;
+                    if (digits < MaxMantissaDigits) {
+                        decimal.mantissa = decimal.mantissa * 10 + static_cast<unsigned>(*cursor - '0');
+                        if (decimal.mantissa != 0) digits++;
+                        decimal.exponent--;
+                    } else if (*cursor != '0') {
+                        decimal.isExact = false;
+                    }
+                }
+            }
+            if (!hasDigits) return nullptr;
+
+            if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+                const char* exponentStart = cursor++;
+                bool isExponentNegative = false;
+                if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+                    isExponentNegative = *cursor == '-';
+                    cursor++;
+                }
+                if (cursor == end || !isDigit(*cursor)) {
+                    cursor = exponentStart;
+                } else {
+                    int exponentValue = 0;
+                    for (; cursor < end && isDigit(*cursor); cursor++) {
+                        // beyond this, it's all overflow or underflow anyway
+                        if (exponentValue < 100000) exponentValue = exponentValue * 10 + (*cursor - '0');
+                    }
+                    decimal.exponent += isExponentNegative ? -exponentValue : exponentValue;
+                }
+            }
+            return cursor;
+        }
+
+        /// @brief Correctly rounded conversion without strtod: with a single exact multiplication or division (Clinger's
+        /// fast path) if the mantissa fits in a double, and otherwise in 128 bit integer arithmetic where the compiler
+        /// supports it. Returns false if neither applies.
+        bool convertExactly(const Decimal& decimal, double& value) {
+            if (!decimal.isExact) return false;
+            const int exponent = decimal.exponent;
+            if (decimal.mantissa <= MaxExactMantissa && exponent >= -MaxExactPower && exponent <= MaxExactPower) {
+                const auto magnitude = static_cast<double>(decimal.mantissa);
+                value = exponent < 0 ? magnitude / PowersOfTen[-exponent] : magnitude * PowersOfTen[exponent];
+                return true;
+            }
+#ifdef __SIZEOF_INT128__
+            if (exponent >= -MaxWidePower && exponent <= MaxWidePower) {
+                // the 17 digits needed to round trip a double don't fit the fast path
+                value = scaleExactly(decimal.mantissa, exponent);
+                return true;
+            }
+#endif
+            return false;
+        }
+
+        /// @brief Clinger's fast path in float arithmetic. Going through double would round twice, which can differ
+        /// from strtof when the decimal is close to halfway between two floats.
+        bool convertExactly(const Decimal& decimal, float& value) {
+            const int exponent = decimal.exponent;
+            if (!decimal.isExact || decimal.mantissa > MaxExactFloatMantissa || exponent < -MaxExactFloatPower ||
+                exponent > MaxExactFloatPower) return false;
+            const auto magnitude = static_cast<float>(decimal.mantissa);
+            const auto power = static_cast<float>(PowersOfTen[exponent < 0 ? -exponent : exponent]);
+            value = exponent < 0 ? magnitude / power : magnitude * power;
+            return true;
+        }
+
+        /// @brief Parses the number at cursor, after skipping blanks. Returns the position after it, or nullptr if there is no number.
+        /// Decimal numbers with a short enough mantissa and a small enough exponent, which is nearly everything in data files,
+        /// are converted without strtod (or strtof) and still correctly rounded.
+        template <class Value>
+        const char* parseNumber(const char* cursor, const char* end, const char delimiter, Value& value) {
+            cursor = skipBlanks(cursor, end);
+            const char* start = cursor;
+            Decimal decimal;
+            cursor = scanDecimal(cursor, end, decimal);
+            if (cursor == nullptr || !convertExactly(decimal, value)) return parseSlow(start, end, delimiter, value);
+            if (decimal.isNegative) value = -value;
+            return cursor;
+        }
+
+        /// @brief position after the separator following a value, or nullptr if there is none.
+        /// A blank delimiter (space or tab) means any run of blanks.
+        const char* skipSeparator(const char* cursor, const char* end, const char delimiter) {
+            const char* next = skipBlanks(cursor, end);
+            if (isBlank(delimiter)) return next == cursor || next == end ? nullptr : next;
+            return next == end || *next != delimiter ? nullptr : next + 1;
+        }
+
+        Dimension countFields(const char* begin, const char* end, const char delimiter) {
+            Dimension fields = 0;
+            if (isBlank(delimiter)) {
+                for (const char* cursor = skipBlanks(begin, end); cursor < end; cursor = skipBlanks(cursor, end)) {
+                    fields++;
+                    while (cursor < end && !isBlank(*cursor)) cursor++;
+                }
+                return fields;
+            }
+            for (const char* cursor = begin; cursor < end; cursor++) {
+                if (*cursor == delimiter) fields++;
+            }
+            return fields + 1;
+        }
+
+        template <class Value>
+        bool parseRow(const char* cursor, const char* end, const char delimiter, Value* row, const Dimension columns) {
+            for (Dimension column = 0; column < columns; column++) {
+                if (column > 0) {
+                    cursor = skipSeparator(cursor, end, delimiter);
+                    if (cursor == nullptr) return false;
+                }
+                cursor = parseNumber(cursor, end, delimiter, row[column]);
+                if (cursor == nullptr) return false;
+            }
+            return isBlankLine(cursor, end);
+        }
+
+        bool skipLines(LineReader& reader, const unsigned int lines) {
+            const char* begin;
+            const char* end;
+            for (unsigned int line = 0; line < lines; line++) {
+                if (!reader.nextLine(begin, end)) return false;
+            }
+            return true;
+        }
+
+        /// @brief parses an integer that must fit in a Dimension
+        const char* parseDimension(const char* cursor, const char* end, Dimension& result) {
+            double value;
+            cursor = parseNumber(cursor, end, ' ', value);
+            if (cursor == nullptr || value < 0 || value > std::numeric_limits<Dimension>::max() ||
+                value != static_cast<double>(static_cast<Dimension>(value))) return nullptr;
+            result = static_cast<Dimension>(value);
+            return cursor;
+        }
+
+        enum class Symmetry { General, Symmetric, SkewSymmetric };
+
+        struct MatrixMarketHeader {
+            bool isCoordinate;
+            bool isPattern;
+            Symmetry symmetry;
+        };
+
+        /// @brief parses the banner, e.g. "%%MatrixMarket matrix coordinate real symmetric" (case insensitive).
+        /// Complex and hermitian matrices aren't supported.
+        bool parseBanner(const char* begin, const char* end, MatrixMarketHeader& header) {
+            std::vector<std::string> words;
+            for (const char* cursor = skipBlanks(begin, end); cursor < end; cursor = skipBlanks(cursor, end)) {
+                std::string word;
+                for (; cursor < end && !isBlank(*cursor); cursor++) {
+                    word += static_cast<char>(std::tolower(static_cast<unsigned char>(*cursor)));
+                }
+                words.push_back(word);
+            }
+            if (words.size() != 5 || words[0] != "%%matrixmarket" || words[1] != "matrix") return false;
+            if (words[2] != "array" && words[2] != "coordinate") return false;
+            if (words[3] != "real" && words[3] != "double" && words[3] != "integer" && words[3] != "pattern") return false;
+            header.isCoordinate = words[2] == "coordinate";
+            header.isPattern = words[3] == "pattern";
+            if (header.isPattern && !header.isCoordinate) return false;
+            if (words[4] == "general") header.symmetry = Symmetry::General;
+            else if (words[4] == "symmetric") header.symmetry = Symmetry::Symmetric;
+            else if (words[4] == "skew-symmetric") header.symmetry = Symmetry::SkewSymmetric;
+            else return false;
+            return true;
+        }
+
+        /// @brief next line that is not a comment or blank
+        bool nextDataLine(LineReader& reader, const char*& begin, const char*& end) {
+            while (reader.nextLine(begin, end)) {
+                if (!isBlankLine(begin, end) && *skipBlanks(begin, end) != '%') return true;
+            }
+            return false;
+        }
+
+        template <class Value>
+        void setElement(BasicArray<Value>& array, const Dimension row, const Dimension column, const Value value, const Symmetry symmetry) {
+            array(row, column) += value;
+            if (row == column || symmetry == Symmetry::General) return;
+            array(column, row) += symmetry == Symmetry::Symmetric ? value : -value;
+        }
+
+        /// @brief dense values are listed column by column; for (skew) symmetric matrices only the lower triangle
+        template <class Value>
+        bool readMatrixMarketArray(LineReader& reader, BasicArray<Value>& result, const Symmetry symmetry) {
+            const auto firstRow = [symmetry](const Dimension column) {
+                return symmetry == Symmetry::General ? 0 : symmetry == Symmetry::Symmetric ? column : column + 1;
+            };
+            Dimension column = 0;
+            Dimension row = firstRow(column);
+            // move on to the next column with something to fill when the current one is done
+            const auto skipFullColumns = [&]() {
+                while (column < result.columnCount() && row >= result.rowCount()) {
+                    column++;
+                    row = firstRow(column);
+                }
+            };
+            skipFullColumns();
+            const char* begin;
+            const char* end;
+            while (nextDataLine(reader, begin, end)) {
+                for (const char* cursor = begin; !isBlankLine(cursor, end);) {
+                    if (column == result.columnCount()) return false;
+                    Value value;
+                    cursor = parseNumber(cursor, end, ' ', value);
+                    if (cursor == nullptr) return false;
+                    setElement(result, row, column, value, symmetry);
+                    row++;
+                    skipFullColumns();
+                }
+            }
+            return column == result.columnCount();
+        }
+
+        template <class Value>
+        bool readMatrixMarketCoordinate(LineReader& reader, BasicArray<Value>& result, const MatrixMarketHeader& header, const Dimension entries) {
+            const char* begin;
+            const char* end;
+            Dimension entry = 0;
+            for (; entry < entries && nextDataLine(reader, begin, end); entry++) {
+                Dimension row;
+                Dimension column;
+                const char* cursor = parseDimension(begin, end, row);
+                if (cursor == nullptr) return false;
+                cursor = parseDimension(cursor, end, column);
+                if (cursor == nullptr || row == 0 || column == 0 || row > result.rowCount() || column > result.columnCount()) return false;
+                Value value = 1;
+                if (!header.isPattern) {
+                    cursor = parseNumber(cursor, end, ' ', value);
+                    if (cursor == nullptr) return false;
+                }
+                if (!isBlankLine(cursor, end)) return false;
+                setElement(result, row - 1, column - 1, value, header.symmetry);
+            }
+            return entry == entries && !nextDataLine(reader, begin, end);
+        }
+    }
+
+    template <class Value>
+    bool MatrixTextFile::loadCsv(const std::string& path, BasicArray<Value>& array, const char delimiter, const unsigned int headerLines) {
+        File file(path, "rb");
+        if (!file.isOpen()) return false;
+        LineReader reader(file.get());
+        const char* begin;
+        const char* end;
+
+        // first pass: count the rows, so the array can be allocated once
+        if (!skipLines(reader, headerLines)) return false;
+        Dimension rows = 0;
+        Dimension columns = 0;
+        while (reader.nextLine(begin, end)) {
+            if (isBlankLine(begin, end)) continue;
+            if (rows == 0) columns = countFields(begin, end, delimiter);
+            rows++;
+        }
+
+        BasicArray<Value> result(rows, columns);
+        if (!reader.rewind() || !skipLines(reader, headerLines)) return false;
+        Dimension row = 0;
+        while (reader.nextLine(begin, end)) {
+            if (isBlankLine(begin, end)) continue;
+            if (row == rows || !parseRow(begin, end, delimiter, result.data() + row * columns, columns)) return false;
+            row++;
+        }
+        if (row != rows) return false;
+        array = std::move(result);
+        return true;
+    }
+
+    template <class Value>
+    bool MatrixTextFile::saveCsv(const std::string& path, const BasicArray<Value>& array, const char delimiter) {
+        File file(path, "wb");
+        if (!file.isOpen()) return false;
+        BufferedWriter writer(file.get());
+        for (Dimension row = 0; row < array.rowCount(); row++) {
+            for (Dimension column = 0; column < array.columnCount(); column++) {
+                if (column > 0) writer.write(delimiter);
+                writer.writeValue(array(row, column));
+            }
+            writer.write('\n');
+        }
+        const bool isFlushed = writer.flush();
+        return file.close() && isFlushed;
+    }
+
+    template <class Value>
+    bool MatrixTextFile::loadMatrixMarket(const std::string& path, BasicArray<Value>& array) {
+        File file(path, "rb");
+        if (!file.isOpen()) return false;
+        LineReader reader(file.get());
+        const char* begin;
+        const char* end;
+        MatrixMarketHeader header;
+        if (!reader.nextLine(begin, end) || !parseBanner(begin, end, header)) return false;
+
+        Dimension rows;
+        Dimension columns;
+        Dimension entries = 0;
+        if (!nextDataLine(reader, begin, end)) return false;
+        const char* cursor = parseDimension(begin, end, rows);
+        if (cursor != nullptr) cursor = parseDimension(cursor, end, columns);
+        if (cursor != nullptr && header.isCoordinate) cursor = parseDimension(cursor, end, entries);
+        if (cursor == nullptr || !isBlankLine(cursor, end)) return false;
+        if (header.symmetry != Symmetry::General && rows != columns) return false;
+
+        BasicArray<Value> result(rows, columns);
+        const bool isRead = header.isCoordinate
+            ? readMatrixMarketCoordinate(reader, result, header, entries)
+            : readMatrixMarketArray(reader, result, header.symmetry);
+        if (!isRead) return false;
+        array = std::move(result);
+        return true;
+    }
+
+    template <class Value>
+    bool MatrixTextFile::saveMatrixMarket(const std::string& path, const BasicArray<Value>& array, const MatrixMarketFormat format) {
+        File file(path, "wb");
+        if (!file.isOpen()) return false;
+        BufferedWriter writer(file.get());
+        const bool isCoordinate = format == MatrixMarketFormat::Coordinate;
+        writer.write(isCoordinate ? "%%MatrixMarket matrix coordinate real general\n" : "%%MatrixMarket matrix array real general\n");
+        writer.write(static_cast<unsigned long>(array.rowCount()));
+        writer.write(' ');
+        writer.write(static_cast<unsigned long>(array.columnCount()));
+        if (isCoordinate) {
+            unsigned long nonZeros = 0;
+            for (Dimension cell = 0; cell < array.size(); cell++) {
+                if (array[cell] != 0) nonZeros++;
+            }
+            writer.write(' ');
+            writer.write(nonZeros);
+        }
+        writer.write('\n');
+
+        // column major, as the format prescribes
+        for (Dimension column = 0; column < array.columnCount(); column++) {
+            for (Dimension row = 0; row < array.rowCount(); row++) {
+                const Value value = array(row, column);
+                if (isCoordinate) {
+                    if (value == 0) continue;
+                    writer.write(static_cast<unsigned long>(row + 1));
+                    writer.write(' ');
+                    writer.write(static_cast<unsigned long>(column + 1));
+                    writer.write(' ');
+                }
+                writer.writeValue(value);
+                writer.write('\n');
+            }
+        }
+        const bool isFlushed = writer.flush();
+        return file.close() && isFlushed;
+    }
+
+    template bool MatrixTextFile::loadCsv(const std::string& path, BasicArray<float>& array, char delimiter, unsigned int headerLines);
+    template bool MatrixTextFile::loadCsv(const std::string& path, BasicArray<double>& array, char delimiter, unsigned int headerLines);
+    template bool MatrixTextFile::saveCsv(const std::string& path, const BasicArray<float>& array, char delimiter);
+    template bool MatrixTextFile::saveCsv(const std::string& path, const BasicArray<double>& array, char delimiter);
+    template bool MatrixTextFile::loadMatrixMarket(const std::string& path, BasicArray<float>& array);
+    template bool MatrixTextFile::loadMatrixMarket(const std::string& path, BasicArray<double>& array);
+    template bool MatrixTextFile::saveMatrixMarket(const std::string& path, const BasicArray<float>& array, MatrixMarketFormat format);
+    template bool MatrixTextFile::saveMatrixMarket(const std::string& path, const BasicArray<double>& array, MatrixMarketFormat format);
+}
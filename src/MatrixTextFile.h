@@ -0,0 +1,49 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef MATRIXTEXTFILE_H
+#define MATRIXTEXTFILE_H
+
+#include <cstddef>
+#include <string>
+#include "Array.h"
+
+namespace RixMatrix {
+
+    enum class MatrixMarketFormat { Array, Coordinate };
+
+    /// Reads and writes arrays and matrices as CSV or MatrixMarket text files.
+    /// Reading streams the file through a fixed size buffer and parses the numbers in place, without creating a string
+    /// per line or cell. The array is allocated once: for CSV, a first pass over the file counts the rows; MatrixMarket
+    /// files state the size in their header.
+    /// All functions return false if the file can't be opened or is malformed; the array is then left untouched.
+    class MatrixTextFile {
+    public:
+        // One row per line, the same number of values on each line. Blank lines are skipped, as are headerLines lines at the start.
+        template <class Value>
+        static bool loadCsv(const std::string& path, BasicArray<Value>& array, char delimiter = ',', unsigned int headerLines = 0);
+
+        template <class Value>
+        static bool saveCsv(const std::string& path, const BasicArray<Value>& array, char delimiter = ',');
+
+        // real, integer or pattern fields; general, symmetric or skew-symmetric matrices; array (dense) or coordinate format
+        template <class Value>
+        static bool loadMatrixMarket(const std::string& path, BasicArray<Value>& array);
+
+        // Coordinate only writes the non-zero elements
+        template <class Value>
+        static bool saveMatrixMarket(const std::string& path, const BasicArray<Value>& array, MatrixMarketFormat format = MatrixMarketFormat::Array);
+
+        // size of the read buffer. Lines can be longer; the buffer then grows to hold them.
+        static constexpr std::size_t ChunkSize = 1 << 20;
+    };
+}
+#endif
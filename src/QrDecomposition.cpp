@@ -0,0 +1,238 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "QrDecomposition.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace RixMatrix {
+
+    namespace {
+        template <class Value>
+        Value normOf(const Value* values, const Dimension count) {
+            Value result = 0;
+            for (Dimension index = 0; index < count; index++) {
+                result += values[index] * values[index];
+            }
+            return std::sqrt(result);
+        }
+    }
+
+    template <class Value>
+    BasicQrDecomposition<Value>::BasicQrDecomposition(const Dimension rows, const Dimension columns) :
+        _qr(rows, columns),
+        _tau(std::min(rows, columns)),
+        _permutation(rows),
+        _norms(rows),
+        _originalNorms(rows) {}
+
+    template <class Value>
+    BasicQrDecomposition<Value>::BasicQrDecomposition(const BasicMatrix<Value>& matrix) :
+        _qr(matrix),
+        _tau(std::min(matrix.rowCount(), matrix.columnCount())),
+        _permutation(matrix.rowCount()),
+        _norms(matrix.rowCount()),
+        _originalNorms(matrix.rowCount()) {
+        decompose();
+    }
+
+    template <class Value>
+    void BasicQrDecomposition<Value>::applyQ(BasicMatrix<Value>& vectors) const {
+        applyReflectors(vectors, static_cast<Dimension>(_tau.size()));
+    }
+
+    /// @brief multiply vectors by the product of the first reflectorCount reflectors, applying them in reverse order
+    /// to all columns at once. The rows of vectors are updated as a whole, so the access is sequential.
+    template <class Value>
+    void BasicQrDecomposition<Value>::applyReflectors(BasicMatrix<Value>& vectors, const Dimension reflectorCount) const {
+        const Dimension length = columnCount();
+        const Dimension columns = vectors.columnCount();
+        assert(vectors.rowCount() == length && reflectorCount <= _tau.size());
+        if (columns == 0) return;
+        Value* basis = vectors.data();
+        const Value* qr = _qr.data();
+        std::vector<Value> dots(columns);
+        for (Dimension step = reflectorCount; step-- > 0;) {
+            const Value tau = _tau[step];
+            if (tau == 0) continue;
+            const Value* vector = qr + step * length;
+            std::copy(basis + step * columns, basis + (step + 1) * columns, dots.begin());
+            for (Dimension index = step + 1; index < length; index++) {
+                const Value factor = vector[index];
+                const Value* row = basis + index * columns;
+                for (Dimension column = 0; column < columns; column++) {
+                    dots[column] += factor * row[column];
+                }
+            }
+            for (Dimension column = 0; column < columns; column++) {
+                basis[step * columns + column] -= tau * dots[column];
+            }
+            for (Dimension index = step + 1; index < length; index++) {
+                const Value factor = tau * vector[index];
+                Value* row = basis + index * columns;
+                for (Dimension column = 0; column < columns; column++) {
+                    row[column] -= factor * dots[column];
+                }
+            }
+        }
+    }
+
+    template <class Value>
+    Dimension BasicQrDecomposition<Value>::columnCount() const {
+        return _qr.columnCount();
+    }
+
+    /// @brief decompose another matrix of the same size, reusing the workspace
+    template <class Value>
+    void BasicQrDecomposition<Value>::decompose(const BasicMatrix<Value>& matrix) {
+        assert(matrix.rowCount() == rowCount() && matrix.columnCount() == columnCount());
+        _qr = matrix;
+        decompose();
+    }
+
+    /// @brief Householder QR of A^T with column pivoting (LAPACK's xGEQP3 without blocking).
+    /// Step j takes the remaining row of A with the largest norm as pivot, and reflects it onto its first element.
+    /// The reflector is applied to all rows below it, and their norms are downdated instead of recalculated.
+    template <class Value>
+    void BasicQrDecomposition<Value>::decompose() {
+        const Dimension rows = rowCount();
+        const Dimension length = columnCount();
+        Value* qr = _qr.data();
+        std::iota(_permutation.begin(), _permutation.end(), 0);
+        for (Dimension row = 0; row < rows; row++) {
+            _norms[row] = normOf(qr + row * length, length);
+            _originalNorms[row] = _norms[row];
+        }
+        // below this, downdating has lost too many digits and the norm is recalculated
+        const Value downdateLimit = std::sqrt(std::numeric_limits<Value>::epsilon());
+
+        const Dimension steps = static_cast<Dimension>(_tau.size());
+        for (Dimension step = 0; step < steps; step++) {
+            const auto pivot = static_cast<Dimension>(std::max_element(_norms.begin() + step, _norms.end()) - _norms.begin());
+            if (pivot != step) {
+                std::swap_ranges(qr + step * length, qr + (step + 1) * length, qr + pivot * length);
+                std::swap(_norms[step], _norms[pivot]);
+                std::swap(_originalNorms[step], _originalNorms[pivot]);
+                std::swap(_permutation[step], _permutation[pivot]);
+            }
+
+            // H = I - tau v v^T with v[step] = 1 (not stored) maps the pivot row onto alpha e[step]
+            Value* vector = qr + step * length;
+            const Value tailNorm = normOf(vector + step + 1, length - step - 1);
+            const Value head = vector[step];
+            Value tau = 0;
+            if (tailNorm != 0) {
+                const Value norm = std::hypot(head, tailNorm);
+                const Value alpha = head >= 0 ? -norm : norm;
+                tau = (alpha - head) / alpha;
+                const Value scale = Value(1) / (head - alpha);
+                for (Dimension index = step + 1; index < length; index++) {
+                    vector[index] *= scale;
+                }
+                vector[step] = alpha;
+            }
+            _tau[step] = tau;
+
+            for (Dimension row = step + 1; row < rows; row++) {
+                Value* target = qr + row * length;
+                if (tau != 0) {
+                    Value dot = target[step];
+                    for (Dimension index = step + 1; index < length; index++) {
+                        dot += vector[index] * target[index];
+                    }
+                    dot *= tau;
+                    target[step] -= dot;
+                    for (Dimension index = step + 1; index < length; index++) {
+                        target[index] -= dot * vector[index];
+                    }
+                }
+                if (_norms[row] != 0) {
+                    const Value ratio = std::fabs(target[step]) / _norms[row];
+                    const Value remaining = std::max(Value(0), (1 - ratio) * (1 + ratio));
+                    const Value relative = _norms[row] / _originalNorms[row];
+                    if (remaining * relative * relative <= downdateLimit) {
+                        _norms[row] = normOf(target + step + 1, length - step - 1);
+                        _originalNorms[row] = _norms[row];
+                    }
+                    else {
+                        _norms[row] *= std::sqrt(remaining);
+                    }
+                }
+            }
+        }
+    }
+
+    /// @brief P R^T: row permutation[j] is column j of R, which only has elements up to j
+    template <class Value>
+    void BasicQrDecomposition<Value>::getCoordinates(BasicMatrix<Value>& result) const {
+        const Dimension rows = rowCount();
+        const auto steps = static_cast<Dimension>(_tau.size());
+        assert(result.rowCount() == rows && result.columnCount() == steps);
+        const Dimension length = columnCount();
+        const Value* qr = _qr.data();
+        for (Dimension pivot = 0; pivot < rows; pivot++) {
+            Value* target = result.data() + _permutation[pivot] * steps;
+            for (Dimension column = 0; column < steps; column++) {
+                target[column] = column <= pivot ? qr[pivot * length + column] : Value(0);
+            }
+        }
+    }
+
+    /// @brief Q times the unit vectors rank .. n-1.
+    /// The reflectors after the rank only mix those unit vectors among themselves, so they are skipped:
+    /// the result spans the same space and is orthonormal as well.
+    template <class Value>
+    BasicMatrix<Value> BasicQrDecomposition<Value>::getNullSpace(const Value relativeTolerance) const {
+        const Dimension length = columnCount();
+        const Dimension rank = getRank(relativeTolerance);
+        const Dimension nullity = length - rank;
+        BasicMatrix<Value> result(length, nullity);
+        if (nullity == 0) return result;
+
+        for (Dimension column = 0; column < nullity; column++) {
+            result(rank + column, column) = 1;
+        }
+        applyReflectors(result, rank);
+        return result;
+    }
+
+    template <class Value>
+    const std::vector<Dimension>& BasicQrDecomposition<Value>::getPermutation() const {
+        return _permutation;
+    }
+
+    template <class Value>
+    Dimension BasicQrDecomposition<Value>::getRank(const Value relativeTolerance) const {
+        const Dimension steps = static_cast<Dimension>(_tau.size());
+        if (steps == 0) return 0;
+        const Dimension length = columnCount();
+        const Value* qr = _qr.data();
+        const Value tolerance = relativeTolerance > 0
+            ? relativeTolerance
+            : static_cast<Value>(std::max(rowCount(), length)) * std::numeric_limits<Value>::epsilon();
+        // pivoting keeps the diagonal decreasing, so the first element is the largest
+        const Value threshold = tolerance * std::fabs(qr[0]);
+        Dimension rank = 0;
+        while (rank < steps && std::fabs(qr[rank * length + rank]) > threshold) rank++;
+        return rank;
+    }
+
+    template <class Value>
+    Dimension BasicQrDecomposition<Value>::rowCount() const {
+        return _qr.rowCount();
+    }
+
+    template class BasicQrDecomposition<float>;
+    template class BasicQrDecomposition<double>;
+}
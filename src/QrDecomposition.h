@@ -0,0 +1,66 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef QRDECOMPOSITION_H
+#define QRDECOMPOSITION_H
+
+#include <vector>
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Rank revealing QR decomposition of any m x n matrix A: Householder QR with column pivoting of its transpose,
+    /// A^T P = Q R. The rank is the number of significant diagonal elements of R, and the last n - rank columns of Q
+    /// are an orthonormal basis of the null space of A, so both come out of a single factorization.
+    /// The columns of A^T are the rows of A, so all the work is done on contiguous rows of a copy of A.
+    /// The workspace can be reused: construct with a size and call decompose, and nothing gets allocated after that.
+    template <class Value>
+    class BasicQrDecomposition {
+    public:
+        BasicQrDecomposition(Dimension rows, Dimension columns);
+        explicit BasicQrDecomposition(const BasicMatrix<Value>& matrix);
+
+        // multiply n x c vectors by Q, in place
+        void applyQ(BasicMatrix<Value>& vectors) const;
+        Dimension columnCount() const;
+        void decompose(const BasicMatrix<Value>& matrix);
+
+        // the coordinates of the rows of A in the basis Q, so A = C Q^T (m x min(m, n)). This is P R^T.
+        void getCoordinates(BasicMatrix<Value>& result) const;
+
+        // n x (n - rank), orthonormal columns. n x 0 if A has full column rank.
+        BasicMatrix<Value> getNullSpace(Value relativeTolerance = 0) const;
+
+        // the rows of A in pivot order: the first rank rows are linearly independent
+        const std::vector<Dimension>& getPermutation() const;
+
+        // the number of diagonal elements of R above relativeTolerance times the largest one.
+        // 0 means max(m, n) times the machine epsilon, the usual default.
+        Dimension getRank(Value relativeTolerance = 0) const;
+        Dimension rowCount() const;
+
+    private:
+        void applyReflectors(BasicMatrix<Value>& vectors, Dimension reflectorCount) const;
+        void decompose();
+
+        // A, overwritten with R^T on and below the diagonal, and with the Householder vectors above it
+        BasicMatrix<Value> _qr;
+        std::vector<Value> _tau;
+        std::vector<Dimension> _permutation;
+        // norms of the remaining parts of the rows, for pivoting
+        std::vector<Value> _norms;
+        std::vector<Value> _originalNorms;
+    };
+
+    using QrDecomposition = BasicQrDecomposition<double>;
+    using FloatQrDecomposition = BasicQrDecomposition<float>;
+}
+#endif
@@ -0,0 +1,371 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+// One-sided Jacobi SVD after Hestenes (1958), with the rotation formulas and stopping criterion of
+// Demmel and Veselic, "Jacobi's method is more accurate than QR" (1992).
+
+#include "SingularValueDecomposition.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace RixMatrix {
+
+    namespace {
+        Dimension roundedUpToEven(const Dimension value) {
+            return value + value % 2;
+        }
+    }
+
+    template <class Value>
+    BasicSingularValueDecomposition<Value>::BasicSingularValueDecomposition(const Dimension rows, const Dimension columns, const SvdMode mode) :
+        _rows(rows),
+        _columns(columns),
+        _transposed(rows > columns ? columns : 0, rows > columns ? rows : 0),
+        _qr(rows == columns ? 0 : std::min(rows, columns), rows == columns ? 0 : std::max(rows, columns)),
+        _work(std::min(rows, columns), std::min(rows, columns)),
+        _rotations(std::min(rows, columns), std::min(rows, columns)),
+        _singularValues(std::min(rows, columns), 1),
+        _u(rows, mode == SvdMode::Full || rows <= columns ? rows : columns),
+        _v(columns, mode == SvdMode::Full || columns <= rows ? columns : rows),
+        _isRotated(roundedUpToEven(std::min(rows, columns)) / 2) {
+
+        // round robin: the first index stays, the others shift one place per round, so every pair meets once a sweep
+        const Dimension players = roundedUpToEven(std::min(rows, columns));
+        std::vector<Dimension> positions(players);
+        for (Dimension index = 0; index < players; index++) positions[index] = index;
+        for (Dimension round = 0; round + 1 < players; round++) {
+            for (Dimension pair = 0; pair < players / 2; pair++) {
+                _schedule.push_back(std::min(positions[pair], positions[players - 1 - pair]));
+                _schedule.push_back(std::max(positions[pair], positions[players - 1 - pair]));
+            }
+            std::rotate(positions.begin() + 1, positions.end() - 1, positions.end());
+        }
+    }
+
+    template <class Value>
+    BasicSingularValueDecomposition<Value>::BasicSingularValueDecomposition(const BasicMatrix<Value>& matrix, const SvdMode mode) :
+        BasicSingularValueDecomposition(matrix.rowCount(), matrix.columnCount(), mode) {
+        decompose(matrix);
+    }
+
+    template <class Value>
+    Dimension BasicSingularValueDecomposition<Value>::columnCount() const {
+        return _columns;
+    }
+
+    /// @brief decompose another matrix of the same size, reusing the workspace.
+    /// Only rank deficient matrices and the full mode allocate matrices, to complete the singular vectors to an orthonormal basis.
+    template <class Value>
+    bool BasicSingularValueDecomposition<Value>::decompose(const BasicMatrix<Value>& matrix) {
+        assert(matrix.rowCount() == _rows && matrix.columnCount() == _columns);
+        const bool isTall = _rows > _columns;
+        const bool isSquare = _rows == _columns;
+        const Dimension count = _work.rowCount();
+        if (isSquare) {
+            _work = matrix;
+        }
+        else {
+            // decompose the rows of A, or the columns if it is tall: rows = C Q^T with C k x k
+            if (isTall) {
+                const Value* source = matrix.data();
+                Value* target = _transposed.data();
+                for (Dimension row = 0; row < _rows; row++) {
+                    for (Dimension column = 0; column < _columns; column++) {
+                        target[column * _rows + row] = source[row * _columns + column];
+                    }
+                }
+                _qr.decompose(_transposed);
+            }
+            else {
+                _qr.decompose(matrix);
+            }
+            _qr.getCoordinates(_work);
+        }
+        Value* rotations = _rotations.data();
+        for (Dimension cell = 0; cell < count * count; cell++) {
+            rotations[cell] = cell % (count + 1) == 0 ? Value(1) : Value(0);
+        }
+
+        _hasConverged = orthogonalize();
+        sort();
+
+        // the rows of the work matrix are now the singular vectors of the long side, scaled by the singular values
+        // (in the basis Q if A isn't square). The rotations are the singular vectors of the short side.
+        BasicMatrix<Value>& longVectors = isTall ? _u : _v;
+        BasicMatrix<Value>& shortVectors = isTall ? _v : _u;
+        const Dimension rank = getRank();
+        const Dimension length = longVectors.rowCount();
+        const Dimension longColumns = longVectors.columnCount();
+        Value* target = longVectors.data();
+        for (Dimension row = 0; row < length; row++) {
+            for (Dimension column = 0; column < longColumns; column++) {
+                target[row * longColumns + column] = row < count && column < rank ? _work(column, row) / _singularValues[column] : Value(0);
+            }
+        }
+        if (!isSquare) {
+            _qr.applyQ(longVectors);
+        }
+        completeBasis(longVectors, rank);
+
+        Value* shortTarget = shortVectors.data();
+        for (Dimension row = 0; row < count; row++) {
+            for (Dimension column = 0; column < count; column++) {
+                shortTarget[row * count + column] = rotations[column * count + row];
+            }
+        }
+        return _hasConverged;
+    }
+
+    /// @brief fill the columns from independentColumns on with an orthonormal basis of the complement of the ones before,
+    /// i.e. the null space of their transpose
+    template <class Value>
+    void BasicSingularValueDecomposition<Value>::completeBasis(BasicMatrix<Value>& vectors, const Dimension independentColumns) const {
+        const Dimension length = vectors.rowCount();
+        const Dimension columns = vectors.columnCount();
+        if (independentColumns == columns) return;
+        if (independentColumns == 0) {
+            for (Dimension column = 0; column < columns; column++) {
+                vectors(column, column) = 1;
+            }
+            return;
+        }
+        BasicMatrix<Value> independent(independentColumns, length);
+        for (Dimension row = 0; row < length; row++) {
+            for (Dimension column = 0; column < independentColumns; column++) {
+                independent(column, row) = vectors(row, column);
+            }
+        }
+        const BasicMatrix<Value> complement = BasicQrDecomposition<Value>(independent).getNullSpace();
+        assert(complement.columnCount() >= columns - independentColumns);
+        for (Dimension row = 0; row < length; row++) {
+            for (Dimension column = independentColumns; column < columns; column++) {
+                vectors(row, column) = complement(row, column - independentColumns);
+            }
+        }
+    }
+
+    template <class Value>
+    Dimension BasicSingularValueDecomposition<Value>::getRank(const Value relativeTolerance) const {
+        const Value limit = threshold(relativeTolerance);
+        Dimension rank = 0;
+        while (rank < _singularValues.rowCount() && _singularValues[rank] > limit) rank++;
+        return rank;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicSingularValueDecomposition<Value>::getSingularValues() const {
+        return _singularValues;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicSingularValueDecomposition<Value>::getU() const {
+        return _u;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicSingularValueDecomposition<Value>::getV() const {
+        return _v;
+    }
+
+    template <class Value>
+    bool BasicSingularValueDecomposition<Value>::hasConverged() const {
+        return _hasConverged;
+    }
+
+    /// @brief Sweep over all pairs of rows until a sweep doesn't need to rotate any pair.
+    /// @return false if that didn't happen within MaxSweeps sweeps
+    template <class Value>
+    bool BasicSingularValueDecomposition<Value>::orthogonalize() {
+        const Dimension players = roundedUpToEven(_work.rowCount());
+        if (players < 2) return true;
+        for (unsigned int sweep = 0; sweep < MaxSweeps; sweep++) {
+            bool isRotated = false;
+            for (Dimension round = 0; round + 1 < players; round++) {
+                // not short circuited: all rounds of the sweep must run
+                isRotated = rotateRound(round) || isRotated;
+            }
+            if (!isRotated) return true;
+        }
+        return false;
+    }
+
+    template <class Value>
+    BasicMatrix<Value> BasicSingularValueDecomposition<Value>::pseudoInverse(const Value relativeTolerance) const {
+        const Dimension rank = getRank(relativeTolerance);
+        BasicMatrix<Value> result(_columns, _rows);
+        if (rank == 0) return result;
+        BasicMatrix<Value> scaledV(_columns, rank);
+        for (Dimension row = 0; row < _columns; row++) {
+            for (Dimension column = 0; column < rank; column++) {
+                scaledV(row, column) = _v(row, column) / _singularValues[column];
+            }
+        }
+        BasicMatrix<Value> transposedU(rank, _rows);
+        for (Dimension row = 0; row < _rows; row++) {
+            for (Dimension column = 0; column < rank; column++) {
+                transposedU(column, row) = _u(row, column);
+            }
+        }
+        BasicMatrix<Value>::multiply(scaledV, transposedU, result);
+        return result;
+    }
+
+    /// @brief apply a Jacobi rotation to rows first and second (and the same rotation to the accumulated rotations)
+    /// that makes them orthogonal.
+    /// @return false if they were orthogonal already
+    template <class Value>
+    bool BasicSingularValueDecomposition<Value>::rotate(const Dimension first, const Dimension second) {
+        const Dimension length = _work.columnCount();
+        Value* x = _work.data() + first * length;
+        Value* y = _work.data() + second * length;
+        Value alpha = 0;
+        Value beta = 0;
+        Value gamma = 0;
+        for (Dimension index = 0; index < length; index++) {
+            alpha += x[index] * x[index];
+            beta += y[index] * y[index];
+            gamma += x[index] * y[index];
+        }
+        // rounding errors in the dot product grow with the length, so a tighter limit might never be reached
+        const Value tolerance = static_cast<Value>(length) * std::numeric_limits<Value>::epsilon();
+        if (gamma == 0 || std::fabs(gamma) <= tolerance * std::sqrt(alpha * beta)) return false;
+
+        const Value zeta = (beta - alpha) / (2 * gamma);
+        const Value tangent = (zeta >= 0 ? Value(1) : Value(-1)) / (std::fabs(zeta) + std::sqrt(1 + zeta * zeta));
+        const Value cosine = 1 / std::sqrt(1 + tangent * tangent);
+        const Value sine = cosine * tangent;
+        for (Dimension index = 0; index < length; index++) {
+            const Value xValue = x[index];
+            x[index] = cosine * xValue - sine * y[index];
+            y[index] = sine * xValue + cosine * y[index];
+        }
+
+        const Dimension count = _rotations.columnCount();
+        Value* p = _rotations.data() + first * count;
+        Value* q = _rotations.data() + second * count;
+        for (Dimension index = 0; index < count; index++) {
+            const Value pValue = p[index];
+            p[index] = cosine * pValue - sine * q[index];
+            q[index] = sine * pValue + cosine * q[index];
+        }
+        return true;
+    }
+
+    /// @brief rotate all pairs of a round. They are disjoint, so large rounds run in parallel.
+    /// @return whether any pair was rotated
+    template <class Value>
+    bool BasicSingularValueDecomposition<Value>::rotateRound(const Dimension round) {
+        const Dimension count = _work.rowCount();
+        const auto pairCount = static_cast<Dimension>(_isRotated.size());
+        const Dimension* pairs = _schedule.data() + round * 2 * pairCount;
+        auto rotatePairs = [this, pairs, count](const Dimension begin, const Dimension end) {
+            for (Dimension pair = begin; pair < end; pair++) {
+                const Dimension first = pairs[2 * pair];
+                const Dimension second = pairs[2 * pair + 1];
+                // the padding index of an odd count has no row
+                _isRotated[pair] = second < count && rotate(first, second);
+            }
+        };
+
+        ThreadPool& pool = ThreadPool::instance();
+        const unsigned long work = static_cast<unsigned long>(pairCount) * (_work.columnCount() + count);
+        if (pairCount > 1 && work >= ParallelRoundLimit && pool.isParallel()) {
+            pool.parallelFor(pairCount, 1, rotatePairs);
+        }
+        else {
+            rotatePairs(0, pairCount);
+        }
+        return std::find(_isRotated.begin(), _isRotated.end(), static_cast<char>(true)) != _isRotated.end();
+    }
+
+    template <class Value>
+    Dimension BasicSingularValueDecomposition<Value>::rowCount() const {
+        return _rows;
+    }
+
+    /// @brief X = V S^+ U^T B, without forming the pseudo-inverse: U^T B is only rank x columns
+    template <class Value>
+    BasicMatrix<Value> BasicSingularValueDecomposition<Value>::solve(const BasicMatrix<Value>& rightHandSides, const Value relativeTolerance) const {
+        assert(rightHandSides.rowCount() == _rows);
+        const Dimension rank = getRank(relativeTolerance);
+        const Dimension columns = rightHandSides.columnCount();
+        BasicMatrix<Value> projected(rank, columns);
+        Value* target = projected.data();
+        for (Dimension row = 0; row < _rows; row++) {
+            const Value* source = rightHandSides.data() + row * columns;
+            for (Dimension vector = 0; vector < rank; vector++) {
+                const Value factor = _u(row, vector);
+                for (Dimension column = 0; column < columns; column++) {
+                    target[vector * columns + column] += factor * source[column];
+                }
+            }
+        }
+        for (Dimension vector = 0; vector < rank; vector++) {
+            const Value factor = 1 / _singularValues[vector];
+            for (Dimension column = 0; column < columns; column++) {
+                target[vector * columns + column] *= factor;
+            }
+        }
+
+        BasicMatrix<Value> result(_columns, columns);
+        for (Dimension row = 0; row < _columns; row++) {
+            Value* resultRow = result.data() + row * columns;
+            for (Dimension vector = 0; vector < rank; vector++) {
+                const Value factor = _v(row, vector);
+                for (Dimension column = 0; column < columns; column++) {
+                    resultRow[column] += factor * target[vector * columns + column];
+                }
+            }
+        }
+        return result;
+    }
+
+    /// @brief the singular values are the norms of the rows. Sort them descending, along with the rows.
+    template <class Value>
+    void BasicSingularValueDecomposition<Value>::sort() {
+        const Dimension count = _work.rowCount();
+        const Dimension length = _work.columnCount();
+        Value* work = _work.data();
+        Value* rotations = _rotations.data();
+        for (Dimension row = 0; row < count; row++) {
+            Value sum = 0;
+            for (Dimension index = 0; index < length; index++) {
+                sum += work[row * length + index] * work[row * length + index];
+            }
+            _singularValues[row] = std::sqrt(sum);
+        }
+        for (Dimension row = 0; row < count; row++) {
+            Dimension largest = row;
+            for (Dimension other = row + 1; other < count; other++) {
+                if (_singularValues[other] > _singularValues[largest]) largest = other;
+            }
+            if (largest == row) continue;
+            std::swap(_singularValues[row], _singularValues[largest]);
+            std::swap_ranges(work + row * length, work + (row + 1) * length, work + largest * length);
+            std::swap_ranges(rotations + row * count, rotations + (row + 1) * count, rotations + largest * count);
+        }
+    }
+
+    template <class Value>
+    Value BasicSingularValueDecomposition<Value>::threshold(const Value relativeTolerance) const {
+        if (_singularValues.rowCount() == 0) return 0;
+        const Value tolerance = relativeTolerance > 0
+            ? relativeTolerance
+            : static_cast<Value>(std::max(_rows, _columns)) * std::numeric_limits<Value>::epsilon();
+        return tolerance * _singularValues[0];
+    }
+
+    template class BasicSingularValueDecomposition<float>;
+    template class BasicSingularValueDecomposition<double>;
+}
@@ -0,0 +1,101 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SINGULARVALUEDECOMPOSITION_H
+#define SINGULARVALUEDECOMPOSITION_H
+
+#include <vector>
+#include "Matrix.h"
+#include "QrDecomposition.h"
+
+namespace RixMatrix {
+
+    // Thin: U is m x k and V is n x k, with k = min(m, n). Full: U is m x m and V is n x n.
+    enum class SvdMode { Thin, Full };
+
+    /// Singular value decomposition A = U S V^T of any m x n matrix, via one-sided Jacobi (Hestenes) rotations.
+    /// Jacobi is slower than bidiagonalization for large square matrices, but simple and accurate, also for the small
+    /// singular values. A rectangular matrix is first reduced to a k x k triangle (k = min(m, n)) by a pivoted QR
+    /// decomposition, so tall systems with few columns only need the rotations on that small triangle.
+    /// The rotations work on rows, so they run over contiguous memory, and each sweep rotates disjoint pairs of rows
+    /// in rounds that can run on the ThreadPool.
+    /// Singular values are sorted in descending order; singular vector i is column i of getU and getV.
+    /// Like LuDecomposition, the workspace can be reused: construct with a size and call decompose.
+    template <class Value>
+    class BasicSingularValueDecomposition {
+    public:
+        BasicSingularValueDecomposition(Dimension rows, Dimension columns, SvdMode mode = SvdMode::Thin);
+        explicit BasicSingularValueDecomposition(const BasicMatrix<Value>& matrix, SvdMode mode = SvdMode::Thin);
+
+        Dimension columnCount() const;
+
+        // returns false if the rotations didn't converge within MaxSweeps sweeps
+        bool decompose(const BasicMatrix<Value>& matrix);
+
+        // the number of singular values above relativeTolerance times the largest one.
+        // 0 means max(m, n) times the machine epsilon, as in QrDecomposition.
+        Dimension getRank(Value relativeTolerance = 0) const;
+
+        // column vector, descending
+        const BasicMatrix<Value>& getSingularValues() const;
+        const BasicMatrix<Value>& getU() const;
+        const BasicMatrix<Value>& getV() const;
+        bool hasConverged() const;
+
+        // Moore-Penrose pseudo-inverse V S^+ U^T (n x m), ignoring the singular values that getRank ignores
+        BasicMatrix<Value> pseudoInverse(Value relativeTolerance = 0) const;
+        Dimension rowCount() const;
+
+        // minimum norm least squares solution X of A X = B, for all columns of B at once
+        BasicMatrix<Value> solve(const BasicMatrix<Value>& rightHandSides, Value relativeTolerance = 0) const;
+
+        static constexpr unsigned int MaxSweeps = 40;
+        // rotation rounds with fewer elements (pairs x row length) than this run on the calling thread
+        static constexpr unsigned long ParallelRoundLimit = 16 * 1024;
+
+    private:
+        void completeBasis(BasicMatrix<Value>& vectors, Dimension independentColumns) const;
+        bool orthogonalize();
+        bool rotate(Dimension first, Dimension second);
+        bool rotateRound(Dimension round);
+        void sort();
+        Value threshold(Value relativeTolerance) const;
+
+        Dimension _rows;
+        Dimension _columns;
+        // for tall matrices: A^T, the rows to decompose with _qr
+        BasicMatrix<Value> _transposed;
+        // for rectangular matrices: the QR decomposition of the rows of A (wide) or A^T (tall)
+        BasicQrDecomposition<Value> _qr;
+        // k x k: the rows that get orthogonalized. A itself if it is square, else their coordinates in Q.
+        BasicMatrix<Value> _work;
+        // k x k: the accumulated rotations
+        BasicMatrix<Value> _rotations;
+        BasicMatrix<Value> _singularValues;
+        BasicMatrix<Value> _u;
+        BasicMatrix<Value> _v;
+        // the disjoint pairs of each round, for all rounds of a sweep (round robin). Pairs with index k are padding.
+        std::vector<Dimension> _schedule;
+        // per pair of a round, whether it was rotated. Written by the threads, so no shared flag is needed.
+        std::vector<char> _isRotated;
+        bool _hasConverged = false;
+    };
+
+    template <class Value>
+    constexpr unsigned int BasicSingularValueDecomposition<Value>::MaxSweeps;
+
+    template <class Value>
+    constexpr unsigned long BasicSingularValueDecomposition<Value>::ParallelRoundLimit;
+
+    using SingularValueDecomposition = BasicSingularValueDecomposition<double>;
+    using FloatSingularValueDecomposition = BasicSingularValueDecomposition<float>;
+}
+#endif
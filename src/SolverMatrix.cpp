@@ -22,38 +22,86 @@
 #endif
 
 #include <iostream>
+#include <numeric>
+#include <utility>
 #include "SolverMatrix.h"
+#include "FixedMatrix.h"
+#include "GeneralEigenDecomposition.h"
+#include "SymmetricEigenDecomposition.h"
 
 namespace RixMatrix {
 
-    SolverMatrix::SolverMatrix(const std::initializer_list<std::initializer_list<double>> list) : Matrix(list) {}
+    namespace {
+        // The eigenvalues are calculated in double precision, also for float matrices:
+        // the cubic formula and the iterative solvers lose too much in float.
+        const Matrix& inDoublePrecision(const Matrix& matrix) {
+            return matrix;
+        }
+
+        Matrix inDoublePrecision(const FloatMatrix& matrix) {
+            return Matrix(matrix);
+        }
+
+        template <class Value>
+        BasicMatrix<Value> fromDoublePrecision(Matrix matrix) {
+            return BasicMatrix<Value>(matrix);
+        }
+
+        template <>
+        Matrix fromDoublePrecision<double>(Matrix matrix) {
+            return matrix;
+        }
+    }
+
+    template <class Value>
+    BasicSolverMatrix<Value>::BasicSolverMatrix(const std::initializer_list<std::initializer_list<Value>> list) : Base(list) {}
+
+    template <class Value>
+    BasicSolverMatrix<Value>::BasicSolverMatrix(const Base& other) : Base(other) {}
 
-    SolverMatrix::SolverMatrix(const Matrix& other) : Matrix(other) {}
+    template <class Value>
+    BasicSolverMatrix<Value>::BasicSolverMatrix(Base&& other) : Base(std::move(other)) {}
 
-    Matrix SolverMatrix::getEigenvalues() const {
-        assert(isSquare() && rowCount() < 4);
+    template <class Value>
+    BasicMatrix<Value> BasicSolverMatrix<Value>::getEigenvalues() const {
+        assert(isSquare());
+        if (rowCount() >= 4) {
+            // no closed forms here, so we need an iterative method
+            if (isSymmetric()) {
+                const SymmetricEigenDecomposition decomposition(inDoublePrecision(*this));
+                assert(decomposition.hasConverged());
+                return fromDoublePrecision<Value>(decomposition.getEigenvalues());
+            }
+            // complex eigenvalues are left out, as with the smaller matrices. Use GeneralEigenDecomposition to get those.
+            const GeneralEigenDecomposition decomposition(inDoublePrecision(*this));
+            assert(decomposition.hasConverged());
+            return fromDoublePrecision<Value>(decomposition.getRealEigenvalues());
+        }
         if (rowCount() == 1) {
-            return Matrix({ {me(0, 0)} });
+            return Base({ {me(0, 0)} });
         }
         if (rowCount() == 2) {
-            const double determinant = getDeterminant();
-            const double trace = getTrace();
+            const FixedMatrix<2, 2> matrix(inDoublePrecision(*this));
+            const double determinant = matrix.getDeterminant();
+            const double trace = matrix.getTrace();
             const double discriminant = trace * trace - 4 * determinant;
             if (discriminant < 0) {
                 // no real eigenvalues
-                return Matrix(0, 0);
+                return Base(0, 0);
             }
             const auto rootDiscriminant = sqrt(discriminant);
-            return Matrix{
+            return fromDoublePrecision<Value>(Matrix{
                 {(trace + rootDiscriminant) / 2},
                 {(trace - rootDiscriminant) / 2}
-            };
+            });
         }
         // 3x3 matrix
         // Characteristic polynomial, see https://mathworld.wolfram.com/CharacteristicPolynomial.html, but swapping signs
-        const double trace = getTrace();
-        const double traceSquared = squared().getTrace();
-        const double determinant = getDeterminant();
+        // stack based, so no allocations for the square
+        const FixedMatrix<3, 3> matrix(inDoublePrecision(*this));
+        const double trace = matrix.getTrace();
+        const double traceSquared = (matrix * matrix).getTrace();
+        const double determinant = matrix.getDeterminant();
         const double a2 = -trace;
         const double a1 = (trace * trace - traceSquared) / 2.0;
         // another way for calculating a0 is (-trace * trace * trace - 2 * cubic().getTrace() + 3 * trace * traceSquared) / 6.0
@@ -67,74 +115,112 @@ namespace RixMatrix {
 
         const double discriminant = q * q * q + r * r;
 
-        if (discriminant < -Epsilon) {
+        if (discriminant < -Matrix::Epsilon) {
             // Three distinct real roots (or >1 coinciding roots if discriminant = 0)
             q = -q;
             const double theta = acos(r / sqrt(q * q * q));
             const double qFactor = 2 * sqrt(q);
-            return Matrix({
+            return fromDoublePrecision<Value>(Matrix({
                 { qFactor * cos(theta / 3.0) - a2 / 3.0 },
                 { qFactor * cos((theta + 2 * M_PI) / 3.0) - a2 / 3.0 },
                 { qFactor * cos((theta + 4 * M_PI) / 3.0) - a2 / 3.0 }
-                });
+                }));
         }
-        if (discriminant > Epsilon) {
+        if (discriminant > Matrix::Epsilon) {
             // One real root and two complex conjugate roots. Return just the real one.
             const double s = cbrt(r + sqrt(discriminant));
             const double t = cbrt(r - sqrt(discriminant));
-            return Matrix({ {-a2 / 3.0 + s + t} });
+            return fromDoublePrecision<Value>(Matrix({ {-a2 / 3.0 + s + t} }));
         }
         // discriminant is 0
         const double alpha = cbrt(r);
         const double root1 = -a2 / 3 + 2 * alpha;
         const double root2 = -alpha - a2 / 3;
-        return fabs(root1 - root2) < Epsilon ? Matrix({ { root1 } }) : Matrix({ {root1}, {root2} });
+        return fromDoublePrecision<Value>(fabs(root1 - root2) < Matrix::Epsilon ? Matrix({ { root1 } }) : Matrix({ {root1}, {root2} }));
     }
 
 
     /// @brief get the null space of the matrix. This should return at least 1 vector for the eigenvalue matrix (A - lambda * I).
     /// @note The matrix is already expected to be in row echelon form, so we can just look at the free variables.
     /// @return the vectors in the null space
-    Matrix SolverMatrix::getNullSpace() const {
+    template <class Value>
+    BasicMatrix<Value> BasicSolverMatrix<Value>::getNullSpace() const {
+        std::vector<Dimension> noPermutation(columnCount());
+        std::iota(noPermutation.begin(), noPermutation.end(), 0);
+        return getNullSpace(noPermutation);
+    }
+
+    /// @brief get the null space of the original matrix, using the permutation that toReducedRowEchelonFormWithPivot returned.
+    /// Row i of the null space of the RREF becomes row permutation[i], so this costs O(n*k) for k null space vectors.
+    /// @note works for any shape: the null space has a row per column (variable) of the matrix.
+    /// @return the vectors in the null space
+    template <class Value>
+    BasicMatrix<Value> BasicSolverMatrix<Value>::getNullSpace(const std::vector<Dimension>& permutation) const {
+        assert(permutation.size() == columnCount());
         const auto freeVariables = getFreeVariables();
-        if (freeVariables.empty()) {
-            // no free variables, so no null space. 
-            // We need the rows to have dimension 3 to be able to multiply with the permutation matrix
-            return Matrix(3, 0);
-        }
-        Matrix result(rowCount(), static_cast<Dimension>(freeVariables.size()));
-        auto resultColumn = 0;
-        for (const auto freeVariable : freeVariables) {
-            result.setColumn(resultColumn, getColumn(freeVariable) * -1);
-            result(freeVariable, resultColumn) = 1;
-            for (const auto otherFreeVariable : freeVariables) {
-                if (otherFreeVariable != freeVariable) {
-                    result(otherFreeVariable, resultColumn) = 0;
-                }
+        const auto nullity = static_cast<Dimension>(freeVariables.size());
+        Base result(columnCount(), nullity);
+        if (nullity == 0) return result;
+
+        // the other columns are pivot columns, with their pivots on consecutive rows
+        auto nextFreeVariable = freeVariables.begin();
+        Dimension pivotRow = 0;
+        for (Dimension column = 0; column < columnCount(); column++) {
+            if (nextFreeVariable != freeVariables.end() && *nextFreeVariable == column) {
+                nextFreeVariable++;
+                continue;
+            }
+            for (Dimension resultColumn = 0; resultColumn < nullity; resultColumn++) {
+                result(permutation[column], resultColumn) = -me(pivotRow, freeVariables[resultColumn]);
             }
-            resultColumn++;
+            pivotRow++;
+        }
+        for (Dimension resultColumn = 0; resultColumn < nullity; resultColumn++) {
+            result(permutation[freeVariables[resultColumn]], resultColumn) = 1;
         }
         return result;
     }
 
 
-    Matrix SolverMatrix::getEigenvectorFor(const double lambda) const {
+    template <class Value>
+    BasicMatrix<Value> BasicSolverMatrix<Value>::getEigenvectorFor(const Value lambda) const {
         assert(isSquare());
 
-        auto beta = SolverMatrix(*this - getIdentity(rowCount()) * lambda);
+        // A - lambda * I, without creating the identity matrix
+        auto beta = BasicSolverMatrix(*this);
+        for (Dimension diagonal = 0; diagonal < rowCount(); diagonal++) {
+            beta(diagonal, diagonal) -= lambda;
+        }
         const auto permutation = beta.toReducedRowEchelonFormWithPivot();
-        return permutation * beta.getNullSpace();
+        return beta.getNullSpace(permutation);
     }
 
-    Matrix SolverMatrix::getEigenvectors() const {
+    template <class Value>
+    BasicMatrix<Value> BasicSolverMatrix<Value>::getEigenvectors() const {
+        if (rowCount() >= 4 && isSymmetric()) {
+            // all eigenvectors in one go, instead of a null space per eigenvalue
+            const SymmetricEigenDecomposition decomposition(inDoublePrecision(*this));
+            assert(decomposition.hasConverged());
+            return fromDoublePrecision<Value>(decomposition.getEigenvectors());
+        }
         const auto eigenvalues = getEigenvalues();
-        Matrix result(rowCount(), rowCount());
+        Base result(rowCount(), rowCount());
         Dimension currentRow = 0;
         for (Dimension eigenValueIndex = 0; eigenValueIndex < eigenvalues.rowCount(); eigenValueIndex++) {
             auto eigenvectors = getEigenvectorFor(eigenvalues(eigenValueIndex, 0));
             for (Dimension vectorIndex = 0; vectorIndex < eigenvectors.columnCount(); vectorIndex++) {
-                auto eigenvector = Matrix(eigenvectors.getColumn(vectorIndex)).normalized();
-                result.setColumn(currentRow, eigenvector);
+                // normalize straight into the result column, as Matrix::normalized does
+                const auto eigenvector = eigenvectors.column(vectorIndex);
+                Value norm = 0;
+                for (Dimension row = 0; row < eigenvector.rowCount(); row++) {
+                    norm += eigenvector[row] * eigenvector[row];
+                }
+                norm = sqrt(norm);
+                if (norm < Epsilon) {
+                    result.column(currentRow) = eigenvector;
+                } else {
+                    result.column(currentRow) = eigenvector / (eigenvector[0] < 0 ? -norm : norm);
+                }
                 currentRow++;
             }
         }
@@ -143,90 +229,131 @@ namespace RixMatrix {
     }
 
     /// @brief Finds the free variables in the matrix by searching for non-pivot columns.
-    /// This must already be a matrix in row echelon form
+    /// This must already be a matrix in row echelon form, of any shape.
     /// @return a vector of the free variable columns
-    std::vector<Dimension> SolverMatrix::getFreeVariables() const {
+    template <class Value>
+    std::vector<Dimension> BasicSolverMatrix<Value>::getFreeVariables() const {
         std::vector<Dimension> result;
-        Dimension row = 0;
-        Dimension column = 0;
-        Dimension resultsFound = 0;
-        while (resultsFound < rowCount()) {
-            if (abs(me(row, column)) <= EigenEpsilon) {
-                result.push_back(column);
-                resultsFound++;
+        Dimension pivotRow = 0;
+        for (Dimension column = 0; column < columnCount(); column++) {
+            if (pivotRow < rowCount() && fabs(me(pivotRow, column)) > EigenEpsilon) {
+                pivotRow++;
             }
             else {
-                row++;
-                resultsFound++;
-            }
-            column++;
-            if (column >= columnCount()) {
-                column = 0;
-                row++;
+                result.push_back(column);
             }
         }
         return result;
     }
 
-    void SolverMatrix::eliminatePivotValueInRow(const Dimension pivot, const Dimension row) {
-        assert(row != pivot);
-        if (me(pivot, pivot) < EigenEpsilon) return;
-        const double valueToEliminate = me(row, pivot);
-        if (abs(valueToEliminate) < EigenEpsilon) return;
-        const double compensationFactor = -valueToEliminate / me(pivot, pivot);
+    template <class Value>
+    void BasicSolverMatrix<Value>::eliminatePivotValueInRow(const Dimension pivotRow, const Dimension pivotColumn, const Dimension row) {
+        assert(row != pivotRow);
+        if (me(pivotRow, pivotColumn) < EigenEpsilon) return;
+        const Value valueToEliminate = me(row, pivotColumn);
+        if (fabs(valueToEliminate) < EigenEpsilon) return;
+        const Value compensationFactor = -valueToEliminate / me(pivotRow, pivotColumn);
         for (Dimension column = 0; column < columnCount(); column++) {
-            (*this)(row, column) += compensationFactor * me(pivot, column);
+            (*this)(row, column) += compensationFactor * me(pivotRow, column);
         }
     }
 
-    void SolverMatrix::multiplyRow(const Dimension row, const double factor) {
+    template <class Value>
+    void BasicSolverMatrix<Value>::multiplyRow(const Dimension row, const Value factor) {
         for (Dimension column = 0; column < columnCount(); column++) {
             (*this)(row, column) *= factor;
         }
     }
 
-    void SolverMatrix::findMaxPivot(const Dimension& pivot, Dimension& maxRow, Dimension& maxColumn) const {
+    /// @brief find the largest element in the part of the matrix that still needs to be eliminated.
+    /// @return in maxRow and maxColumn: its position in rowOrder and columnOrder
+    template <class Value>
+    void BasicSolverMatrix<Value>::findMaxPivot(
+        const Dimension& pivot, 
+        const std::vector<Dimension>& rowOrder, 
+        const std::vector<Dimension>& columnOrder, 
+        Dimension& maxRow, 
+        Dimension& maxColumn) const {
         maxRow = pivot;
         maxColumn = pivot;
-        double maxValue = 0;
+        Value maxValue = 0;
 
         for (Dimension searchRow = pivot; searchRow < rowCount(); searchRow++) {
             for (Dimension searchColumn = pivot; searchColumn < columnCount(); searchColumn++) {
-                if (abs(me(searchRow, searchColumn)) > maxValue) {
+                const Value value = fabs(me(rowOrder[searchRow], columnOrder[searchColumn]));
+                if (value > maxValue) {
                     maxRow = searchRow;
                     maxColumn = searchColumn;
-                    maxValue = abs(me(searchRow, searchColumn));
+                    maxValue = value;
                 }
             }
         }
     }
 
-    Matrix SolverMatrix::toReducedRowEchelonFormWithPivot() {
-        auto permutation = getIdentity(columnCount());
+    /// @brief move the rows and columns to the order of the index vectors, i.e. row i becomes the old row rowOrder[i].
+    /// Rows are swapped along their permutation cycles; columns are gathered per row via a single row buffer.
+    template <class Value>
+    void BasicSolverMatrix<Value>::reorder(const std::vector<Dimension>& rowOrder, const std::vector<Dimension>& columnOrder) {
+        std::vector<bool> isDone(rowCount(), false);
+        for (Dimension start = 0; start < rowCount(); start++) {
+            if (isDone[start]) continue;
+            Dimension row = start;
+            isDone[row] = true;
+            while (rowOrder[row] != start) {
+                swapRows(row, rowOrder[row]);
+                row = rowOrder[row];
+                isDone[row] = true;
+            }
+        }
+
+        Dimension firstMoved = 0;
+        while (firstMoved < columnCount() && columnOrder[firstMoved] == firstMoved) firstMoved++;
+        if (firstMoved == columnCount()) return;
+
+        std::vector<Value> buffer(columnCount());
+        for (Dimension row = 0; row < rowCount(); row++) {
+            for (Dimension column = firstMoved; column < columnCount(); column++) {
+                buffer[column] = me(row, columnOrder[column]);
+            }
+            for (Dimension column = firstMoved; column < columnCount(); column++) {
+                (*this)(row, column) = buffer[column];
+            }
+        }
+    }
+
+    /// @brief Gauss-Jordan elimination with full pivoting. The pivots are chosen via row and column index vectors,
+    /// so no data moves during the elimination; the rows and columns are put in pivot order once at the end.
+    /// @return the column permutation: column i of the result was column result[i] of the original matrix
+    template <class Value>
+    std::vector<Dimension> BasicSolverMatrix<Value>::toReducedRowEchelonFormWithPivot() {
+        std::vector<Dimension> rowOrder(rowCount());
+        std::iota(rowOrder.begin(), rowOrder.end(), 0);
+        std::vector<Dimension> columnOrder(columnCount());
+        std::iota(columnOrder.begin(), columnOrder.end(), 0);
         const auto maxPivot = std::min(rowCount(), columnCount());
 
         for (Dimension pivot = 0; pivot < maxPivot; pivot++) {
             Dimension maxRow = pivot;
             Dimension maxColumn = pivot;
-            findMaxPivot(pivot, maxRow, maxColumn);
+            findMaxPivot(pivot, rowOrder, columnOrder, maxRow, maxColumn);
 
-            // swap rows and/or columns to bring pivot to (row, row)
-            // if we do a column swap, we also need to swap the permutation matrix
-            swapRows(pivot, maxRow);
-            swapColumns(pivot, maxColumn);
-            permutation.swapColumns(pivot, maxColumn);
+            // bring the pivot to (pivot, pivot) by swapping indices only
+            std::swap(rowOrder[pivot], rowOrder[maxRow]);
+            std::swap(columnOrder[pivot], columnOrder[maxColumn]);
+            const Dimension pivotRow = rowOrder[pivot];
+            const Dimension pivotColumn = columnOrder[pivot];
 
             // make pivot element equal to 1
 
-            const auto pivotValue = me(pivot, pivot);
-            if (abs(pivotValue) > EigenEpsilon) {
-                multiplyRow(pivot, 1.0 / pivotValue);
+            const auto pivotValue = me(pivotRow, pivotColumn);
+            if (fabs(pivotValue) > EigenEpsilon) {
+                multiplyRow(pivotRow, Value(1) / pivotValue);
             }
 
             // eliminate all other elements below the pivot
 
             for (Dimension subRow = pivot + 1; subRow < rowCount(); subRow++) {
-                eliminatePivotValueInRow(pivot, subRow);
+                eliminatePivotValueInRow(pivotRow, pivotColumn, rowOrder[subRow]);
             }
         }
 
@@ -235,15 +362,21 @@ namespace RixMatrix {
         // using int instead of Dimension as Dimension is never negative
 
         for (int pivot = maxPivot - 1; pivot >= 0; pivot--) {
-            if (abs(me(pivot, pivot)) > EigenEpsilon) {
-                multiplyRow(pivot, 1.0 / me(pivot, pivot));
+            const Dimension pivotRow = rowOrder[pivot];
+            const Dimension pivotColumn = columnOrder[pivot];
+            if (fabs(me(pivotRow, pivotColumn)) > EigenEpsilon) {
+                multiplyRow(pivotRow, Value(1) / me(pivotRow, pivotColumn));
             }
 
             // eliminate all entries above pivot
             for (int subRow = pivot - 1; subRow >= 0; subRow--) {
-                eliminatePivotValueInRow(pivot, subRow);
+                eliminatePivotValueInRow(pivotRow, pivotColumn, rowOrder[subRow]);
             }
         }
-        return permutation;
+        reorder(rowOrder, columnOrder);
+        return columnOrder;
     }
+
+    template class BasicSolverMatrix<float>;
+    template class BasicSolverMatrix<double>;
 }
\ No newline at end of file
@@ -7,26 +7,52 @@
 namespace RixMatrix {
 	using Dimension = unsigned int;
 
-	/// Class for more complex matrix manipulations
-	class SolverMatrix : public Matrix {
+	/// Class for more complex matrix manipulations, on float or double elements.
+	/// Use the SolverMatrix and FloatSolverMatrix aliases. Eigenvalues are calculated in double precision for both.
+	template <class Value>
+	class BasicSolverMatrix : public BasicMatrix<Value> {
 	public:
-		explicit SolverMatrix(std::initializer_list<std::initializer_list<double>> list);
-		explicit SolverMatrix(const Matrix& other);
-		Matrix getEigenvalues() const;
-		Matrix getEigenvectorFor(double lambda) const;
-		Matrix getEigenvectors() const;
+		using Base = BasicMatrix<Value>;
+		using Base::Epsilon;
+		using Base::column;
+		using Base::columnCount;
+		using Base::getIdentity;
+		using Base::isSquare;
+		using Base::isSymmetric;
+		using Base::me;
+		using Base::rowCount;
+		using Base::swapColumns;
+		using Base::swapRows;
+
+		explicit BasicSolverMatrix(std::initializer_list<std::initializer_list<Value>> list);
+		explicit BasicSolverMatrix(const Base& other);
+		// takes over the storage of a temporary, e.g. SolverMatrix(m - Matrix::getIdentity(n) * lambda)
+		explicit BasicSolverMatrix(Base&& other);
+		Base getEigenvalues() const;
+		Base getEigenvectorFor(Value lambda) const;
+		Base getEigenvectors() const;
 		std::vector<Dimension> getFreeVariables() const;
-		Matrix getNullSpace() const;
+		Base getNullSpace() const;
+		// the null space of the matrix before toReducedRowEchelonFormWithPivot, given the permutation it returned
+		Base getNullSpace(const std::vector<Dimension>& permutation) const;
 
-		// converts itself to RREF and returns the permutation matrix. 
-		Matrix toReducedRowEchelonFormWithPivot();
+		// converts itself to RREF and returns the column permutation: column i of the RREF was column permutation[i].
+		std::vector<Dimension> toReducedRowEchelonFormWithPivot();
 
-		static constexpr double EigenEpsilon = 1e-6;
+		static constexpr Value EigenEpsilon = Precision<Value>::EigenEpsilon;
 
 	protected:
-		void eliminatePivotValueInRow(Dimension pivot, Dimension row);
-		void findMaxPivot(const Dimension& pivot, Dimension& maxRow, Dimension& maxColumn) const;
-		void multiplyRow(Dimension row, double factor);
+		void eliminatePivotValueInRow(Dimension pivotRow, Dimension pivotColumn, Dimension row);
+		void findMaxPivot(const Dimension& pivot, const std::vector<Dimension>& rowOrder, const std::vector<Dimension>& columnOrder,
+			Dimension& maxRow, Dimension& maxColumn) const;
+		void multiplyRow(Dimension row, Value factor);
+		void reorder(const std::vector<Dimension>& rowOrder, const std::vector<Dimension>& columnOrder);
 	};
+
+	template <class Value>
+	constexpr Value BasicSolverMatrix<Value>::EigenEpsilon;
+
+	using SolverMatrix = BasicSolverMatrix<double>;
+	using FloatSolverMatrix = BasicSolverMatrix<float>;
 }
 #endif // MATRIX_H
@@ -0,0 +1,271 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+// Householder tridiagonalization and implicit QL, after tred2/tql2 (Bowdler, Martin, Reinsch and Wilkinson,
+// Handbook for Automatic Computation Vol. II) as used in the public domain JAMA library.
+
+#include "SymmetricEigenDecomposition.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace RixMatrix {
+
+    SymmetricEigenDecomposition::SymmetricEigenDecomposition(const Dimension size) :
+        _eigenvectors(size, size),
+        _eigenvalues(size, 1),
+        _offDiagonal(size) {}
+
+    SymmetricEigenDecomposition::SymmetricEigenDecomposition(const Matrix& matrix) :
+        SymmetricEigenDecomposition(matrix.rowCount()) {
+        decompose(matrix);
+    }
+
+    bool SymmetricEigenDecomposition::decompose(const Matrix& matrix) {
+        assert(matrix.isSquare() && matrix.rowCount() == size());
+        _eigenvectors = matrix;
+        tridiagonalize();
+        _hasConverged = diagonalize();
+        sort();
+        return _hasConverged;
+    }
+
+    const Matrix& SymmetricEigenDecomposition::getEigenvalues() const {
+        return _eigenvalues;
+    }
+
+    const Matrix& SymmetricEigenDecomposition::getEigenvectors() const {
+        return _eigenvectors;
+    }
+
+    bool SymmetricEigenDecomposition::hasConverged() const {
+        return _hasConverged;
+    }
+
+    Dimension SymmetricEigenDecomposition::size() const {
+        return _eigenvalues.rowCount();
+    }
+
+    /// @brief Householder reduction to tridiagonal form. Afterwards the eigenvector workspace contains the
+    /// accumulated transformations, the eigenvalue workspace the diagonal and _offDiagonal the subdiagonal.
+    void SymmetricEigenDecomposition::tridiagonalize() {
+        const Dimension n = size();
+        if (n == 0) return;
+        double* v = _eigenvectors.data();
+        double* d = _eigenvalues.data();
+        double* e = _offDiagonal.data();
+
+        for (Dimension j = 0; j < n; j++) {
+            d[j] = v[(n - 1) * n + j];
+        }
+
+        for (Dimension i = n - 1; i > 0; i--) {
+            double scale = 0;
+            double h = 0;
+            for (Dimension k = 0; k < i; k++) {
+                scale += fabs(d[k]);
+            }
+            if (scale == 0.0) {
+                // nothing to eliminate in this row
+                e[i] = d[i - 1];
+                for (Dimension j = 0; j < i; j++) {
+                    d[j] = v[(i - 1) * n + j];
+                    v[i * n + j] = 0;
+                    v[j * n + i] = 0;
+                }
+            }
+            else {
+                // generate the Householder vector
+                for (Dimension k = 0; k < i; k++) {
+                    d[k] /= scale;
+                    h += d[k] * d[k];
+                }
+                double f = d[i - 1];
+                double g = sqrt(h);
+                if (f > 0) g = -g;
+                e[i] = scale * g;
+                h -= f * g;
+                d[i - 1] = f - g;
+                for (Dimension j = 0; j < i; j++) {
+                    e[j] = 0;
+                }
+
+                // apply the similarity transformation to the remaining columns
+                for (Dimension j = 0; j < i; j++) {
+                    f = d[j];
+                    v[j * n + i] = f;
+                    g = e[j] + v[j * n + j] * f;
+                    for (Dimension k = j + 1; k < i; k++) {
+                        g += v[k * n + j] * d[k];
+                        e[k] += v[k * n + j] * f;
+                    }
+                    e[j] = g;
+                }
+                f = 0;
+                for (Dimension j = 0; j < i; j++) {
+                    e[j] /= h;
+                    f += e[j] * d[j];
+                }
+                const double hh = f / (h + h);
+                for (Dimension j = 0; j < i; j++) {
+                    e[j] -= hh * d[j];
+                }
+                for (Dimension j = 0; j < i; j++) {
+                    f = d[j];
+                    g = e[j];
+                    for (Dimension k = j; k < i; k++) {
+                        v[k * n + j] -= f * e[k] + g * d[k];
+                    }
+                    d[j] = v[(i - 1) * n + j];
+                    v[i * n + j] = 0;
+                }
+            }
+            d[i] = h;
+        }
+
+        // accumulate the transformations
+        for (Dimension i = 0; i + 1 < n; i++) {
+            v[(n - 1) * n + i] = v[i * n + i];
+            v[i * n + i] = 1;
+            const double h = d[i + 1];
+            if (h != 0.0) {
+                for (Dimension k = 0; k <= i; k++) {
+                    d[k] = v[k * n + i + 1] / h;
+                }
+                for (Dimension j = 0; j <= i; j++) {
+                    double g = 0;
+                    for (Dimension k = 0; k <= i; k++) {
+                        g += v[k * n + i + 1] * v[k * n + j];
+                    }
+                    for (Dimension k = 0; k <= i; k++) {
+                        v[k * n + j] -= g * d[k];
+                    }
+                }
+            }
+            for (Dimension k = 0; k <= i; k++) {
+                v[k * n + i + 1] = 0;
+            }
+        }
+        for (Dimension j = 0; j < n; j++) {
+            d[j] = v[(n - 1) * n + j];
+            v[(n - 1) * n + j] = 0;
+        }
+        v[(n - 1) * n + n - 1] = 1;
+        e[0] = 0;
+    }
+
+    /// @brief Implicit QL with Wilkinson shifts on the tridiagonal matrix, rotating the eigenvectors along.
+    /// @return false if an eigenvalue didn't converge within MaxIterationsPerEigenvalue iterations
+    bool SymmetricEigenDecomposition::diagonalize() {
+        const Dimension n = size();
+        if (n == 0) return true;
+        double* v = _eigenvectors.data();
+        double* d = _eigenvalues.data();
+        double* e = _offDiagonal.data();
+
+        for (Dimension i = 1; i < n; i++) {
+            e[i - 1] = e[i];
+        }
+        e[n - 1] = 0;
+
+        double shift = 0;
+        double norm = 0;
+        constexpr double eps = std::numeric_limits<double>::epsilon();
+        for (Dimension l = 0; l < n; l++) {
+            // find a small subdiagonal element to split the matrix at
+            norm = std::max(norm, fabs(d[l]) + fabs(e[l]));
+            Dimension m = l;
+            while (m < n - 1 && fabs(e[m]) > eps * norm) {
+                m++;
+            }
+
+            if (m > l) {
+                unsigned int iteration = 0;
+                do {
+                    if (++iteration > MaxIterationsPerEigenvalue) return false;
+
+                    // compute the implicit shift
+                    double g = d[l];
+                    double p = (d[l + 1] - g) / (2 * e[l]);
+                    double r = hypot(p, 1.0);
+                    if (p < 0) r = -r;
+                    d[l] = e[l] / (p + r);
+                    d[l + 1] = e[l] * (p + r);
+                    const double dl1 = d[l + 1];
+                    double h = g - d[l];
+                    for (Dimension i = l + 2; i < n; i++) {
+                        d[i] -= h;
+                    }
+                    shift += h;
+
+                    // QL sweep from m back to l
+                    p = d[m];
+                    double c = 1;
+                    double c2 = c;
+                    double c3 = c;
+                    const double el1 = e[l + 1];
+                    double s = 0;
+                    double s2 = 0;
+                    for (Dimension i = m; i-- > l;) {
+                        c3 = c2;
+                        c2 = c;
+                        s2 = s;
+                        g = c * e[i];
+                        h = c * p;
+                        r = hypot(p, e[i]);
+                        e[i + 1] = s * r;
+                        s = e[i] / r;
+                        c = p / r;
+                        p = c * d[i] - s * g;
+                        d[i + 1] = h + s * (c * g + s * d[i]);
+
+                        for (Dimension k = 0; k < n; k++) {
+                            double* rowK = v + k * n;
+                            h = rowK[i + 1];
+                            rowK[i + 1] = s * rowK[i] + c * h;
+                            rowK[i] = c * rowK[i] - s * h;
+                        }
+                    }
+                    p = -s * s2 * c3 * el1 * e[l] / dl1;
+                    e[l] = s * p;
+                    d[l] = c * p;
+                } while (fabs(e[l]) > eps * norm);
+            }
+            d[l] += shift;
+            e[l] = 0;
+        }
+        return true;
+    }
+
+    /// @brief sort the eigenvalues descending (with their eigenvectors), and fix the sign of the eigenvectors
+    void SymmetricEigenDecomposition::sort() {
+        const Dimension n = size();
+        double* v = _eigenvectors.data();
+        double* d = _eigenvalues.data();
+        for (Dimension i = 0; i < n; i++) {
+            Dimension largest = i;
+            for (Dimension j = i + 1; j < n; j++) {
+                if (d[j] > d[largest]) largest = j;
+            }
+            if (largest != i) {
+                std::swap(d[i], d[largest]);
+                _eigenvectors.swapColumns(i, largest);
+            }
+            if (v[i] < 0) {
+                for (Dimension k = 0; k < n; k++) {
+                    v[k * n + i] = -v[k * n + i];
+                }
+            }
+        }
+    }
+}
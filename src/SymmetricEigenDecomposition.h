@@ -0,0 +1,52 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SYMMETRICEIGENDECOMPOSITION_H
+#define SYMMETRICEIGENDECOMPOSITION_H
+
+#include <vector>
+#include "Matrix.h"
+
+namespace RixMatrix {
+
+    /// Eigenvalues and orthonormal eigenvectors of a symmetric matrix of any size, in one O(n^3) pass:
+    /// Householder reduction to tridiagonal form followed by the implicit QL algorithm.
+    /// Eigenvalues are sorted in descending order; eigenvector i is column i of getEigenvectors,
+    /// with the sign chosen so its first element is not negative (as Matrix::normalized does).
+    /// Like LuDecomposition, the workspace can be reused: construct with a size and call decompose.
+    class SymmetricEigenDecomposition {
+    public:
+        explicit SymmetricEigenDecomposition(Dimension size);
+        explicit SymmetricEigenDecomposition(const Matrix& matrix);
+
+        // only the lower triangle of the matrix is used. Returns false if QL didn't converge
+        bool decompose(const Matrix& matrix);
+
+        // column vector
+        const Matrix& getEigenvalues() const;
+        const Matrix& getEigenvectors() const;
+        bool hasConverged() const;
+        Dimension size() const;
+
+        static constexpr unsigned int MaxIterationsPerEigenvalue = 30;
+
+    private:
+        void tridiagonalize();
+        bool diagonalize();
+        void sort();
+
+        Matrix _eigenvectors;
+        Matrix _eigenvalues;
+        std::vector<double> _offDiagonal;
+        bool _hasConverged = false;
+    };
+}
+#endif
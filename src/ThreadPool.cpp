@@ -0,0 +1,221 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "ThreadPool.h"
+#include <cassert>
+
+#ifndef RIXMATRIX_NO_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace RixMatrix {
+
+#ifdef RIXMATRIX_NO_THREADS
+
+    struct ThreadPool::State {};
+
+    ThreadPool::ThreadPool(unsigned int) {}
+
+    ThreadPool::~ThreadPool() = default;
+
+    void ThreadPool::setThreadCount(unsigned int) {}
+
+    void ThreadPool::start(unsigned int) {}
+
+    void ThreadPool::stop() {}
+
+    void ThreadPool::parallelFor(const Dimension count, Dimension, const Task& task) {
+        if (count > 0) task(0, count);
+    }
+
+#else
+
+    namespace {
+        // set in the workers, so nested parallelFor calls don't wait for themselves
+        thread_local bool isInsideTask = false;
+    }
+
+    struct ThreadPool::State {
+        struct Job {
+            const Task* task;
+            std::atomic<Dimension> remaining;
+        };
+
+        struct Chunk {
+            Job* job;
+            Dimension begin;
+            Dimension end;
+        };
+
+        // a queue per worker, plus one (the last) for the callers of parallelFor
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable jobDone;
+        std::atomic<int> queuedChunks{ 0 };
+        bool isStopping = false;
+
+        /// @brief take the newest chunk from our own queue, or steal the oldest one from another
+        bool takeChunk(const size_t own, Chunk& chunk) {
+            {
+                std::lock_guard<std::mutex> lock(queues[own]->mutex);
+                auto& chunks = queues[own]->chunks;
+                if (!chunks.empty()) {
+                    chunk = chunks.back();
+                    chunks.pop_back();
+                    queuedChunks--;
+                    return true;
+                }
+            }
+            for (size_t offset = 1; offset < queues.size(); offset++) {
+                auto& victim = *queues[(own + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.chunks.empty()) {
+                    chunk = victim.chunks.front();
+                    victim.chunks.pop_front();
+                    queuedChunks--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(const Chunk& chunk) {
+            const bool wasInsideTask = isInsideTask;
+            isInsideTask = true;
+            (*chunk.job->task)(chunk.begin, chunk.end);
+            isInsideTask = wasInsideTask;
+            if (chunk.job->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobDone.notify_all();
+            }
+        }
+
+        void work(const size_t own) {
+            for (;;) {
+                Chunk chunk{};
+                if (takeChunk(own, chunk)) {
+                    run(chunk);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mutex);
+                workAvailable.wait(lock, [this] { return isStopping || queuedChunks > 0; });
+                if (isStopping) return;
+            }
+        }
+    };
+
+    ThreadPool::ThreadPool(const unsigned int threadCount) : _state(new State) {
+        start(threadCount);
+    }
+
+    ThreadPool::~ThreadPool() {
+        stop();
+    }
+
+    void ThreadPool::setThreadCount(const unsigned int threadCount) {
+        if (threadCount == _threadCount) return;
+        stop();
+        start(threadCount);
+    }
+
+    void ThreadPool::start(const unsigned int threadCount) {
+        _threadCount = threadCount < 1 ? 1 : threadCount;
+        const unsigned int workerCount = _threadCount - 1;
+        _state->isStopping = false;
+        _state->queues.clear();
+        for (unsigned int queue = 0; queue <= workerCount; queue++) {
+            _state->queues.emplace_back(new State::Queue);
+        }
+        for (unsigned int worker = 0; worker < workerCount; worker++) {
+            State* state = _state.get();
+            _state->workers.emplace_back([state, worker] { state->work(worker); });
+        }
+    }
+
+    void ThreadPool::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            _state->isStopping = true;
+        }
+        _state->workAvailable.notify_all();
+        for (auto& worker : _state->workers) {
+            worker.join();
+        }
+        _state->workers.clear();
+    }
+
+    void ThreadPool::parallelFor(const Dimension count, const Dimension grain, const Task& task) {
+        assert(grain > 0);
+        if (count == 0) return;
+        const Dimension chunkCount = (count + grain - 1) / grain;
+        if (_threadCount == 1 || chunkCount == 1 || isInsideTask) {
+            for (Dimension begin = 0; begin < count; begin += grain) {
+                task(begin, begin + grain < count ? begin + grain : count);
+            }
+            return;
+        }
+
+        State::Job job{ &task, {} };
+        job.remaining = chunkCount;
+        {
+            // announce before queueing, so the count can't go negative when a worker is quick
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            _state->queuedChunks += static_cast<int>(chunkCount);
+        }
+        const size_t queueCount = _state->queues.size();
+        for (Dimension chunk = 0; chunk < chunkCount; chunk++) {
+            const Dimension begin = chunk * grain;
+            auto& queue = *_state->queues[chunk % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.chunks.push_back({ &job, begin, begin + grain < count ? begin + grain : count });
+        }
+        _state->workAvailable.notify_all();
+
+        // help out until our job is done
+        const size_t own = queueCount - 1;
+        while (job.remaining > 0) {
+            State::Chunk chunk{};
+            if (_state->takeChunk(own, chunk)) {
+                _state->run(chunk);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_state->mutex);
+            _state->jobDone.wait(lock, [&job] { return job.remaining == 0; });
+        }
+    }
+
+#endif
+
+    ThreadPool& ThreadPool::instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    unsigned int ThreadPool::getThreadCount() const {
+        return _threadCount;
+    }
+
+    bool ThreadPool::isParallel() const {
+        return _threadCount > 1;
+    }
+}
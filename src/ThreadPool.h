@@ -0,0 +1,57 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <functional>
+#include <memory>
+#include "Array.h"
+
+namespace RixMatrix {
+
+    /// Persistent pool of worker threads with a work stealing queue per thread.
+    /// The library uses the shared instance for large matrix products and element wise operations.
+    /// Parallel execution is opt-in: the pool starts with a single thread (the caller), so nothing runs in parallel
+    /// until setThreadCount is called with a larger number. Define RIXMATRIX_NO_THREADS on platforms without std::thread.
+    class ThreadPool {
+    public:
+        using Task = std::function<void(Dimension begin, Dimension end)>;
+
+        explicit ThreadPool(unsigned int threadCount = 1);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // the pool the library uses
+        static ThreadPool& instance();
+
+        // total number of threads doing the work, including the calling one. 0 or 1 switches parallel execution off.
+        // Don't call this while work is running.
+        void setThreadCount(unsigned int threadCount);
+        unsigned int getThreadCount() const;
+        bool isParallel() const;
+
+        /// Run task on the chunks [begin, end) of [0, count), with chunks of grain elements (the last one may be smaller).
+        /// The chunking doesn't depend on the thread count. The calling thread takes part and this returns when all
+        /// chunks are done. Calls from inside a task run inline on the calling thread.
+        void parallelFor(Dimension count, Dimension grain, const Task& task);
+
+    private:
+        struct State;
+        void start(unsigned int threadCount);
+        void stop();
+
+        std::unique_ptr<State> _state;
+        unsigned int _threadCount = 1;
+    };
+}
+#endif
@@ -0,0 +1,204 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "UpdatableInverse.h"
+#include <cassert>
+#include <cmath>
+
+namespace RixMatrix {
+
+    template <class Value>
+    BasicUpdatableInverse<Value>::BasicUpdatableInverse(const BasicMatrix<Value>& matrix, const unsigned int refactorInterval) :
+        _matrix(matrix),
+        _inverse(matrix.rowCount(), matrix.columnCount()),
+        _lu(matrix.rowCount()),
+        _inverseU(matrix.rowCount()),
+        _vInverse(matrix.rowCount()),
+        _unit(matrix.rowCount(), 1),
+        _difference(matrix.rowCount(), 1),
+        _refactorInterval(refactorInterval) {
+        assert(matrix.isSquare());
+        refactor();
+    }
+
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::update(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v) {
+        assert(u.rowCount() == size() && u.columnCount() == 1 && v.rowCount() == size() && v.columnCount() == 1);
+        if (_isSingular) {
+            addToMatrix(u, v);
+            return refactor();
+        }
+        if (!applyRankOne(u.data(), v.data())) return false;
+        addToMatrix(u, v);
+        countUpdate();
+        return true;
+    }
+
+    /// @brief Woodbury: (A + U V^T)^-1 = A^-1 - A^-1 U (I + V^T A^-1 U)^-1 V^T A^-1, with a k x k system instead of an n x n one
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::updateLowRank(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v) {
+        assert(u.rowCount() == size() && v.rowCount() == size() && u.columnCount() == v.columnCount());
+        const Dimension rank = u.columnCount();
+        if (rank == 1) return update(u, v);
+        if (_isSingular) {
+            addToMatrix(u, v);
+            return refactor();
+        }
+
+        const BasicMatrix<Value> transposedV = v.template transposed<BasicMatrix<Value>>();
+        const BasicMatrix<Value> inverseU = _inverse * u;
+        BasicMatrix<Value> capacitance = transposedV * inverseU;
+        for (Dimension diagonal = 0; diagonal < rank; diagonal++) {
+            capacitance(diagonal, diagonal) += 1;
+        }
+        BasicMatrix<Value> correction = transposedV * _inverse;
+        if (!BasicLuDecomposition<Value>(capacitance).solve(correction)) return false;
+
+        _inverse -= inverseU * correction;
+        addToMatrix(u, v);
+        countUpdate();
+        return true;
+    }
+
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::replaceRow(const Dimension row, const BasicMatrix<Value>& values) {
+        const Dimension n = size();
+        assert(row < n && values.rowCount() == 1 && values.columnCount() == n);
+        // u = e_row, v = new row - old row
+        for (Dimension column = 0; column < n; column++) {
+            _difference(column, 0) = values(0, column) - _matrix(row, column);
+        }
+        _unit(row, 0) = 1;
+        const bool isUpdated = update(_unit, _difference);
+        _unit(row, 0) = 0;
+        return isUpdated;
+    }
+
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::replaceColumn(const Dimension column, const BasicMatrix<Value>& values) {
+        const Dimension n = size();
+        assert(column < n && values.rowCount() == n && values.columnCount() == 1);
+        // u = new column - old column, v = e_column
+        for (Dimension row = 0; row < n; row++) {
+            _difference(row, 0) = values(row, 0) - _matrix(row, column);
+        }
+        _unit(column, 0) = 1;
+        const bool isUpdated = update(_difference, _unit);
+        _unit(column, 0) = 0;
+        return isUpdated;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicUpdatableInverse<Value>::getInverse() const {
+        return _inverse;
+    }
+
+    template <class Value>
+    const BasicMatrix<Value>& BasicUpdatableInverse<Value>::getMatrix() const {
+        return _matrix;
+    }
+
+    template <class Value>
+    unsigned int BasicUpdatableInverse<Value>::getRefactorInterval() const {
+        return _refactorInterval;
+    }
+
+    template <class Value>
+    unsigned int BasicUpdatableInverse<Value>::getUpdatesSinceRefactor() const {
+        return _updatesSinceRefactor;
+    }
+
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::isSingular() const {
+        return _isSingular;
+    }
+
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::refactor() {
+        _lu.decompose(_matrix);
+        _isSingular = !_lu.getInverse(_inverse);
+        _updatesSinceRefactor = 0;
+        return !_isSingular;
+    }
+
+    template <class Value>
+    void BasicUpdatableInverse<Value>::setRefactorInterval(const unsigned int refactorInterval) {
+        _refactorInterval = refactorInterval;
+    }
+
+    template <class Value>
+    Dimension BasicUpdatableInverse<Value>::size() const {
+        return _matrix.rowCount();
+    }
+
+    /// @brief Sherman-Morrison: (A + u v^T)^-1 = A^-1 - (A^-1 u)(v^T A^-1) / (1 + v^T A^-1 u)
+    /// @return false if the denominator is (near) zero, i.e. the updated matrix would be singular. The inverse is then untouched.
+    template <class Value>
+    bool BasicUpdatableInverse<Value>::applyRankOne(const Value* u, const Value* v) {
+        const Dimension n = size();
+        const Value* inverse = _inverse.data();
+        // one pass over the inverse for both products
+        for (Dimension column = 0; column < n; column++) {
+            _vInverse[column] = 0;
+        }
+        for (Dimension row = 0; row < n; row++) {
+            const Value* inverseRow = inverse + row * n;
+            Value sum = 0;
+            for (Dimension column = 0; column < n; column++) {
+                sum += inverseRow[column] * u[column];
+                _vInverse[column] += v[row] * inverseRow[column];
+            }
+            _inverseU[row] = sum;
+        }
+        Value denominator = 1;
+        for (Dimension row = 0; row < n; row++) {
+            denominator += v[row] * _inverseU[row];
+        }
+        if (std::fabs(denominator) <= BasicArray<Value>::Epsilon) return false;
+
+        Value* target = _inverse.data();
+        for (Dimension row = 0; row < n; row++) {
+            const Value factor = _inverseU[row] / denominator;
+            if (factor == 0.0) continue;
+            Value* targetRow = target + row * n;
+            for (Dimension column = 0; column < n; column++) {
+                targetRow[column] -= factor * _vInverse[column];
+            }
+        }
+        return true;
+    }
+
+    /// @brief A += U V^T
+    template <class Value>
+    void BasicUpdatableInverse<Value>::addToMatrix(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v) {
+        const Dimension n = size();
+        for (Dimension row = 0; row < n; row++) {
+            for (Dimension column = 0; column < n; column++) {
+                Value sum = 0;
+                for (Dimension k = 0; k < u.columnCount(); k++) {
+                    sum += u(row, k) * v(column, k);
+                }
+                _matrix(row, column) += sum;
+            }
+        }
+    }
+
+    template <class Value>
+    void BasicUpdatableInverse<Value>::countUpdate() {
+        _updatesSinceRefactor++;
+        if (_refactorInterval > 0 && _updatesSinceRefactor >= _refactorInterval) {
+            refactor();
+        }
+    }
+
+    template class BasicUpdatableInverse<float>;
+    template class BasicUpdatableInverse<double>;
+}
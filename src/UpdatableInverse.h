@@ -0,0 +1,75 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef UPDATABLEINVERSE_H
+#define UPDATABLEINVERSE_H
+
+#include <vector>
+#include "LuDecomposition.h"
+
+namespace RixMatrix {
+
+    /// Keeps the inverse of a matrix up to date under low rank changes A += U V^T, without inverting again:
+    /// Sherman-Morrison for rank 1 (O(n^2)), Woodbury for rank k (O(n^2 k)). Meant for recursive estimators
+    /// that change one observation at a time. Rounding errors add up over updates, so every refactorInterval updates
+    /// the inverse is recalculated from the (also maintained) matrix via an LU decomposition. An interval of 0 never does.
+    /// While the matrix is singular, updates only change the matrix and recalculate the inverse.
+    template <class Value>
+    class BasicUpdatableInverse {
+    public:
+        explicit BasicUpdatableInverse(const BasicMatrix<Value>& matrix, unsigned int refactorInterval = DefaultRefactorInterval);
+
+        // A += u v^T, with u and v columns. Returns false (and changes nothing) if the result would be singular.
+        bool update(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v);
+        // A += U V^T, with U and V of n x k
+        bool updateLowRank(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v);
+        // rank 1 updates replacing a row or column of A by a row or column
+        bool replaceRow(Dimension row, const BasicMatrix<Value>& values);
+        bool replaceColumn(Dimension column, const BasicMatrix<Value>& values);
+
+        const BasicMatrix<Value>& getInverse() const;
+        const BasicMatrix<Value>& getMatrix() const;
+        unsigned int getRefactorInterval() const;
+        unsigned int getUpdatesSinceRefactor() const;
+        bool isSingular() const;
+        // recalculate the inverse from the matrix now. Returns false if it is singular
+        bool refactor();
+        void setRefactorInterval(unsigned int refactorInterval);
+        Dimension size() const;
+
+        static constexpr unsigned int DefaultRefactorInterval = 50;
+
+    private:
+        void addToMatrix(const BasicMatrix<Value>& u, const BasicMatrix<Value>& v);
+        bool applyRankOne(const Value* u, const Value* v);
+        void countUpdate();
+
+        BasicMatrix<Value> _matrix;
+        BasicMatrix<Value> _inverse;
+        BasicLuDecomposition<Value> _lu;
+        // A^-1 u and v^T A^-1, kept to avoid allocations in rank 1 updates
+        std::vector<Value> _inverseU;
+        std::vector<Value> _vInverse;
+        // the unit and difference vectors of replaceRow and replaceColumn. The unit vector is all zeros between calls.
+        BasicMatrix<Value> _unit;
+        BasicMatrix<Value> _difference;
+        unsigned int _refactorInterval;
+        unsigned int _updatesSinceRefactor = 0;
+        bool _isSingular = false;
+    };
+
+    template <class Value>
+    constexpr unsigned int BasicUpdatableInverse<Value>::DefaultRefactorInterval;
+
+    using UpdatableInverse = BasicUpdatableInverse<double>;
+    using FloatUpdatableInverse = BasicUpdatableInverse<float>;
+}
+#endif
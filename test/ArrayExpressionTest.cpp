@@ -0,0 +1,60 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <type_traits>
+#include "MatrixTest.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Array;
+    using RixMatrix::Matrix;
+
+    class ArrayExpressionTest : public MatrixTest {};
+
+    TEST_F(ArrayExpressionTest, fusedArrayExpression) {
+        const Array a({ {1, 2}, {3, 4} });
+        const Array b({ {5, 6}, {7, 8} });
+        const Array c({ {1, 1}, {2, 2} });
+        const Array result = a + b * 2 - c / 2 + a * b;
+        expectEqual(Array({ {15.5, 25.5}, {37, 51} }), result, "a + b * 2 - c / 2 + a * b");
+        expectEqual(Array({ {-2, -4}, {-6, -8} }), -2 * a, "scalar on the left");
+    }
+
+    TEST_F(ArrayExpressionTest, matrixExpressionStaysMatrix) {
+        const Matrix m({ {1, 2}, {3, 4} });
+        const Matrix n({ {0, 1}, {1, 0} });
+        static_assert(std::is_same<decltype(m + n)::ResultType, Matrix>::value, "matrix + matrix is a matrix");
+        static_assert(std::is_same<decltype(m + Array(m))::ResultType, Array>::value, "matrix + array is an array");
+        const Matrix sum = m + n * 3;
+        expectEqual(Matrix({ {1, 5}, {6, 4} }), sum, "m + n * 3");
+
+        // * between matrices is still the matrix product, also with an expression on one side
+        expectEqual(Matrix({ {2, 1}, {4, 3} }), m * n, "m * n");
+        expectEqual(Matrix({ {3, 1.5}, {6, 4.5} }), m * (n + n / 2), "m * (n + n / 2)");
+    }
+
+    TEST_F(ArrayExpressionTest, assignInPlace) {
+        Array a({ {1, 2}, {3, 4} });
+        const Array b({ {1, 1}, {1, 1} });
+        const double* storage = a.data();
+        a = a * 2 + b;
+        expectEqual(Array({ {3, 5}, {7, 9} }), a, "a = a * 2 + b");
+        EXPECT_EQ(storage, a.data()) << "evaluated in place";
+        a += b * 3;
+        expectEqual(Array({ {6, 8}, {10, 12} }), a, "a += b * 3");
+        a -= a / 2;
+        expectEqual(Array({ {3, 4}, {5, 6} }), a, "a -= a / 2");
+
+        Array other(1, 3);
+        other = a + b;
+        expectEqual(Array({ {4, 5}, {6, 7} }), other, "resized");
+    }
+}
@@ -24,7 +24,7 @@ namespace RixMatrixTest {
         for (Dimension row = 0; row < expected.rowCount(); row++) {
             for (Dimension column = 0; column < expected.columnCount(); column++) {
                 const auto difference = expected(row, column) - actual(row, column);
-                if (abs(difference) > epsilon) return false;
+                if (fabs(difference) > epsilon) return false;
             }
         }
         return true;
@@ -142,6 +142,27 @@ namespace RixMatrixTest {
         const auto actual = m.pow2();
         expectEqual(Array({ {1, 4}, {9, 16} }), actual);
     }
+
+    TEST_F(ArrayTest, pow2OfTemporarySquaresInPlace) {
+        Array m({ {1,2},{3,4} });
+        const double* storage = m.data();
+        const auto actual = std::move(m).pow2();
+        expectEqual(Array({ {1, 4}, {9, 16} }), actual);
+        EXPECT_EQ(storage, actual.data());
+    }
+
+    TEST_F(ArrayTest, move) {
+        Array m({ {1, 2}, {3, 4} });
+        const double* storage = m.data();
+        Array n(std::move(m));
+        EXPECT_EQ(storage, n.data());
+        EXPECT_EQ(0u, m.rowCount());
+        EXPECT_EQ(0u, m.size());
+        m = std::move(n);
+        EXPECT_EQ(storage, m.data());
+        EXPECT_EQ(0u, n.columnCount());
+        expectEqual(Array({ {1, 2}, {3, 4} }), m);
+    }
     TEST_F(ArrayTest, setColumn) {
         Array m({ {1, 2}, {3, 4} });
 
@@ -162,6 +183,19 @@ namespace RixMatrixTest {
         expectEqual(m, n, "nothing changed for setColumnCount");
     }
 
+    TEST_F(ArrayTest, setColumnCountKeepsStorage) {
+        Array n({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+        const double* storage = n.data();
+        n.setColumnCount(1);
+        expectEqual(Array({ {1}, {4}, {7} }), n, "shrink");
+        n.setColumnCount(2);
+        expectEqual(Array({ {1, 0}, {4, 0}, {7, 0} }), n, "grow, new column is 0");
+        n(1, 1) = 5;
+        n.setColumnCount(3);
+        expectEqual(Array({ {1, 0, 0}, {4, 5, 0}, {7, 0, 0} }), n, "grow back");
+        EXPECT_EQ(storage, n.data()) << "capacity reused";
+    }
+
     TEST_F(ArrayTest, setRow) {
         Array m({ {1, 2}, {3, 4} });
 
@@ -178,7 +212,12 @@ namespace RixMatrixTest {
         expectEqual(expected, n, "setRowCount larger");
         n.setRowCount(2);
         expectEqual(m, n, "setRowCount smaller");
+        const double* storage = n.data();
+        n.setRowCount(3);
+        expectEqual(Array({ {1, 2}, {3, 4}, {0, 0} }), n, "setRowCount within capacity");
+        EXPECT_EQ(storage, n.data()) << "capacity reused";
     }
+
     TEST_F(ArrayTest, DifferentSizesNotEqual) {
         const Array m({ {1, 2}, {3, 4} });
         const Array n({ {1} });
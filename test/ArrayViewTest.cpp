@@ -0,0 +1,68 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "ArrayTest.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::ArrayView;
+    using RixMatrix::ConstArrayView;
+
+    class ArrayViewTest : public ArrayTest {};
+
+    TEST_F(ArrayViewTest, readViews) {
+        const Array m({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+        const ConstArrayView column = m.column(1);
+        EXPECT_EQ(3, column.rowCount());
+        EXPECT_EQ(1, column.columnCount());
+        EXPECT_EQ(&m(0, 1), &column[0]) << "no copy";
+        expectEqual(Array({ {2}, {5}, {8} }), column, "column");
+        expectEqual(Array({ {4, 5, 6} }), m.row(1), "row");
+        expectEqual(Array({ {5, 6}, {8, 9} }), m.block(1, 1, 2, 2), "block");
+        EXPECT_EQ(8, m.block(1, 1, 2, 2)(1, 0));
+    }
+
+    TEST_F(ArrayViewTest, writeViews) {
+        Array m({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+        m.column(0) = m.column(2) * -1;
+        expectEqual(Array({ {-3, 2, 3}, {-6, 5, 6}, {-9, 8, 9} }), m, "column from expression");
+        m.row(2) = Array({ {0, 1, 0} });
+        m.row(1) = m.row(0);
+        expectEqual(Array({ {-3, 2, 3}, {-3, 2, 3}, {0, 1, 0} }), m, "rows assigned, not rebound");
+        auto block = m.block(0, 1, 2, 2);
+        block += block;
+        block /= 2;
+        block *= 3;
+        expectEqual(Array({ {-3, 6, 9}, {-3, 6, 9}, {0, 1, 0} }), m, "block compound assignment");
+        block = 0;
+        expectEqual(Array({ {-3, 0, 0}, {-3, 0, 0}, {0, 1, 0} }), m, "block scalar");
+    }
+
+    TEST_F(ArrayViewTest, viewsInExpressionsAndSetters) {
+        Array m({ {1, 2}, {3, 4} });
+        const Array sum = m.row(0) + m.row(1);
+        expectEqual(Array({ {4, 6} }), sum, "sum of rows");
+        m.setColumn(1, m.column(0) * 2);
+        expectEqual(Array({ {1, 2}, {3, 6} }), m, "setColumn from view expression");
+        m.setRow(0, m.row(1));
+        expectEqual(Array({ {3, 6}, {3, 6} }), m, "setRow from view");
+    }
+
+#ifdef _DEBUG
+    TEST_F(ArrayViewTest, viewAssertions) {
+        Array m({ {1, 2}, {3, 4} });
+        EXPECT_DEATH(m.column(2), "Assertion failed: .*column < _columns");
+        EXPECT_DEATH(m.row(2), "Assertion failed: .*row < _rows");
+        EXPECT_DEATH(m.block(1, 0, 2, 1), "Assertion failed: .*row \\+ rows <= _rows");
+        EXPECT_DEATH(m.row(0) = m.column(0), "Assertion failed: .*_rows == other.rowCount\\(\\)");
+    }
+#endif
+}
@@ -0,0 +1,151 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "MatrixTest.h"
+#include "CholeskyDecomposition.h"
+#include "LuDecomposition.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::CholeskyDecomposition;
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatCholeskyDecomposition;
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::LuDecomposition;
+
+    class CholeskyDecompositionTest : public MatrixTest {
+    protected:
+        // B B^T plus the size on the diagonal: symmetric positive definite, like a covariance matrix
+        static Matrix covariance(const Dimension size) {
+            Matrix b(size, size);
+            for (Dimension row = 0; row < size; row++) {
+                for (Dimension column = 0; column < size; column++) {
+                    b(row, column) = static_cast<double>((row * 5 + column * 3) % 7) / 7 - 0.5;
+                }
+            }
+            Matrix result = b * b.transposed<Matrix>();
+            for (Dimension diagonal = 0; diagonal < size; diagonal++) {
+                result(diagonal, diagonal) += size;
+            }
+            return result;
+        }
+    };
+
+    TEST_F(CholeskyDecompositionTest, lower) {
+        // the classic example with an integer factor
+        const Matrix m({ {4, 12, -16}, {12, 37, -43}, {-16, -43, 98} });
+        const CholeskyDecomposition cholesky(m);
+        ASSERT_TRUE(cholesky.isPositiveDefinite());
+        EXPECT_EQ(3u, cholesky.size());
+        expectEqual(Matrix({ {2, 0, 0}, {6, 1, 0}, {-8, 5, 3} }), cholesky.getLower());
+        EXPECT_NEAR(36, cholesky.getDeterminant(), 1e-10);
+        EXPECT_NEAR(std::log(36.0), cholesky.getLogDeterminant(), 1e-12);
+    }
+
+    TEST_F(CholeskyDecompositionTest, inPlace) {
+        Matrix m({ {4, 12, -16}, {12, 37, -43}, {-16, -43, 98} });
+        const double* storage = m.data();
+        ASSERT_TRUE(CholeskyDecomposition::decomposeInPlace(m));
+        EXPECT_EQ(storage, m.data());
+        expectEqual(Matrix({ {2, 0, 0}, {6, 1, 0}, {-8, 5, 3} }), m);
+    }
+
+    TEST_F(CholeskyDecompositionTest, notPositiveDefinite) {
+        // symmetric but indefinite (eigenvalues 3 and -1)
+        const Matrix indefinite({ {1, 2}, {2, 1} });
+        CholeskyDecomposition cholesky(indefinite);
+        EXPECT_FALSE(cholesky.isPositiveDefinite());
+        Matrix b({ {1}, {2} });
+        EXPECT_FALSE(cholesky.solve(b));
+        expectEqual(Matrix({ {1}, {2} }), b, "untouched");
+        Matrix inverse(2, 2);
+        EXPECT_FALSE(cholesky.getInverse(inverse));
+
+        // semi definite: singular
+        EXPECT_FALSE(cholesky.decompose(Matrix({ {1, 1}, {1, 1} })));
+        EXPECT_TRUE(cholesky.decompose(Matrix({ {2, 1}, {1, 2} })));
+        EXPECT_NEAR(3, cholesky.getDeterminant(), 1e-12);
+    }
+
+    TEST_F(CholeskyDecompositionTest, relativePivot) {
+        // all elements far below Epsilon, but still well conditioned
+        const Matrix tiny = covariance(40) * 1e-14;
+        const CholeskyDecomposition cholesky(tiny);
+        ASSERT_TRUE(cholesky.isPositiveDefinite());
+        const Matrix lower = cholesky.getLower();
+        expectEqual(tiny * 1e14, Matrix(lower * lower.transposed<Matrix>()) * 1e14, "L L^T", 1e-10);
+
+        // semi definite at a large scale: the last pivot is rounding noise, not a positive value
+        const Matrix b({ {1, 2}, {3, 4}, {6.1, 7} });
+        const Matrix large = Matrix(b * b.transposed<Matrix>()) * 1e8;
+        EXPECT_FALSE(CholeskyDecomposition(large).isPositiveDefinite());
+    }
+
+    TEST_F(CholeskyDecompositionTest, blocked) {
+        // more than one block, with a partial last one
+        constexpr Dimension Size = CholeskyDecomposition::BlockSize * 2 + 9;
+        const Matrix m = covariance(Size);
+        const CholeskyDecomposition cholesky(m);
+        ASSERT_TRUE(cholesky.isPositiveDefinite());
+        const Matrix& lower = cholesky.getLower();
+        expectEqual(m, lower * lower.transposed<Matrix>(), "L L^T", 1e-9);
+        const LuDecomposition lu(m);
+        EXPECT_NEAR(std::log(lu.getDeterminant()), cholesky.getLogDeterminant(), 1e-9);
+    }
+
+    TEST_F(CholeskyDecompositionTest, solveAndInverse) {
+        constexpr Dimension Size = 12;
+        const Matrix m = covariance(Size);
+        Matrix expected(Size, 3);
+        for (Dimension cell = 0; cell < expected.size(); cell++) {
+            expected[cell] = static_cast<double>(cell % 5) - 2;
+        }
+        CholeskyDecomposition cholesky(Size);
+        ASSERT_TRUE(cholesky.decompose(m));
+        Matrix result(Size, 3);
+        ASSERT_TRUE(cholesky.solve(m * expected, result));
+        expectEqual(expected, result, "solve", 1e-10);
+
+        Matrix inverse(Size, Size);
+        ASSERT_TRUE(cholesky.getInverse(inverse));
+        expectEqual(Matrix::getIdentity(Size), m * inverse, "inverse", 1e-10);
+    }
+
+    TEST_F(CholeskyDecompositionTest, matrixUsesFastPath) {
+        const Matrix m = covariance(6);
+        EXPECT_NEAR(LuDecomposition(m).getDeterminant(), m.getDeterminant(), 1e-8);
+        expectEqual(Matrix::getIdentity(6), m * m.inverted(), "inverted", 1e-10);
+        const Matrix b({ {1}, {2}, {3}, {4}, {5}, {6} });
+        expectEqual(b, m * m.solve(b), "solve", 1e-10);
+
+        // symmetric, not positive definite: falls back to LU
+        const Matrix indefinite({ {0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 2, 1}, {0, 0, 1, 2} });
+        EXPECT_NEAR(-3, indefinite.getDeterminant(), 1e-12);
+        expectEqual(Matrix::getIdentity(4), indefinite * indefinite.inverted(), "inverted indefinite", 1e-12);
+    }
+
+    TEST_F(CholeskyDecompositionTest, floatVersion) {
+        const FloatMatrix m({ {4, 12, -16}, {12, 37, -43}, {-16, -43, 98} });
+        const FloatCholeskyDecomposition cholesky(m);
+        ASSERT_TRUE(cholesky.isPositiveDefinite());
+        EXPECT_NEAR(36.0f, cholesky.getDeterminant(), 1e-3f);
+    }
+
+#ifdef DEBUG
+    TEST_F(CholeskyDecompositionTest, asserts) {
+        const CholeskyDecomposition cholesky(Matrix({ {1, 2}, {2, 1} }));
+        ASSERT_DEATH(cholesky.getDeterminant(), "Assertion.*failed");
+        ASSERT_DEATH(cholesky.getLogDeterminant(), "Assertion.*failed");
+        ASSERT_DEATH(CholeskyDecomposition(Matrix(2, 3)), "Assertion.*failed");
+    }
+#endif
+}
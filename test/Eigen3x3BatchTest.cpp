@@ -0,0 +1,158 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "MatrixTest.h"
+#include "SolverMatrix.h"
+#include "Eigen3x3Batch.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::Eigen3x3Batch;
+    using RixMatrix::SolverMatrix;
+
+    class Eigen3x3BatchTest : public MatrixTest {
+    protected:
+        // structure of arrays buffers for a number of matrices
+        struct Buffers {
+            explicit Buffers(const Dimension count) : input(9 * count), eigenvalues(3 * count), eigenvectors(9 * count), count(count) {}
+
+            void set(const Dimension lane, const Matrix& m) {
+                for (Dimension cell = 0; cell < 9; cell++) input[cell * count + lane] = m[cell];
+            }
+
+            Eigen3x3Batch::Input in() const {
+                Eigen3x3Batch::Input result;
+                for (Dimension cell = 0; cell < 9; cell++) result.element[cell / 3][cell % 3] = input.data() + cell * count;
+                return result;
+            }
+
+            Eigen3x3Batch::Output out() {
+                Eigen3x3Batch::Output result;
+                for (Dimension index = 0; index < 3; index++) {
+                    result.eigenvalue[index] = eigenvalues.data() + index * count;
+                    for (Dimension component = 0; component < 3; component++) {
+                        result.eigenvector[index][component] = eigenvectors.data() + (index * 3 + component) * count;
+                    }
+                }
+                return result;
+            }
+
+            double eigenvalue(const Dimension lane, const Dimension index) const {
+                return eigenvalues[index * count + lane];
+            }
+
+            // eigenvector as a column
+            Matrix eigenvector(const Dimension lane, const Dimension index) const {
+                Matrix result(3, 1);
+                for (Dimension component = 0; component < 3; component++) {
+                    result(component, 0) = eigenvectors[(index * 3 + component) * count + lane];
+                }
+                return result;
+            }
+
+            std::vector<double> input;
+            std::vector<double> eigenvalues;
+            std::vector<double> eigenvectors;
+            Dimension count;
+        };
+
+        static void expectEigenpair(const Matrix& m, const double lambda, const Matrix& vector, const std::string& message) {
+            EXPECT_NEAR(1, (vector.transposed<Matrix>() * vector)(0, 0), 1e-12) << message << " unit length";
+            expectEqual(vector * lambda, m * vector, message + " A v = lambda v", 1e-9);
+        }
+    };
+
+    TEST_F(Eigen3x3BatchTest, sameAsSolverMatrix) {
+        const SolverMatrix m({ {-2, -4, 2}, {-2, 1, 2}, {4, 2, 5} });
+        const auto values = m.getEigenvalues();
+        const auto vectors = m.getEigenvectors();
+        Buffers buffers(1);
+        buffers.set(0, m);
+        Eigen3x3Batch::getEigenvectors(buffers.in(), buffers.out(), 1);
+        for (Dimension index = 0; index < 3; index++) {
+            EXPECT_NEAR(values(index, 0), buffers.eigenvalue(0, index), 1e-12) << index;
+            expectEqual(Matrix(vectors.getColumn(index)), buffers.eigenvector(0, index), "vector " + std::to_string(index), 1e-9);
+        }
+    }
+
+    TEST_F(Eigen3x3BatchTest, manySymmetricMatrices) {
+        // more than a chunk and not a multiple of it, to cover the remainder
+        constexpr Dimension Count = 2 * Eigen3x3Batch::ChunkSize + 13;
+        std::mt19937 generator(3);
+        std::uniform_real_distribution<double> distribution(-10, 10);
+        std::vector<Matrix> matrices;
+        Buffers buffers(Count);
+        for (Dimension lane = 0; lane < Count; lane++) {
+            Matrix m(3, 3);
+            for (Dimension row = 0; row < 3; row++) {
+                for (Dimension column = 0; column <= row; column++) {
+                    m(row, column) = m(column, row) = distribution(generator);
+                }
+            }
+            buffers.set(lane, m);
+            matrices.push_back(m);
+        }
+        Eigen3x3Batch::getEigenvectors(buffers.in(), buffers.out(), Count);
+        for (Dimension lane = 0; lane < Count; lane++) {
+            for (Dimension index = 0; index < 3; index++) {
+                expectEigenpair(matrices[lane], buffers.eigenvalue(lane, index), buffers.eigenvector(lane, index),
+                    std::to_string(lane) + "/" + std::to_string(index));
+            }
+        }
+
+        Buffers valuesOnly(Count);
+        valuesOnly.input = buffers.input;
+        Eigen3x3Batch::getEigenvalues(valuesOnly.in(), valuesOnly.out(), Count);
+        EXPECT_EQ(buffers.eigenvalues, valuesOnly.eigenvalues);
+    }
+
+    TEST_F(Eigen3x3BatchTest, repeatedEigenvalues) {
+        const Matrix pair({ {2, 1, 0}, {1, 2, 0}, {0, 0, 3} });
+        const Matrix identity = Matrix::getIdentity(3) * 4;
+        Buffers buffers(2);
+        buffers.set(0, pair);
+        buffers.set(1, identity);
+        Eigen3x3Batch::getEigenvectors(buffers.in(), buffers.out(), 2);
+
+        EXPECT_NEAR(3, buffers.eigenvalue(0, 0), 1e-12);
+        EXPECT_NEAR(1, buffers.eigenvalue(0, 1), 1e-12);
+        EXPECT_NEAR(3, buffers.eigenvalue(0, 2), 1e-12);
+        Matrix vectors(3, 3);
+        for (Dimension index = 0; index < 3; index++) {
+            expectEigenpair(pair, buffers.eigenvalue(0, index), buffers.eigenvector(0, index), "pair " + std::to_string(index));
+            vectors.column(index) = buffers.eigenvector(0, index);
+        }
+        expectEqual(Matrix::getIdentity(3), vectors.transposed<Matrix>() * vectors, "orthonormal", 1e-12);
+
+        for (Dimension index = 0; index < 3; index++) {
+            EXPECT_NEAR(4, buffers.eigenvalue(1, index), 1e-12);
+            Matrix expected(3, 1);
+            expected(index, 0) = 1;
+            expectEqual(expected, buffers.eigenvector(1, index), "identity " + std::to_string(index));
+        }
+    }
+
+    TEST_F(Eigen3x3BatchTest, complexEigenvalues) {
+        // rotation around the z axis, scaled by 2: eigenvalues 2 and +/- 2i
+        const Matrix rotation({ {0, -2, 0}, {2, 0, 0}, {0, 0, 2} });
+        Buffers buffers(1);
+        buffers.set(0, rotation);
+        Eigen3x3Batch::getEigenvectors(buffers.in(), buffers.out(), 1);
+        EXPECT_NEAR(2, buffers.eigenvalue(0, 0), 1e-12);
+        EXPECT_TRUE(std::isnan(buffers.eigenvalue(0, 1)));
+        EXPECT_TRUE(std::isnan(buffers.eigenvalue(0, 2)));
+        expectEqual(Matrix({ {0}, {0}, {1} }), buffers.eigenvector(0, 0), "real eigenvector", 1e-12);
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "ElementKernels.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::ElementKernels;
+    using RixMatrix::InstructionSet;
+
+    class ElementKernelsTest : public testing::TestWithParam<InstructionSet> {
+    protected:
+        void SetUp() override {
+            _original = ElementKernels::getInstructionSet();
+            if (!ElementKernels::setInstructionSet(GetParam())) {
+                GTEST_SKIP() << "instruction set not supported on this CPU";
+            }
+        }
+
+        void TearDown() override {
+            ElementKernels::setInstructionSet(_original);
+        }
+
+        // sizes that exercise the vector loops as well as all the remainders
+        static constexpr Dimension MaxCount = 37;
+
+        static std::vector<double> values(const Dimension count, const double offset) {
+            std::vector<double> result(count);
+            for (Dimension i = 0; i < count; i++) {
+                result[i] = offset + i * 0.5 - 3;
+            }
+            return result;
+        }
+
+    private:
+        InstructionSet _original = InstructionSet::Scalar;
+    };
+
+    TEST_P(ElementKernelsTest, binaryOperations) {
+        for (Dimension count = 0; count <= MaxCount; count++) {
+            const auto source = values(count, 1.25);
+            auto sum = values(count, 2);
+            auto difference = values(count, 2);
+            auto product = values(count, 2);
+            const auto original = values(count, 2);
+            ElementKernels::add(sum.data(), source.data(), count);
+            ElementKernels::subtract(difference.data(), source.data(), count);
+            ElementKernels::multiply(product.data(), source.data(), count);
+            for (Dimension i = 0; i < count; i++) {
+                EXPECT_EQ(original[i] + source[i], sum[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] - source[i], difference[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] * source[i], product[i]) << count << "/" << i;
+            }
+        }
+    }
+
+    TEST_P(ElementKernelsTest, scalarOperations) {
+        for (Dimension count = 0; count <= MaxCount; count++) {
+            auto sum = values(count, 2);
+            auto product = values(count, 2);
+            auto quotient = values(count, 2);
+            const auto original = values(count, 2);
+            ElementKernels::addScalar(sum.data(), 0.75, count);
+            ElementKernels::multiplyScalar(product.data(), -3, count);
+            ElementKernels::divideScalar(quotient.data(), 7, count);
+            for (Dimension i = 0; i < count; i++) {
+                EXPECT_EQ(original[i] + 0.75, sum[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] * -3, product[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] / 7, quotient[i]) << count << "/" << i;
+            }
+        }
+    }
+
+    TEST_P(ElementKernelsTest, squares) {
+        for (Dimension count = 0; count <= MaxCount; count++) {
+            const auto source = values(count, 0.5);
+            std::vector<double> squares(count);
+            ElementKernels::square(squares.data(), source.data(), count);
+            double expectedSum = 0;
+            for (Dimension i = 0; i < count; i++) {
+                EXPECT_EQ(source[i] * source[i], squares[i]) << count << "/" << i;
+                expectedSum += source[i] * source[i];
+            }
+            // the vector versions add in a different order
+            EXPECT_NEAR(expectedSum, ElementKernels::sumOfSquares(source.data(), count), 1e-12) << count;
+        }
+    }
+
+    TEST_P(ElementKernelsTest, floatOperations) {
+        // the float kernels have twice the lanes, so the remainders differ from the double ones
+        for (Dimension count = 0; count <= MaxCount; count++) {
+            const auto doubleSource = values(count, 1.25);
+            const auto doubleOriginal = values(count, 2);
+            const std::vector<float> source(doubleSource.begin(), doubleSource.end());
+            const std::vector<float> original(doubleOriginal.begin(), doubleOriginal.end());
+            auto sum = original;
+            auto difference = original;
+            auto product = original;
+            auto scaled = original;
+            auto quotient = original;
+            std::vector<float> squares(count);
+            ElementKernels::add(sum.data(), source.data(), count);
+            ElementKernels::subtract(difference.data(), source.data(), count);
+            ElementKernels::multiply(product.data(), source.data(), count);
+            ElementKernels::multiplyScalar(scaled.data(), -3.0f, count);
+            ElementKernels::divideScalar(quotient.data(), 7.0f, count);
+            ElementKernels::square(squares.data(), source.data(), count);
+            float expectedSum = 0;
+            for (Dimension i = 0; i < count; i++) {
+                EXPECT_EQ(original[i] + source[i], sum[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] - source[i], difference[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] * source[i], product[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] * -3.0f, scaled[i]) << count << "/" << i;
+                EXPECT_EQ(original[i] / 7.0f, quotient[i]) << count << "/" << i;
+                EXPECT_EQ(source[i] * source[i], squares[i]) << count << "/" << i;
+                expectedSum += source[i] * source[i];
+            }
+            EXPECT_NEAR(expectedSum, ElementKernels::sumOfSquares(source.data(), count), 1e-3f) << count;
+        }
+    }
+
+    TEST(ElementKernelsDispatchTest, bestIsSelected) {
+        EXPECT_EQ(ElementKernels::getBestInstructionSet(), ElementKernels::getInstructionSet());
+        EXPECT_TRUE(ElementKernels::setInstructionSet(InstructionSet::Scalar));
+        EXPECT_EQ(InstructionSet::Scalar, ElementKernels::getInstructionSet());
+        EXPECT_TRUE(ElementKernels::setInstructionSet(ElementKernels::getBestInstructionSet()));
+    }
+
+    INSTANTIATE_TEST_SUITE_P(InstructionSets, ElementKernelsTest,
+        testing::Values(InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2, InstructionSet::Avx512));
+}
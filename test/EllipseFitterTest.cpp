@@ -0,0 +1,168 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "EllipseFitter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::EllipseFitter;
+
+    class EllipseFitterTest : public MatrixTest {
+    protected:
+        struct Ellipse {
+            double centerX;
+            double centerY;
+            double semiAxisX;
+            double semiAxisY;
+            double angle;
+
+            void pointAt(const double t, double& x, double& y) const {
+                const double u = semiAxisX * cos(t);
+                const double v = semiAxisY * sin(t);
+                x = centerX + u * cos(angle) - v * sin(angle);
+                y = centerY + u * sin(angle) + v * cos(angle);
+            }
+
+            // normalized the same way as EllipseFitter::fit
+            Matrix conic() const {
+                const double cosine = cos(angle);
+                const double sine = sin(angle);
+                const double inverseX = 1 / (semiAxisX * semiAxisX);
+                const double inverseY = 1 / (semiAxisY * semiAxisY);
+                const double a = cosine * cosine * inverseX + sine * sine * inverseY;
+                const double b = 2 * cosine * sine * (inverseX - inverseY);
+                const double c = sine * sine * inverseX + cosine * cosine * inverseY;
+                Matrix result({
+                    {a}, {b}, {c},
+                    {-2 * a * centerX - b * centerY},
+                    {-b * centerX - 2 * c * centerY},
+                    {a * centerX * centerX + b * centerX * centerY + c * centerY * centerY - 1}
+                });
+                return std::move(result).normalized();
+            }
+        };
+
+        static void addPoints(EllipseFitter& fitter, const Ellipse& ellipse, const unsigned long count) {
+            for (unsigned long index = 0; index < count; index++) {
+                double x;
+                double y;
+                ellipse.pointAt(2 * M_PI * static_cast<double>(index) / static_cast<double>(count), x, y);
+                fitter.addPoint(x, y);
+            }
+        }
+    };
+
+    TEST_F(EllipseFitterTest, exactPoints) {
+        const Ellipse ellipse{ 3, -2, 5, 2, M_PI / 6 };
+        EllipseFitter fitter;
+        addPoints(fitter, ellipse, 50);
+        EXPECT_EQ(50u, fitter.getPointCount());
+        Matrix coefficients(6, 1);
+        ASSERT_TRUE(fitter.fit(coefficients));
+        expectEqual(ellipse.conic(), coefficients, "conic", 1e-9);
+        const double a = coefficients(0, 0);
+        const double b = coefficients(1, 0);
+        const double c = coefficients(2, 0);
+        EXPECT_GT(4 * a * c - b * b, 0) << "ellipse";
+    }
+
+    TEST_F(EllipseFitterTest, fivePointsDetermineTheEllipse) {
+        const Ellipse ellipse{ 0, 0, 2, 1, 0 };
+        EllipseFitter fitter;
+        addPoints(fitter, ellipse, 5);
+        expectEqual(ellipse.conic(), fitter.fit(), "five points", 1e-9);
+    }
+
+    TEST_F(EllipseFitterTest, largeOffsetLongStream) {
+        // far from the origin, so the fourth powers would swamp the shape without the shift to the first point
+        const Ellipse ellipse{ 1e5, -2e5, 30, 10, 1 };
+        EllipseFitter fitter;
+        addPoints(fitter, ellipse, 200000);
+        const Matrix coefficients = fitter.fit();
+        ASSERT_EQ(6u, coefficients.rowCount());
+        // compare shapes at a point on the ellipse rather than the coefficients, which are dominated by f here
+        for (double t = 0.1; t < 6; t += 1.3) {
+            double x;
+            double y;
+            ellipse.pointAt(t, x, y);
+            const double value = coefficients(0, 0) * x * x + coefficients(1, 0) * x * y + coefficients(2, 0) * y * y +
+                coefficients(3, 0) * x + coefficients(4, 0) * y + coefficients(5, 0);
+            EXPECT_NEAR(0, value / coefficients(5, 0), 1e-9) << t;
+        }
+        const Matrix expected = ellipse.conic();
+        EXPECT_NEAR(expected(1, 0) / expected(0, 0), coefficients(1, 0) / coefficients(0, 0), 1e-6);
+        EXPECT_NEAR(expected(2, 0) / expected(0, 0), coefficients(2, 0) / coefficients(0, 0), 1e-6);
+    }
+
+    TEST_F(EllipseFitterTest, noisyPoints) {
+        const Ellipse ellipse{ -1, 4, 3, 1.5, -0.4 };
+        EllipseFitter fitter;
+        constexpr unsigned long Count = 1000;
+        for (unsigned long index = 0; index < Count; index++) {
+            double x;
+            double y;
+            ellipse.pointAt(2 * M_PI * static_cast<double>(index) / Count, x, y);
+            // deterministic noise, alternating inside and outside
+            const double noise = (index % 2 == 0 ? 1 : -1) * 0.01 * static_cast<double>(index % 7);
+            fitter.addPoint(x + noise, y - noise);
+        }
+        expectEqual(ellipse.conic(), fitter.fit(), "noisy", 5e-3);
+    }
+
+    TEST_F(EllipseFitterTest, noEllipse) {
+        EllipseFitter fitter;
+        Matrix coefficients(6, 1);
+        EXPECT_FALSE(fitter.fit(coefficients)) << "no points";
+        for (int index = 0; index < 4; index++) {
+            fitter.addPoint(index, index * index);
+        }
+        EXPECT_FALSE(fitter.fit(coefficients)) << "four points";
+        EXPECT_EQ(0u, fitter.fit().rowCount());
+
+        fitter.reset();
+        EXPECT_EQ(0u, fitter.getPointCount());
+        for (int index = 0; index < 10; index++) {
+            fitter.addPoint(index, 2 * index + 1);
+        }
+        EXPECT_FALSE(fitter.fit(coefficients)) << "line";
+
+        fitter.reset();
+        for (int index = 0; index < 10; index++) {
+            fitter.addPoint(1, 1);
+        }
+        EXPECT_FALSE(fitter.fit(coefficients)) << "single point";
+    }
+
+    TEST_F(EllipseFitterTest, scatterMatrix) {
+        EllipseFitter fitter;
+        fitter.addPoint(10, 20);
+        fitter.addPoint(12, 21);
+        const auto scatter = fitter.getScatterMatrix();
+        // relative to the first point, the second one is (2, 1): z = (4, 2, 1, 2, 1, 1); the first adds (0, .., 0, 1)
+        const Matrix expected({
+            {16, 8, 4, 8, 4, 4},
+            {8, 4, 2, 4, 2, 2},
+            {4, 2, 1, 2, 1, 1},
+            {8, 4, 2, 4, 2, 2},
+            {4, 2, 1, 2, 1, 1},
+            {4, 2, 1, 2, 1, 2}
+        });
+        expectEqual(expected, scatter.toMatrix());
+    }
+}
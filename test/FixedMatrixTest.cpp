@@ -0,0 +1,79 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "FixedMatrix.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::FixedMatrix;
+
+    // aliases, because the macros don't like the comma in the template arguments
+    using Fixed1 = FixedMatrix<1, 1>;
+    using Fixed2 = FixedMatrix<2, 2>;
+    using Fixed3 = FixedMatrix<3, 3>;
+    using Fixed4 = FixedMatrix<4, 4>;
+
+    class FixedMatrixTest : public MatrixTest {};
+
+    TEST_F(FixedMatrixTest, convertFromAndToMatrix) {
+        const Matrix m({ {1, 2, 3}, {4, 5, 6} });
+        const FixedMatrix<2, 3> fixed(m);
+        EXPECT_EQ(6, fixed(1, 2));
+        EXPECT_EQ(2, fixed.rowCount());
+        EXPECT_EQ(3, fixed.columnCount());
+        expectEqual(m, fixed.toMatrix());
+    }
+
+    TEST_F(FixedMatrixTest, multiply) {
+        const FixedMatrix<2, 3> m({ {1, 2, 3}, {3, -1, 0} });
+        const FixedMatrix<3, 2> n({ {1, 2}, {3, 4}, {5, 6} });
+        const Fixed2 product = m * n;
+        EXPECT_TRUE(product == Fixed2({ {22, 28}, {0, 2} }));
+        const Fixed3 reverse = n * m;
+        expectEqual(Matrix({ {7, 0, 3}, {15, 2, 9}, {23, 4, 15} }), reverse.toMatrix());
+    }
+
+    TEST_F(FixedMatrixTest, elementWise) {
+        const Fixed2 m({ {1, 2}, {3, 4} });
+        expectEqual(Matrix({ {2, 4}, {6, 8} }), (m + m).toMatrix(), "add");
+        expectEqual(Matrix({ {0, 0}, {0, 0} }), (m - m).toMatrix(), "subtract");
+        expectEqual(Matrix({ {3, 6}, {9, 12} }), (3 * m).toMatrix(), "scalar multiply");
+        expectEqual(Matrix({ {0.5, 1}, {1.5, 2} }), (m / 2).toMatrix(), "scalar divide");
+    }
+
+    TEST_F(FixedMatrixTest, transpose) {
+        const FixedMatrix<2, 3> m({ {1, 2, 3}, {4, 5, 6} });
+        expectEqual(Matrix({ {1, 4}, {2, 5}, {3, 6} }), m.transposed().toMatrix());
+    }
+
+    TEST_F(FixedMatrixTest, determinantAndTrace) {
+        EXPECT_EQ(6, Fixed1({ {6} }).getDeterminant());
+        EXPECT_EQ(-2, Fixed2({ {1, 2}, {3, 4} }).getDeterminant());
+        EXPECT_EQ(0, Fixed3({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} }).getDeterminant());
+        const Fixed4 m({ {1, 3, 5, 9}, {1, 3, 1, 7}, {4, 3, 9, 7}, {5, 2, 0, 9} });
+        EXPECT_NEAR(-376, m.getDeterminant(), 1e-10);
+        EXPECT_EQ(22, m.getTrace());
+        EXPECT_EQ(0, Fixed4().getDeterminant());
+    }
+
+    TEST_F(FixedMatrixTest, inverse) {
+        const Fixed2 m2({ {1, 2}, {3, 4} });
+        expectEqual(Matrix({ {-2, 1}, {1.5, -0.5} }), m2.inverted().toMatrix(), "2x2");
+        const Fixed3 m3({ {1, 2, 3}, {0, 1, 4}, {5, 6, 0} });
+        expectEqual(Matrix({ {-24, 18, 5}, {20, -15, -4}, {-5, 4, 1} }), m3.inverted().toMatrix(), "3x3");
+        const Fixed4 m4({ {0, 2, 0, 1}, {1, 0, 0, 0}, {0, 0, 3, 0}, {0, 1, 0, 1} });
+        EXPECT_TRUE(m4.isInvertible());
+        EXPECT_TRUE(Fixed4::getIdentity() == m4 * m4.inverted());
+        EXPECT_TRUE(Fixed1({ {0.25} }) == Fixed1({ {4} }).inverted());
+        EXPECT_FALSE(Fixed2({ {1, 2}, {2, 4} }).isInvertible());
+    }
+}
@@ -0,0 +1,122 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "FixedMatrix.h"
+#include "LuDecomposition.h"
+#include "SolverMatrix.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::FixedMatrix;
+    using RixMatrix::FloatArray;
+    using RixMatrix::FloatLuDecomposition;
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::FloatSolverMatrix;
+    using RixMatrix::SolverMatrix;
+
+    class FloatMatrixTest : public MatrixTest {
+    protected:
+        // compare in double, with the float tolerance
+        static void expectFloatEqual(const Array& expected, const FloatArray& actual, const std::string& message = "") {
+            expectEqual(expected, Array(actual), message, FloatArray::Epsilon);
+        }
+    };
+
+    TEST_F(FloatMatrixTest, precisionPerType) {
+        static_assert(std::is_same<FloatArray::ValueType, float>::value, "float array holds floats");
+        static_assert(std::is_same<Matrix::ValueType, double>::value, "matrix holds doubles");
+        EXPECT_GT(FloatArray::Epsilon, Array::Epsilon);
+        EXPECT_GT(FloatSolverMatrix::EigenEpsilon, SolverMatrix::EigenEpsilon);
+    }
+
+    TEST_F(FloatMatrixTest, conversion) {
+        const Matrix original({ {1.5, -2}, {0.1, 4} });
+        const FloatMatrix converted(original);
+        EXPECT_EQ(0.1f, converted(1, 0));
+        const Matrix back(converted);
+        expectEqual(original, back, "round trip", 1e-7);
+    }
+
+    TEST_F(FloatMatrixTest, elementWise) {
+        const FloatArray a({ {1, 2, 3}, {4, 5, 6} });
+        const FloatArray b({ {0.5, 0.25, 2}, {1, -1, 3} });
+        const FloatArray result = (a + b) * 2.0f - a / 4.0f;
+        expectFloatEqual(Array({ {2.75, 4, 9.25}, {9, 6.75, 16.5} }), result);
+        FloatArray product = a * b;
+        expectFloatEqual(Array({ {0.5, 0.5, 6}, {4, -5, 18} }), product);
+        product.row(1) = b.row(0);
+        expectFloatEqual(Array({ {0.5, 0.5, 6}, {0.5, 0.25, 2} }), product);
+    }
+
+    TEST_F(FloatMatrixTest, multiply) {
+        const FloatMatrix a({ {1, 2, 3}, {4, 5, 6} });
+        const FloatMatrix b({ {7, 8}, {9, 10}, {11, 12} });
+        expectFloatEqual(Array({ {58, 64}, {139, 154} }), a * b);
+
+        // large enough for the blocked path
+        constexpr Dimension Size = 70;
+        FloatMatrix left(Size, Size);
+        FloatMatrix right(Size, Size);
+        Matrix doubleLeft(Size, Size);
+        Matrix doubleRight(Size, Size);
+        for (Dimension row = 0; row < Size; row++) {
+            for (Dimension column = 0; column < Size; column++) {
+                doubleLeft(row, column) = left(row, column) = static_cast<float>((row * 3 + column) % 7) - 3;
+                doubleRight(row, column) = right(row, column) = static_cast<float>((row + column * 5) % 11) / 4;
+            }
+        }
+        // small integers and quarters, so float is exact
+        expectEqual(doubleLeft * doubleRight, Array(left * right), "blocked", 0);
+    }
+
+    TEST_F(FloatMatrixTest, determinantAndInverse) {
+        const FloatMatrix m({ {4, 7, 2}, {3, 6, 1}, {2, 5, 3} });
+        EXPECT_FLOAT_EQ(9, m.getDeterminant());
+        const auto inverse = m.inverted();
+        expectFloatEqual(Matrix::getIdentity(3), m * inverse);
+        const FloatLuDecomposition decomposition(m);
+        EXPECT_FLOAT_EQ(9, decomposition.getDeterminant());
+        const FixedMatrix<3, 3, float> fixed(m);
+        EXPECT_FLOAT_EQ(9, fixed.getDeterminant());
+    }
+
+    TEST_F(FloatMatrixTest, eigenvalues) {
+        const FloatSolverMatrix m2({ {2, 1}, {1, 2} });
+        expectFloatEqual(Array({ {3}, {1} }), m2.getEigenvalues());
+
+        const FloatSolverMatrix m3({ {2, 0, 0}, {0, 3, 4}, {0, 4, 9} });
+        const SolverMatrix d3({ {2, 0, 0}, {0, 3, 4}, {0, 4, 9} });
+        expectFloatEqual(d3.getEigenvalues(), m3.getEigenvalues());
+        const auto eigenvectors = m3.getEigenvectors();
+        ASSERT_EQ(3u, eigenvectors.columnCount());
+        for (Dimension column = 0; column < 3; column++) {
+            const FloatMatrix vector(eigenvectors.getColumn(column));
+            const auto lambda = m3.getEigenvalues()(column, 0);
+            expectFloatEqual(Array(vector * lambda), m3 * vector, "eigenvector " + std::to_string(column));
+        }
+
+        // goes through the double precision iterative solver
+        const FloatSolverMatrix m4({ {4, 1, 0, 0}, {1, 4, 1, 0}, {0, 1, 4, 1}, {0, 0, 1, 4} });
+        const SolverMatrix d4({ {4, 1, 0, 0}, {1, 4, 1, 0}, {0, 1, 4, 1}, {0, 0, 1, 4} });
+        expectFloatEqual(d4.getEigenvalues(), m4.getEigenvalues());
+    }
+
+    TEST_F(FloatMatrixTest, nullSpace) {
+        FloatSolverMatrix m({ {1, 2, 3}, {3, 4, 5}, {4, 5, 6} });
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
+        const FloatMatrix nullSpace = m.getNullSpace(permutation);
+        ASSERT_EQ(1u, nullSpace.columnCount());
+        const FloatMatrix original({ {1, 2, 3}, {3, 4, 5}, {4, 5, 6} });
+        expectFloatEqual(Array(3, 1), original * nullSpace);
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <random>
+#include "MatrixTest.h"
+#include "SolverMatrix.h"
+#include "GeneralEigenDecomposition.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::GeneralEigenDecomposition;
+    using RixMatrix::SolverMatrix;
+
+    class GeneralEigenDecompositionTest : public MatrixTest {};
+
+    TEST_F(GeneralEigenDecompositionTest, rotationHasComplexPair) {
+        const Matrix rotation({ {0, -1}, {1, 0} });
+        const GeneralEigenDecomposition decomposition(rotation);
+        EXPECT_TRUE(decomposition.hasConverged());
+        expectEqual(Matrix({ {0}, {0} }), decomposition.getRealParts(), "real");
+        expectEqual(Matrix({ {1}, {-1} }), decomposition.getImaginaryParts(), "imaginary");
+        EXPECT_EQ(0, decomposition.getRealEigenvalues().rowCount());
+    }
+
+    TEST_F(GeneralEigenDecompositionTest, companionMatrix) {
+        // companion matrix of x^5 - 4x^4 + 4x^3 - 14x^2 + 43x - 30 = (x - 1)(x - 2)(x - 3)(x^2 + 2x + 5), with roots 3, 2, 1 and -1 +/- 2i
+        const Matrix m({
+            {0, 0, 0, 0, 30},
+            {1, 0, 0, 0, -43},
+            {0, 1, 0, 0, 14},
+            {0, 0, 1, 0, -4},
+            {0, 0, 0, 1, 4}
+        });
+        const GeneralEigenDecomposition decomposition(m);
+        EXPECT_TRUE(decomposition.hasConverged());
+        expectEqual(Matrix({ {3}, {2}, {1}, {-1}, {-1} }), decomposition.getRealParts(), "real", 1e-9);
+        expectEqual(Matrix({ {0}, {0}, {0}, {2}, {-2} }), decomposition.getImaginaryParts(), "imaginary", 1e-9);
+        expectEqual(Matrix({ {3}, {2}, {1} }), decomposition.getRealEigenvalues(), "real eigenvalues", 1e-9);
+    }
+
+    TEST_F(GeneralEigenDecompositionTest, triangular) {
+        const Matrix m({ {1, 2, 3, 4}, {0, 5, 6, 7}, {0, 0, -8, 9}, {0, 0, 0, 2} });
+        const GeneralEigenDecomposition decomposition(m);
+        expectEqual(Matrix({ {5}, {2}, {1}, {-8} }), decomposition.getRealParts(), "real", 1e-12);
+    }
+
+    TEST_F(GeneralEigenDecompositionTest, largeRandomMatrix) {
+        // sum of the eigenvalues is the trace, sum of their squares the trace of the square
+        constexpr Dimension Size = 200;
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        Matrix m(Size, Size);
+        for (Dimension cell = 0; cell < m.size(); cell++) {
+            m[cell] = distribution(generator);
+        }
+        GeneralEigenDecomposition decomposition(Size);
+        ASSERT_TRUE(decomposition.decompose(m));
+        const auto& real = decomposition.getRealParts();
+        const auto& imaginary = decomposition.getImaginaryParts();
+        double sum = 0;
+        double imaginarySum = 0;
+        double sumOfSquares = 0;
+        for (Dimension i = 0; i < Size; i++) {
+            sum += real[i];
+            imaginarySum += imaginary[i];
+            sumOfSquares += real[i] * real[i] - imaginary[i] * imaginary[i];
+            if (i > 0) {
+                EXPECT_GE(real[i - 1], real[i]) << "sorted " << i;
+            }
+        }
+        EXPECT_NEAR(m.getTrace(), sum, 1e-9);
+        EXPECT_NEAR(0, imaginarySum, 1e-9);
+        EXPECT_NEAR(m.squared().getTrace(), sumOfSquares, 1e-8);
+    }
+
+    TEST_F(GeneralEigenDecompositionTest, solverMatrixUsesItBeyond3x3) {
+        const SolverMatrix m({ {2, 0, 0, 0}, {1, 3, 0, 0}, {0, 0, 0, -1}, {0, 0, 1, 0} });
+        EXPECT_FALSE(m.isSymmetric());
+        expectEqual(Matrix({ {3}, {2} }), m.getEigenvalues(), "complex pair left out", 1e-12);
+    }
+}
@@ -0,0 +1,160 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "LuDecomposition.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::LuDecomposition;
+    using RixMatrix::Dimension;
+
+    class LuDecompositionTest : public MatrixTest {};
+
+    TEST_F(LuDecompositionTest, determinant) {
+        const Matrix m({ {1, 3, 5, 9}, {1, 3, 1, 7}, {4, 3, 9, 7}, {5, 2, 0, 9} });
+        const LuDecomposition lu(m);
+        EXPECT_NEAR(-376, lu.getDeterminant(), 1e-10);
+        EXPECT_FALSE(lu.isSingular());
+        EXPECT_EQ(4, lu.size());
+    }
+
+    TEST_F(LuDecompositionTest, determinantNeedsPivot) {
+        // zero in the top left corner, so this only works with pivoting
+        const Matrix m({ {0, 1, 2}, {1, 0, 3}, {4, -3, 8} });
+        EXPECT_NEAR(-2, LuDecomposition(m).getDeterminant(), 1e-12);
+    }
+
+    TEST_F(LuDecompositionTest, singular) {
+        const Matrix m({ {1, 2, 3, 4}, {2, 4, 6, 8}, {0, 1, 0, 1}, {1, 0, 1, 0} });
+        const LuDecomposition lu(m);
+        EXPECT_TRUE(lu.isSingular());
+        EXPECT_NEAR(0, lu.getDeterminant(), Array::Epsilon);
+    }
+
+    TEST_F(LuDecompositionTest, minor) {
+        const Matrix m({ {1, 3, 5, 9}, {1, 3, 1, 7}, {4, 3, 9, 7}, {5, 2, 0, 9} });
+        for (Dimension row = 0; row < 4; row++) {
+            for (Dimension column = 0; column < 4; column++) {
+                const LuDecomposition lu(m, row, column);
+                EXPECT_EQ(3, lu.size());
+                EXPECT_NEAR(m.getMinor(row, column).getDeterminant(), lu.getDeterminant(), 1e-10) << row << ", " << column;
+            }
+        }
+    }
+
+    TEST_F(LuDecompositionTest, largeDeterminant) {
+        // upper triangular part 1, lower triangular part 0 except the diagonal: determinant is product of diagonal
+        constexpr Dimension Size = 12;
+        Matrix m(Size, Size);
+        double expected = 1;
+        for (Dimension row = 0; row < Size; row++) {
+            for (Dimension column = row + 1; column < Size; column++) {
+                m(row, column) = 1;
+            }
+            m(row, row) = row + 1.0;
+            expected *= row + 1.0;
+        }
+        // swap two rows so the sign flips
+        m.swapRows(0, Size - 1);
+        EXPECT_NEAR(-expected, m.getDeterminant(), 1e-6);
+    }
+
+    TEST_F(LuDecompositionTest, inverseReusingWorkspace) {
+        // symmetric positive definite, like a covariance matrix
+        Matrix m(6, 6);
+        for (Dimension row = 0; row < 6; row++) {
+            for (Dimension column = 0; column < 6; column++) {
+                m(row, column) = 1.0 / (1.0 + row + column);
+            }
+            m(row, row) += 1;
+        }
+        LuDecomposition lu(6);
+        Matrix inverse(6, 6);
+        for (int iteration = 1; iteration <= 3; iteration++) {
+            const Matrix scaled = m * iteration;
+            lu.decompose(scaled);
+            ASSERT_TRUE(lu.getInverse(inverse));
+            expectEqual(Matrix::getIdentity(6), scaled * inverse, "iteration " + std::to_string(iteration), 1e-10);
+        }
+    }
+
+    TEST_F(LuDecompositionTest, inverseOfSingular) {
+        const Matrix m({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+        const LuDecomposition lu(m);
+        Matrix inverse({ {1, 1, 1}, {1, 1, 1}, {1, 1, 1} });
+        EXPECT_FALSE(lu.getInverse(inverse));
+        expectEqual(Matrix({ {1, 1, 1}, {1, 1, 1}, {1, 1, 1} }), inverse, "untouched");
+    }
+
+    TEST_F(LuDecompositionTest, solveSingleRightHandSide) {
+        // zero in the top left corner, so the right hand side needs the pivot swaps too
+        const Matrix m({ {0, 1, 2}, {1, 0, 3}, {4, -3, 8} });
+        const Matrix expected({ {1}, {-2}, {3} });
+        Matrix b = m * expected;
+        const LuDecomposition lu(m);
+        ASSERT_TRUE(lu.solve(b));
+        expectEqual(expected, b, "in place", 1e-12);
+        expectEqual(expected, m.solve(m * expected), "Matrix::solve", 1e-12);
+    }
+
+    TEST_F(LuDecompositionTest, solveManyRightHandSides) {
+        // more columns than fit in one panel, and a partial last panel
+        constexpr Dimension Size = 20;
+        constexpr Dimension Columns = 2 * LuDecomposition::SolveBlockColumns + 7;
+        Matrix m(Size, Size);
+        Matrix expected(Size, Columns);
+        for (Dimension row = 0; row < Size; row++) {
+            for (Dimension column = 0; column < Size; column++) {
+                m(row, column) = static_cast<double>((row * 7 + column * 3) % 11) - 5;
+            }
+            m(row, row) += 20;
+            for (Dimension column = 0; column < Columns; column++) {
+                expected(row, column) = static_cast<double>((row + column) % 5) - 2;
+            }
+        }
+        const Matrix b = m * expected;
+        const LuDecomposition lu(m);
+        Matrix result(Size, Columns);
+        for (int iteration = 0; iteration < 2; iteration++) {
+            const double* storage = result.data();
+            ASSERT_TRUE(lu.solve(b, result));
+            EXPECT_EQ(storage, result.data()) << "result reused";
+            expectEqual(expected, result, "iteration " + std::to_string(iteration), 1e-10);
+        }
+    }
+
+    TEST_F(LuDecompositionTest, solveSingular) {
+        const Matrix m({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+        const LuDecomposition lu(m);
+        Matrix b({ {1}, {2}, {3} });
+        EXPECT_FALSE(lu.solve(b));
+        expectEqual(Matrix({ {1}, {2}, {3} }), b, "untouched");
+        Matrix result(3, 1);
+        EXPECT_FALSE(m.solve(b, result));
+        expectEqual(Matrix(3, 1), result, "Matrix::solve result untouched");
+        const Matrix symmetric({ {1, 2}, {2, 4} });
+        Matrix symmetricResult(2, 1);
+        EXPECT_FALSE(symmetric.solve(Matrix({ {1}, {2} }), symmetricResult));
+    }
+
+#ifdef DEBUG
+    TEST_F(LuDecompositionTest, solveAsserts) {
+        const Matrix m({ {1, 2}, {3, 4} });
+        const LuDecomposition lu(m);
+        Matrix b(3, 1);
+        ASSERT_DEATH(lu.solve(b), "Assertion.*failed");
+        Matrix result(2, 2);
+        ASSERT_DEATH(lu.solve(Matrix(2, 1), result), "Assertion.*failed");
+        ASSERT_DEATH(m.solve(b), "Assertion.*failed");
+    }
+#endif
+}
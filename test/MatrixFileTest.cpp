@@ -0,0 +1,178 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "MatrixTest.h"
+#include "MatrixFile.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::ByteOrder;
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatArray;
+    using RixMatrix::FloatMappedArray;
+    using RixMatrix::MappedArray;
+    using RixMatrix::MatrixFile;
+    using RixMatrix::ScalarType;
+
+    class MatrixFileTest : public MatrixTest {
+    protected:
+        const char* Path = "MatrixFileTest.rixm";
+
+        void TearDown() override {
+            std::remove(Path);
+        }
+
+        std::vector<unsigned char> readBytes() const {
+            std::FILE* file = std::fopen(Path, "rb");
+            std::vector<unsigned char> result;
+            int value;
+            while ((value = std::fgetc(file)) != EOF) result.push_back(static_cast<unsigned char>(value));
+            std::fclose(file);
+            return result;
+        }
+
+        void writeBytes(const std::vector<unsigned char>& bytes) const {
+            std::FILE* file = std::fopen(Path, "wb");
+            std::fwrite(bytes.data(), 1, bytes.size(), file);
+            std::fclose(file);
+        }
+    };
+
+    TEST_F(MatrixFileTest, saveAndLoad) {
+        const Matrix matrix({ {1.5, -2, 3}, {4, 5, 6e-300} });
+        ASSERT_TRUE(MatrixFile::save(Path, matrix));
+        EXPECT_EQ(MatrixFile::HeaderSize + 6 * sizeof(double), readBytes().size());
+
+        MatrixFile::Header header;
+        ASSERT_TRUE(MatrixFile::readHeader(Path, header));
+        EXPECT_EQ(ScalarType::Double, header.scalarType);
+        EXPECT_EQ(MatrixFile::nativeByteOrder(), header.byteOrder);
+        EXPECT_EQ(2u, header.rows);
+        EXPECT_EQ(3u, header.columns);
+
+        Matrix loaded(1, 1);
+        ASSERT_TRUE(MatrixFile::load(Path, loaded));
+        expectEqual(matrix, loaded, "loaded");
+        EXPECT_EQ(6e-300, loaded(1, 2)) << "bit exact";
+
+        FloatArray wrongType(1, 1);
+        EXPECT_FALSE(MatrixFile::load(Path, wrongType)) << "scalar type mismatch";
+        EXPECT_EQ(1u, wrongType.size()) << "untouched";
+    }
+
+    TEST_F(MatrixFileTest, saveAndLoadFloat) {
+        FloatArray array({ {1.25f, 2}, {3, 4}, {5, 6} });
+        ASSERT_TRUE(MatrixFile::save(Path, array));
+        FloatArray loaded(0, 0);
+        ASSERT_TRUE(MatrixFile::load(Path, loaded));
+        EXPECT_TRUE(array == loaded);
+        EXPECT_EQ(3u, loaded.rowCount());
+    }
+
+    TEST_F(MatrixFileTest, otherByteOrder) {
+        // rewrite a file as a machine with the other byte order would have written it
+        const Matrix matrix({ {1, 2}, {3, 4}, {5, 6} });
+        ASSERT_TRUE(MatrixFile::save(Path, matrix));
+        auto bytes = readBytes();
+        bytes[6] = static_cast<unsigned char>(MatrixFile::nativeByteOrder() == ByteOrder::LittleEndian ? ByteOrder::BigEndian : ByteOrder::LittleEndian);
+        std::reverse(bytes.begin() + 8, bytes.begin() + 12);
+        std::reverse(bytes.begin() + 12, bytes.begin() + 16);
+        for (std::size_t cell = MatrixFile::HeaderSize; cell < bytes.size(); cell += sizeof(double)) {
+            std::reverse(bytes.begin() + cell, bytes.begin() + cell + sizeof(double));
+        }
+        writeBytes(bytes);
+
+        Matrix loaded(1, 1);
+        ASSERT_TRUE(MatrixFile::load(Path, loaded));
+        expectEqual(matrix, loaded, "converted");
+        EXPECT_FALSE(MappedArray(Path).isOpen()) << "can't map the other byte order";
+    }
+
+    TEST_F(MatrixFileTest, invalidFiles) {
+        Matrix loaded(1, 1);
+        MatrixFile::Header header;
+        EXPECT_FALSE(MatrixFile::load("does/not/exist.rixm", loaded));
+        EXPECT_FALSE(MatrixFile::readHeader("does/not/exist.rixm", header));
+        EXPECT_FALSE(MatrixFile::save("does/not/exist.rixm", loaded));
+
+        writeBytes(std::vector<unsigned char>(100, 'x'));
+        EXPECT_FALSE(MatrixFile::load(Path, loaded)) << "no magic";
+        EXPECT_FALSE(MappedArray(Path).isOpen()) << "no magic";
+
+        ASSERT_TRUE(MatrixFile::save(Path, Matrix({ {1, 2}, {3, 4} })));
+        auto bytes = readBytes();
+        bytes.pop_back();
+        writeBytes(bytes);
+        EXPECT_FALSE(MatrixFile::load(Path, loaded)) << "truncated";
+        EXPECT_FALSE(MappedArray(Path).isOpen()) << "truncated";
+        EXPECT_EQ(1u, loaded.size()) << "untouched";
+    }
+
+    TEST_F(MatrixFileTest, damagedHeader) {
+        ASSERT_TRUE(MatrixFile::save(Path, Matrix({ {1, 2}, {3, 4} })));
+        auto bytes = readBytes();
+        const auto writeCounts = [&](const std::uint32_t rows, const std::uint32_t columns) {
+            std::memcpy(bytes.data() + 8, &rows, sizeof rows);
+            std::memcpy(bytes.data() + 12, &columns, sizeof columns);
+            writeBytes(bytes);
+        };
+        Matrix loaded(1, 1);
+        MatrixFile::Header header;
+
+        // fits a Dimension, but would allocate 20 GB for a file of 96 bytes
+        writeCounts(50000, 50000);
+        EXPECT_TRUE(MatrixFile::readHeader(Path, header));
+        EXPECT_FALSE(MatrixFile::load(Path, loaded)) << "truncated";
+        EXPECT_FALSE(MappedArray(Path).isOpen()) << "truncated";
+
+        // the number of cells doesn't fit a Dimension
+        writeCounts(100000, 100000);
+        EXPECT_FALSE(MatrixFile::readHeader(Path, header));
+        EXPECT_FALSE(MatrixFile::load(Path, loaded)) << "oversized";
+        EXPECT_FALSE(MappedArray(Path).isOpen()) << "oversized";
+        EXPECT_EQ(1u, loaded.size()) << "untouched";
+    }
+
+    TEST_F(MatrixFileTest, mapped) {
+        Matrix matrix(50, 30);
+        for (Dimension cell = 0; cell < matrix.size(); cell++) matrix[cell] = cell * 0.5;
+        ASSERT_TRUE(MatrixFile::save(Path, matrix));
+
+        MappedArray mapped(Path);
+        ASSERT_TRUE(mapped.isOpen());
+        EXPECT_EQ(50u, mapped.rowCount());
+        EXPECT_EQ(30u, mapped.columnCount());
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(mapped.data()) % 64) << "aligned";
+        EXPECT_EQ(matrix(49, 29), mapped(49, 29));
+        expectEqual(matrix, mapped.toArray(), "toArray");
+
+        // the view takes part in expressions without copying the file first
+        const Array doubled = mapped.view() * 2.0;
+        EXPECT_EQ(2 * matrix(10, 3), doubled(10, 3));
+        const Array difference = mapped.view() - matrix.toArray();
+        expectEqual(Array(50, 30), difference, "difference");
+
+        MappedArray moved(std::move(mapped));
+        EXPECT_FALSE(mapped.isOpen());
+        EXPECT_EQ(matrix(1, 1), moved(1, 1));
+        moved.close();
+        EXPECT_FALSE(moved.isOpen());
+        EXPECT_EQ(0u, moved.rowCount());
+
+        EXPECT_FALSE(FloatMappedArray(Path).isOpen()) << "scalar type mismatch";
+    }
+}
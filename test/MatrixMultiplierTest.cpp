@@ -0,0 +1,197 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "MatrixTest.h"
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::MatrixMultiplier;
+
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::MultiplicationAlgorithm;
+    using RixMatrix::ThreadPool;
+
+    class MatrixMultiplierTest : public MatrixTest {
+    protected:
+        void TearDown() override {
+            MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::Classical);
+            MatrixMultiplier::setStrassenCutoff(MatrixMultiplier::DefaultStrassenCutoff);
+        }
+
+        // deterministic, non-trivial content
+        static Matrix createMatrix(const Dimension rows, const Dimension columns, const double seed) {
+            Matrix result(rows, columns);
+            for (Dimension row = 0; row < rows; row++) {
+                for (Dimension column = 0; column < columns; column++) {
+                    result(row, column) = sin(seed + row * 0.37 + column * 0.11);
+                }
+            }
+            return result;
+        }
+
+        static Matrix multiplyNaive(const Matrix& left, const Matrix& right) {
+            Matrix result(left.rowCount(), right.columnCount());
+            for (Dimension row = 0; row < left.rowCount(); row++) {
+                for (Dimension column = 0; column < right.columnCount(); column++) {
+                    double sum = 0;
+                    for (Dimension k = 0; k < left.columnCount(); k++) {
+                        sum += left(row, k) * right(k, column);
+                    }
+                    result(row, column) = sum;
+                }
+            }
+            return result;
+        }
+    };
+
+    TEST_F(MatrixMultiplierTest, blockedMatchesNaive) {
+        // sizes cross all block boundaries and are not multiples of the register tile
+        const Matrix left = createMatrix(MatrixMultiplier::BlockRows + 7, MatrixMultiplier::BlockInner + 3, 1.0);
+        const Matrix right = createMatrix(MatrixMultiplier::BlockInner + 3, MatrixMultiplier::BlockColumns + 5, 2.0);
+        Matrix actual(left.rowCount(), right.columnCount());
+        Matrix::multiply(left, right, actual);
+        expectEqual(multiplyNaive(left, right), actual, "blocked", 1e-10);
+    }
+
+    TEST_F(MatrixMultiplierTest, smallMatchesNaive) {
+        const Matrix left = createMatrix(5, 3, 1.0);
+        const Matrix right = createMatrix(3, 7, 2.0);
+        Matrix actual(5, 7);
+        Matrix::multiply(left, right, actual);
+        expectEqual(multiplyNaive(left, right), actual, "small");
+    }
+
+    TEST_F(MatrixMultiplierTest, operatorUsesKernel) {
+        Matrix left = createMatrix(40, 50, 3.0);
+        const Matrix right = createMatrix(50, 45, 4.0);
+        const Matrix expected = multiplyNaive(left, right);
+        left *= right;
+        expectEqual(expected, left, "operator*=", 1e-10);
+    }
+
+    TEST_F(MatrixMultiplierTest, subBlock) {
+        // multiply the bottom right 2x2 blocks of two 3x3 matrices into the top left of a 3x3 result
+        const Matrix left({ {9, 9, 9}, {9, 1, 2}, {9, 3, 4} });
+        const Matrix right({ {9, 9, 9}, {9, 1, 2}, {9, 3, 4} });
+        Matrix out({ {0, 0, -1}, {0, 0, -1}, {-1, -1, -1} });
+        MatrixMultiplier::multiply(2, 2, 2, left.data() + 4, 3, right.data() + 4, 3, out.data(), 3);
+        expectEqual(Matrix({ {7, 10, -1}, {15, 22, -1}, {-1, -1, -1} }), out);
+    }
+
+    TEST_F(MatrixMultiplierTest, strassenMatchesNaive) {
+        EXPECT_EQ(MultiplicationAlgorithm::Classical, MatrixMultiplier::getAlgorithm()) << "classical by default";
+        MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::StrassenWinograd);
+        MatrixMultiplier::setStrassenCutoff(8);
+        EXPECT_EQ(8u, MatrixMultiplier::getStrassenCutoff());
+
+        // three levels of recursion, with odd sizes peeled off at different levels
+        const Matrix left = createMatrix(67, 73, 1.0);
+        const Matrix right = createMatrix(73, 70, 2.0);
+        Matrix actual(left.rowCount(), right.columnCount());
+        Matrix::multiply(left, right, actual);
+        expectEqual(multiplyNaive(left, right), actual, "odd sizes", 1e-10);
+
+        const Matrix square = createMatrix(64, 64, 3.0);
+        expectEqual(multiplyNaive(square, square), square * square, "operator*", 1e-10);
+
+        // one dimension below the cutoff: classical
+        const Matrix narrow = createMatrix(64, 5, 4.0);
+        const Matrix wide = createMatrix(5, 64, 5.0);
+        expectEqual(multiplyNaive(narrow, wide), narrow * wide, "narrow", 1e-12);
+    }
+
+    TEST_F(MatrixMultiplierTest, strassenFloat) {
+        MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::StrassenWinograd);
+        MatrixMultiplier::setStrassenCutoff(16);
+        const Matrix left = createMatrix(50, 41, 1.0);
+        const Matrix right = createMatrix(41, 33, 2.0);
+        const FloatMatrix actual = FloatMatrix(left) * FloatMatrix(right);
+        const Matrix expected = multiplyNaive(left, right);
+        for (Dimension cell = 0; cell < expected.size(); cell++) {
+            EXPECT_NEAR(expected[cell], actual[cell], 1e-4) << "cell " << cell;
+        }
+    }
+
+    TEST_F(MatrixMultiplierTest, strassenSubBlock) {
+        // strides larger than the block widths, and the elements around the output block stay untouched
+        MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::StrassenWinograd);
+        MatrixMultiplier::setStrassenCutoff(4);
+        const Matrix left = createMatrix(20, 20, 1.0);
+        const Matrix right = createMatrix(20, 20, 2.0);
+        Matrix out(20, 20);
+        out += -1.0;
+        MatrixMultiplier::multiply(17, 15, 13, left.data() + 21, 20, right.data() + 42, 20, out.data() + 63, 20);
+
+        Matrix leftBlock(17, 15);
+        Matrix rightBlock(15, 13);
+        leftBlock.block(0, 0, 17, 15) = left.block(1, 1, 17, 15);
+        rightBlock.block(0, 0, 15, 13) = right.block(2, 2, 15, 13);
+        const Matrix expected = multiplyNaive(leftBlock, rightBlock);
+        for (Dimension row = 0; row < 20; row++) {
+            for (Dimension column = 0; column < 20; column++) {
+                const bool isInside = row >= 3 && row < 20 && column >= 3 && column < 16;
+                EXPECT_NEAR(isInside ? expected(row - 3, column - 3) : -1.0, out(row, column), 1e-12)
+                    << "(" << row << "," << column << ")";
+            }
+        }
+    }
+
+    TEST_F(MatrixMultiplierTest, strassenInParallelTasks) {
+        // Another thread runs Strassen products as pool tasks, while this thread does its own. Its leaves are big enough
+        // to run their own parallelFor; while this thread waits for a leaf, it can pick up one of the other thread's
+        // tasks. That larger product must not take over (and grow) the workspace of the one that is still going on.
+        constexpr Dimension Products = 12;
+        std::vector<Matrix> lefts;
+        std::vector<Matrix> rights;
+        std::vector<Matrix> expected;
+        for (Dimension product = 0; product < Products; product++) {
+            lefts.push_back(createMatrix(512, 256, product));
+            rights.push_back(createMatrix(256, 256, product + 0.5));
+            expected.push_back(lefts[product] * rights[product]);
+        }
+        const Matrix left = createMatrix(256, 256, 0.25);
+        const Matrix right = createMatrix(256, 256, 0.75);
+        const Matrix expectedOwn = left * right;
+        std::vector<Matrix> actual(Products, Matrix(512, 256));
+        Matrix own(256, 256);
+
+        // 256 -> leaves of 128, which are just parallel
+        MatrixMultiplier::setAlgorithm(MultiplicationAlgorithm::StrassenWinograd);
+        MatrixMultiplier::setStrassenCutoff(200);
+        ThreadPool::instance().setThreadCount(4);
+        std::atomic<bool> isDone(false);
+        std::thread other([&] {
+            ThreadPool::instance().parallelFor(Products, 1, [&](const Dimension begin, const Dimension end) {
+                for (Dimension product = begin; product < end; product++) {
+                    Matrix::multiply(lefts[product], rights[product], actual[product]);
+                }
+            });
+            isDone = true;
+        });
+        while (!isDone) {
+            Matrix::multiply(left, right, own);
+            expectEqual(expectedOwn, own, "own product", 1e-9);
+        }
+        other.join();
+        ThreadPool::instance().setThreadCount(1);
+
+        for (Dimension product = 0; product < Products; product++) {
+            expectEqual(expected[product], actual[product], "product " + std::to_string(product), 1e-9);
+        }
+    }
+}
@@ -10,6 +10,7 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include <gtest/gtest.h>
+#include <random>
 #include "MatrixTest.h"
 
 namespace RixMatrixTest {
@@ -19,6 +20,14 @@ namespace RixMatrixTest {
         expectEqual(expected.normalized(), actual.normalized(), message, epsilon);
     }
 
+    Matrix MatrixTest::randomMatrix(const RixMatrix::Dimension rows, const RixMatrix::Dimension columns, const unsigned int seed) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        Matrix result(rows, columns);
+        for (RixMatrix::Dimension cell = 0; cell < result.size(); cell++) result[cell] = distribution(generator);
+        return result;
+    }
+
     TEST_F(MatrixTest, add) {
         const Matrix m({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
         const Matrix n({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
@@ -109,6 +118,16 @@ namespace RixMatrixTest {
         expectEqual(m, actual.inverted(), "inverse of inverse");
     }
 
+    TEST_F(MatrixTest, inverseIntoResult) {
+        const Matrix m({ {0, 2, 0, 1}, {1, 0, 0, 0}, {0, 0, 3, 0}, {0, 1, 0, 1} });
+        Matrix result(4, 4);
+        EXPECT_TRUE(m.inverted(result));
+        expectEqual(Matrix::getIdentity(4), m * result, "m * inverse");
+        expectEqual(Matrix::getIdentity(4), result * m, "inverse * m");
+        Matrix singularResult(2, 2);
+        EXPECT_FALSE(Matrix({ {1, 2}, {2, 4} }).inverted(singularResult));
+    }
+
     TEST_F(MatrixTest, normalize) {
         const Matrix m({ {3, 4} });
         const Matrix expected({ {0.6, 0.8} });
@@ -120,6 +139,15 @@ namespace RixMatrixTest {
         expectEqual(expected2, m2.normalized(), "normalize first negative");
     }
 
+    TEST_F(MatrixTest, normalizeTemporaryInPlace) {
+        Matrix m({ {-1, 4, -2, 2} });
+        const double* storage = m.data();
+        const Matrix actual = std::move(m).normalized();
+        expectEqual(Matrix({ {0.2, -0.8, 0.4, -0.4} }), actual);
+        EXPECT_EQ(storage, actual.data());
+        expectEqual(Matrix({ {0} }), Matrix({ {0} }).normalized(), "normalize zero");
+    }
+
     TEST_F(MatrixTest, toArray) {
 
 	    // ReSharper disable once CppVariableCanBeMadeConstexpr -- doesn't work on C++ 11
@@ -130,6 +158,17 @@ namespace RixMatrixTest {
         expectEqual(expected, actual, "toArray");
     }
 
+    TEST_F(MatrixTest, moveBetweenArrayAndMatrix) {
+        Array a({ {1, 2}, {3, 4} });
+        const double* storage = a.data();
+        Matrix m(std::move(a));
+        EXPECT_EQ(storage, m.data());
+        EXPECT_EQ(0u, a.size());
+        const Array back = std::move(m).toArray();
+        EXPECT_EQ(storage, back.data());
+        expectEqual(Array({ {1, 2}, {3, 4} }), back);
+    }
+
     TEST_F(MatrixTest, minor3d) {
         const Matrix m({ {3, 5, 0}, {2, -1, -7}, {6, -1, 5} });
         expectEqual(Matrix({ {-1, -7}, {-1, 5} }), m.getMinor(0, 0));
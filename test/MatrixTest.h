@@ -22,6 +22,8 @@ namespace RixMatrixTest {
     class MatrixTest : public ArrayTest {
     protected:
 	    static void expectNormalizedEqual(const Matrix& expected, const Matrix& actual, const std::string& message = "", double epsilon = Array::Epsilon);
+	    // uniformly distributed in [-1, 1), the same for the same seed
+	    static Matrix randomMatrix(RixMatrix::Dimension rows, RixMatrix::Dimension columns, unsigned int seed);
     };
 }
 
@@ -0,0 +1,217 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "MatrixTest.h"
+#include "MatrixTextFile.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatArray;
+    using RixMatrix::MatrixMarketFormat;
+    using RixMatrix::MatrixTextFile;
+
+    class MatrixTextFileTest : public MatrixTest {
+    protected:
+        const char* Path = "MatrixTextFileTest.txt";
+
+        void TearDown() override {
+            std::remove(Path);
+        }
+
+        void writeText(const std::string& text) const {
+            std::FILE* file = std::fopen(Path, "wb");
+            std::fwrite(text.data(), 1, text.size(), file);
+            std::fclose(file);
+        }
+
+        std::string readText() const {
+            std::FILE* file = std::fopen(Path, "rb");
+            std::string result;
+            int character;
+            while ((character = std::fgetc(file)) != EOF) result += static_cast<char>(character);
+            std::fclose(file);
+            return result;
+        }
+    };
+
+    TEST_F(MatrixTextFileTest, loadCsv) {
+        writeText("a,b,c\r\n1, -2.5 ,3e2\r\n\r\n  .5,+4,-1.25E-3\r\n");
+        Matrix matrix(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, matrix, ',', 1));
+        expectEqual(Matrix({ {1, -2.5, 300}, {0.5, 4, -0.00125} }), matrix);
+
+        writeText("1\t2\n3\t4");
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, matrix, '\t')) << "tabs, no line end at the end";
+        expectEqual(Matrix({ {1, 2}, {3, 4} }), matrix, "tabs");
+
+        writeText("1  2   3\n 4 5 6 \n");
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, matrix, ' ')) << "runs of spaces";
+        expectEqual(Matrix({ {1, 2, 3}, {4, 5, 6} }), matrix, "spaces");
+
+        writeText("");
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, matrix));
+        EXPECT_EQ(0u, matrix.size()) << "empty";
+    }
+
+    TEST_F(MatrixTextFileTest, parseNumbers) {
+        // the fast path must round like strtod; the rest goes through strtod
+        const char* numbers[] = {
+            "0.1", "0.3", "123456.789", "-0.0", "9007199254740993", "1e22", "1e23", "2.2250738585072014e-308",
+            "1.7976931348623157e308", "4.9e-324", "0.000000000000000000000000123", "12345678901234567890123",
+            "3.14159265358979323846264338", "1e-400", "inf", "-nan"
+        };
+        std::string text;
+        for (const auto number : numbers) text += std::string(number) + "\n";
+        writeText(text);
+        Matrix matrix(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, matrix));
+        ASSERT_EQ(16u, matrix.rowCount());
+        for (Dimension row = 0; row < 15; row++) {
+            EXPECT_EQ(std::strtod(numbers[row], nullptr), matrix(row, 0)) << numbers[row];
+        }
+        EXPECT_TRUE(std::signbit(matrix(3, 0))) << "negative zero";
+        EXPECT_TRUE(std::isnan(matrix(15, 0)));
+    }
+
+    TEST_F(MatrixTextFileTest, parseFloats) {
+        // the first three are just above halfway between two floats: via double, they would round down twice
+        const char* numbers[] = {
+            "1.000000059604644776", "1.00000005960464477550", "7.038531e-26", "0.1", "-16777217", "3.4028235e38", "1e-45"
+        };
+        std::string text;
+        for (const auto number : numbers) text += std::string(number) + "\n";
+        writeText(text);
+        FloatArray array(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, array));
+        ASSERT_EQ(7u, array.rowCount());
+        for (Dimension row = 0; row < 7; row++) {
+            EXPECT_EQ(std::strtof(numbers[row], nullptr), array(row, 0)) << numbers[row];
+        }
+        EXPECT_NE(static_cast<float>(std::strtod(numbers[0], nullptr)), array(0, 0)) << "not rounded twice";
+    }
+
+    TEST_F(MatrixTextFileTest, invalidCsv) {
+        Matrix matrix(1, 1);
+        EXPECT_FALSE(MatrixTextFile::loadCsv("does/not/exist.csv", matrix));
+        writeText("1,2\n3\n");
+        EXPECT_FALSE(MatrixTextFile::loadCsv(Path, matrix)) << "too few values";
+        writeText("1,2\n3,4,5\n");
+        EXPECT_FALSE(MatrixTextFile::loadCsv(Path, matrix)) << "too many values";
+        writeText("1,2\n3,x\n");
+        EXPECT_FALSE(MatrixTextFile::loadCsv(Path, matrix)) << "not a number";
+        writeText("1,2\n3,4e\n");
+        EXPECT_FALSE(MatrixTextFile::loadCsv(Path, matrix)) << "incomplete exponent";
+        writeText("1 2\n");
+        EXPECT_FALSE(MatrixTextFile::loadCsv(Path, matrix)) << "wrong delimiter";
+        EXPECT_EQ(1u, matrix.size()) << "untouched";
+    }
+
+    TEST_F(MatrixTextFileTest, csvRoundTrip) {
+        Matrix matrix(20, 7);
+        for (Dimension cell = 0; cell < matrix.size(); cell++) matrix[cell] = std::sin(cell * 1.1) * std::pow(10.0, cell % 40 - 20.0);
+        ASSERT_TRUE(MatrixTextFile::saveCsv(Path, matrix, ';'));
+        Matrix loaded(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, loaded, ';'));
+        ASSERT_TRUE(matrix.sizeIsEqual(loaded));
+        for (Dimension cell = 0; cell < matrix.size(); cell++) EXPECT_EQ(matrix[cell], loaded[cell]) << "bit exact at " << cell;
+
+        const FloatArray floats({ {0.1f, 1e-30f}, {3.4e38f, -7.77f} });
+        ASSERT_TRUE(MatrixTextFile::saveCsv(Path, floats));
+        FloatArray loadedFloats(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, loadedFloats));
+        for (Dimension cell = 0; cell < floats.size(); cell++) EXPECT_EQ(floats[cell], loadedFloats[cell]) << "float " << cell;
+    }
+
+    TEST_F(MatrixTextFileTest, longLines) {
+        // a line longer than the read buffer, and many lines crossing chunk boundaries
+        const Dimension columns = static_cast<Dimension>(MatrixTextFile::ChunkSize / 8);
+        Matrix wide(2, columns);
+        for (Dimension cell = 0; cell < wide.size(); cell++) wide[cell] = cell % 1000 * 0.25;
+        ASSERT_TRUE(MatrixTextFile::saveCsv(Path, wide));
+        Matrix loaded(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, loaded));
+        expectEqual(wide, loaded, "wide");
+
+        Matrix tall(200000, 2);
+        for (Dimension cell = 0; cell < tall.size(); cell++) tall[cell] = cell;
+        ASSERT_TRUE(MatrixTextFile::saveCsv(Path, tall));
+        ASSERT_TRUE(MatrixTextFile::loadCsv(Path, loaded));
+        expectEqual(tall, loaded, "tall");
+    }
+
+    TEST_F(MatrixTextFileTest, matrixMarketArray) {
+        writeText("%%MatrixMarket matrix array real general\n% comment\n\n2 3\n1\n4\n2\n5\n3 6\n");
+        Matrix matrix(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(Matrix({ {1, 2, 3}, {4, 5, 6} }), matrix, "column major");
+
+        writeText("%%MatrixMarket matrix array real symmetric\n3 3\n1\n2\n3\n4\n5\n6\n");
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(Matrix({ {1, 2, 3}, {2, 4, 5}, {3, 5, 6} }), matrix, "symmetric");
+
+        writeText("%%MatrixMarket matrix array real skew-symmetric\n3 3\n1\n2\n3\n");
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(Matrix({ {0, -1, -2}, {1, 0, -3}, {2, 3, 0} }), matrix, "skew symmetric");
+
+        const Matrix original({ {1.5, 0, -3}, {0, 0, 1e-10} });
+        ASSERT_TRUE(MatrixTextFile::saveMatrixMarket(Path, original));
+        EXPECT_EQ("%%MatrixMarket matrix array real general\n2 3\n1.5\n0\n0\n0\n-3\n1e-10\n", readText());
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(original, matrix, "round trip");
+    }
+
+    TEST_F(MatrixTextFileTest, matrixMarketCoordinate) {
+        writeText("%%MatrixMarket MATRIX Coordinate Integer Symmetric\n%\n3 3 3\n1 1 4\n3 1 -2\n2 2 7\n");
+        Matrix matrix(1, 1);
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(Matrix({ {4, 0, -2}, {0, 7, 0}, {-2, 0, 0} }), matrix, "symmetric");
+
+        writeText("%%MatrixMarket matrix coordinate pattern general\n2 3 2\n1 3\n2 1\n");
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(Matrix({ {0, 0, 1}, {1, 0, 0} }), matrix, "pattern");
+
+        const Matrix original({ {0, 2.5}, {-1, 0}, {0, 0} });
+        ASSERT_TRUE(MatrixTextFile::saveMatrixMarket(Path, original, MatrixMarketFormat::Coordinate));
+        EXPECT_EQ("%%MatrixMarket matrix coordinate real general\n3 2 2\n2 1 -1\n1 2 2.5\n", readText());
+        ASSERT_TRUE(MatrixTextFile::loadMatrixMarket(Path, matrix));
+        expectEqual(original, matrix, "round trip");
+    }
+
+    TEST_F(MatrixTextFileTest, invalidMatrixMarket) {
+        Matrix matrix(1, 1);
+        const char* invalid[] = {
+            "1 2\n3 4\n",
+            "%%MatrixMarket matrix array complex general\n1 1\n1 0\n",
+            "%%MatrixMarket matrix array real hermitian\n1 1\n1\n",
+            "%%MatrixMarket matrix array pattern general\n1 1\n1\n",
+            "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n",
+            "%%MatrixMarket matrix array real general\n1 1\n1\n2\n",
+            "%%MatrixMarket matrix array real symmetric\n2 3\n1\n2\n3\n4\n5\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1\n2 2 2\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n0 1 1\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n1.5 1 1\n",
+            "%%MatrixMarket matrix coordinate real general\n2 -2 1\n1 1 1\n"
+        };
+        for (const auto text : invalid) {
+            writeText(text);
+            EXPECT_FALSE(MatrixTextFile::loadMatrixMarket(Path, matrix)) << text;
+        }
+        EXPECT_FALSE(MatrixTextFile::loadMatrixMarket("does/not/exist.mtx", matrix));
+        EXPECT_EQ(1u, matrix.size()) << "untouched";
+    }
+}
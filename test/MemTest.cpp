@@ -10,37 +10,129 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include <gtest/gtest.h>
-#include "Matrix.h"
-#include <Windows.h>
-#include <psapi.h>
-
+#include <utility>
+#include "AllocationTracker.h"
+#include "CholeskyDecomposition.h"
+#include "LuDecomposition.h"
 #include "SolverMatrix.h"
+#include "UpdatableInverse.h"
 
 namespace RixMatrixTest {
+    using RixMatrix::AllocationScope;
+    using RixMatrix::AllocationTracker;
+    using RixMatrix::CholeskyDecomposition;
+    using RixMatrix::Dimension;
+    using RixMatrix::LuDecomposition;
     using RixMatrix::Matrix;
+    using RixMatrix::SolverMatrix;
+    using RixMatrix::UpdatableInverse;
+
+    namespace {
+        // symmetric positive definite, so all decompositions work on it
+        Matrix createMatrix(const Dimension size) {
+            Matrix result(size, size);
+            for (Dimension row = 0; row < size; row++) {
+                for (Dimension column = 0; column < size; column++) {
+                    result(row, column) = row == column ? size + 1.0 : 1.0 / (1 + row + column);
+                }
+            }
+            return result;
+        }
+    }
 
-    long long getMemoryUsage() {
-        PROCESS_MEMORY_COUNTERS pmc;
-        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
-            return pmc.WorkingSetSize;
+    TEST(MemTest, disabledByDefault) {
+        EXPECT_FALSE(AllocationTracker::isEnabled());
+        AllocationTracker::reset();
+        const Matrix matrix(10, 10);
+        EXPECT_EQ(0, AllocationTracker::getStatistics().allocations);
+        {
+            AllocationScope scope;
+            EXPECT_TRUE(AllocationTracker::isEnabled());
         }
-        return 0;
+        EXPECT_FALSE(AllocationTracker::isEnabled()) << "restored after the scope";
     }
 
-    TEST(MemTest, test1) {
-        constexpr int tests = 200000;
-        long long startMem = getMemoryUsage();
-        for (int i=0; i<tests;i++)
+    TEST(MemTest, productAllocatesResultOnly) {
+        const Matrix left = createMatrix(20);
+        const Matrix right = createMatrix(20);
+        AllocationScope scope;
         {
-            const RixMatrix::SolverMatrix m({ {-2, -4, 2}, {-2, 1, 2}, {4, 2, 5} });
-            const auto actual = m.getEigenvectors();
+            const Matrix product = left * right;
+            const auto statistics = scope.getStatistics();
+            EXPECT_EQ(1, statistics.allocations);
+            EXPECT_EQ(static_cast<std::int64_t>(20 * 20 * sizeof(double)), statistics.allocatedBytes);
+            EXPECT_EQ(1, statistics.liveBuffers);
+            EXPECT_EQ(statistics.allocatedBytes, statistics.peakBytes);
         }
-        long long endMem = getMemoryUsage();
+        const auto statistics = scope.getStatistics();
+        EXPECT_EQ(1, statistics.deallocations);
+        EXPECT_EQ(0, statistics.liveBuffers);
+        EXPECT_EQ(0, statistics.liveBytes);
+    }
 
-        std::cout << "Start: " << startMem << " End: " << endMem << std::endl;
-        long long difference = std::llabs(startMem - endMem);
-        std::cout << "Difference: " << difference << std::endl;
-        EXPECT_TRUE(false) << "End";
+    TEST(MemTest, hotPathsDontAllocate) {
+        const Matrix matrix = createMatrix(30);
+        Matrix other = createMatrix(30);
+        Matrix out(30, 30);
+        Matrix rightHandSides(30, 4);
+        LuDecomposition lu(30);
+        CholeskyDecomposition cholesky(30);
+        UpdatableInverse inverse(matrix);
+        Matrix u(30, 1);
+        u(3, 0) = 0.5;
+        Matrix newRow(1, 30);
+        newRow(0, 2) = 40;
+        Matrix newColumn(30, 1);
+        newColumn(5, 0) = 40;
+
+        AllocationScope scope;
+        Matrix::multiply(matrix, other, out);
+        out += matrix;
+        out *= 2.0;
+        out = matrix + other * 2.0;
+        lu.decompose(matrix);
+        lu.solve(rightHandSides);
+        lu.getInverse(out);
+        cholesky.decompose(matrix);
+        cholesky.solve(rightHandSides);
+        inverse.update(u, u);
+        inverse.replaceRow(2, newRow);
+        inverse.replaceColumn(5, newColumn);
+        Matrix moved(std::move(other));
+        EXPECT_EQ(0, scope.getStatistics().allocations);
+    }
+
+    TEST(MemTest, eigenvectorsDontLeak) {
+        // replaces the working set measurement this test used to do (Windows only)
+        const SolverMatrix matrix({ {-2, -4, 2}, {-2, 1, 2}, {4, 2, 5} });
+        AllocationScope scope;
+        matrix.getEigenvectors();
+        const std::int64_t allocationsPerCall = scope.getStatistics().allocations;
+        const std::int64_t peakPerCall = scope.getStatistics().peakBytes;
+        EXPECT_GT(allocationsPerCall, 0);
+
+        constexpr int Calls = 1000;
+        for (int call = 1; call < Calls; call++) {
+            matrix.getEigenvectors();
+        }
+        const auto statistics = scope.getStatistics();
+        EXPECT_EQ(Calls * allocationsPerCall, statistics.allocations);
+        EXPECT_EQ(statistics.allocations, statistics.deallocations);
+        EXPECT_EQ(0, statistics.liveBuffers);
+        EXPECT_EQ(0, statistics.liveBytes);
+        EXPECT_EQ(peakPerCall, statistics.peakBytes) << "no growth between calls";
+    }
 
+    TEST(MemTest, resizeInPlace) {
+        Matrix matrix(10, 10);
+        AllocationScope scope;
+        matrix.setRowCount(5);
+        matrix.setColumnCount(8);
+        EXPECT_EQ(0, scope.getStatistics().allocations) << "shrinking keeps the buffer";
+        matrix.setRowCount(40);
+        const auto statistics = scope.getStatistics();
+        EXPECT_EQ(1, statistics.allocations);
+        EXPECT_EQ(1, statistics.deallocations) << "the old buffer is released";
+        EXPECT_EQ(static_cast<std::int64_t>(40 * 8 * sizeof(double) - 10 * 10 * sizeof(double)), statistics.liveBytes);
     }
 }
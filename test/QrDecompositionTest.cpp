@@ -0,0 +1,141 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "QrDecomposition.h"
+#include "SolverMatrix.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::FloatQrDecomposition;
+    using RixMatrix::QrDecomposition;
+    using RixMatrix::SolverMatrix;
+
+    class QrDecompositionTest : public MatrixTest {
+    protected:
+        // the null space must be orthonormal, and the matrix must map it onto zero
+        static void expectNullSpace(const Matrix& matrix, const Matrix& nullSpace, const Dimension nullity, const double epsilon) {
+            ASSERT_EQ(matrix.columnCount(), nullSpace.rowCount());
+            ASSERT_EQ(nullity, nullSpace.columnCount());
+            expectEqual(Matrix::getIdentity(nullity), Matrix(nullSpace.transposed<Matrix>() * nullSpace), "orthonormal", epsilon);
+            expectEqual(Matrix(matrix.rowCount(), nullity), Matrix(matrix * nullSpace), "null space", epsilon);
+        }
+    };
+
+    TEST_F(QrDecompositionTest, fullRank) {
+        const Matrix m({ {1, 3, 5}, {1, 3, 1}, {4, 3, 9} });
+        const QrDecomposition qr(m);
+        EXPECT_EQ(3, qr.getRank());
+        expectNullSpace(m, qr.getNullSpace(), 0, Array::Epsilon);
+    }
+
+    TEST_F(QrDecompositionTest, rankDeficientSquare) {
+        // the same matrix as SolverMatrixTest.nullSpaceWithPermutation
+        const Matrix m({ {0, 0, 2, 4}, {1, 0, 3, 0}, {0, 5, 0, 10}, {0, 0, 1, 2} });
+        const QrDecomposition qr(m);
+        EXPECT_EQ(3, qr.getRank());
+        const Matrix nullSpace = qr.getNullSpace();
+        expectNullSpace(m, nullSpace, 1, Array::Epsilon);
+        expectNormalizedEqual(Matrix({ { 6 }, { -2 }, { -2 }, { 1 } }), nullSpace);
+
+        // rows 0 and 3 are dependent, so only one of them can be among the independent ones
+        const auto& permutation = qr.getPermutation();
+        EXPECT_EQ(4u, permutation.size());
+        int dependentRowsInRank = 0;
+        for (Dimension index = 0; index < 3; index++) {
+            if (permutation[index] == 0 || permutation[index] == 3) dependentRowsInRank++;
+        }
+        EXPECT_EQ(1, dependentRowsInRank);
+    }
+
+    TEST_F(QrDecompositionTest, wideJacobian) {
+        // 50 constraints on 200 variables, of which only 30 are independent
+        const Matrix m(randomMatrix(50, 30, 1) * randomMatrix(30, 200, 2));
+        QrDecomposition qr(50, 200);
+        qr.decompose(m);
+        EXPECT_EQ(30, qr.getRank());
+        expectNullSpace(m, qr.getNullSpace(), 170, 1e-10);
+
+        // reusing the workspace for a full rank matrix of the same size
+        const Matrix fullRank = randomMatrix(50, 200, 3);
+        qr.decompose(fullRank);
+        EXPECT_EQ(50, qr.getRank());
+        expectNullSpace(fullRank, qr.getNullSpace(), 150, 1e-10);
+    }
+
+    TEST_F(QrDecompositionTest, tall) {
+        // more equations than variables; the last column is the sum of the first two
+        Matrix m = randomMatrix(8, 4, 4);
+        for (Dimension row = 0; row < 8; row++) m(row, 3) = m(row, 0) + m(row, 1);
+        const QrDecomposition qr(m);
+        EXPECT_EQ(3, qr.getRank());
+        const Matrix nullSpace = qr.getNullSpace();
+        expectNullSpace(m, nullSpace, 1, 1e-12);
+        expectNormalizedEqual(Matrix({ { 1 }, { 1 }, { 0 }, { -1 } }), nullSpace);
+    }
+
+    TEST_F(QrDecompositionTest, coordinates) {
+        // A = C Q^T, with C lower triangular apart from the row permutation
+        const Matrix m = randomMatrix(3, 5, 8);
+        const QrDecomposition qr(m);
+        Matrix q = Matrix::getIdentity(5);
+        qr.applyQ(q);
+        expectEqual(Matrix::getIdentity(5), Matrix(q.transposed<Matrix>() * q), "orthonormal");
+        Matrix coordinates(3, 3);
+        qr.getCoordinates(coordinates);
+        Matrix thinQ(5, 3);
+        for (Dimension row = 0; row < 5; row++) {
+            for (Dimension column = 0; column < 3; column++) thinQ(row, column) = q(row, column);
+        }
+        expectEqual(m, Matrix(coordinates * thinQ.transposed<Matrix>()), "A = C Q^T");
+        EXPECT_EQ(0, coordinates(qr.getPermutation()[0], 1));
+    }
+
+    TEST_F(QrDecompositionTest, zero) {
+        const QrDecomposition qr(Matrix(2, 3));
+        EXPECT_EQ(0, qr.getRank());
+        expectEqual(Matrix::getIdentity(3), qr.getNullSpace());
+    }
+
+    TEST_F(QrDecompositionTest, tolerance) {
+        // the last row is almost a multiple of the first
+        const Matrix m({ {1, 2, 3}, {0, 1, 4}, {2, 4, 6.000001} });
+        const QrDecomposition qr(m);
+        EXPECT_EQ(3, qr.getRank());
+        EXPECT_EQ(2, qr.getRank(1e-5));
+        expectNullSpace(m, qr.getNullSpace(1e-5), 1, 1e-5);
+    }
+
+    TEST_F(QrDecompositionTest, matchesSolverMatrix) {
+        const Matrix m({ {1, 2, 3, 4, 5}, {2, 4, 6, 8, 10}, {0, 1, 1, 0, 1} });
+        SolverMatrix solver(m);
+        const auto permutation = solver.toReducedRowEchelonFormWithPivot();
+        const Matrix rrefNullSpace = solver.getNullSpace(permutation);
+        const QrDecomposition qr(m);
+        EXPECT_EQ(2, qr.getRank());
+        EXPECT_EQ(rrefNullSpace.columnCount(), qr.getNullSpace().columnCount());
+        expectNullSpace(m, qr.getNullSpace(), 3, Array::Epsilon);
+    }
+
+    TEST_F(QrDecompositionTest, floatVersion) {
+        const FloatMatrix m({ {1, 2, 3, 4}, {2, 4, 6, 8}, {1, 0, 1, 0} });
+        const FloatQrDecomposition qr(m);
+        EXPECT_EQ(2, qr.getRank());
+        const FloatMatrix nullSpace = qr.getNullSpace();
+        ASSERT_EQ(2, nullSpace.columnCount());
+        const FloatMatrix product(m * nullSpace);
+        for (Dimension cell = 0; cell < product.size(); cell++) {
+            EXPECT_NEAR(0.0f, product[cell], 1e-5f);
+        }
+    }
+}
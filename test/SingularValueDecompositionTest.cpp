@@ -0,0 +1,160 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "SingularValueDecomposition.h"
+#include "ThreadPool.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::FloatSingularValueDecomposition;
+    using RixMatrix::SingularValueDecomposition;
+    using RixMatrix::SvdMode;
+    using RixMatrix::ThreadPool;
+
+    class SingularValueDecompositionTest : public MatrixTest {
+    protected:
+        static void expectOrthonormalColumns(const Matrix& vectors, const std::string& message) {
+            expectEqual(Matrix::getIdentity(vectors.columnCount()), Matrix(vectors.transposed<Matrix>() * vectors), message, 1e-10);
+        }
+
+        // U S V^T must give the matrix back, with orthonormal U and V and descending singular values
+        static void expectDecomposition(const Matrix& matrix, const SingularValueDecomposition& svd) {
+            EXPECT_TRUE(svd.hasConverged());
+            const Matrix& u = svd.getU();
+            const Matrix& v = svd.getV();
+            const Matrix& singularValues = svd.getSingularValues();
+            expectOrthonormalColumns(u, "U");
+            expectOrthonormalColumns(v, "V");
+            Matrix sigma(u.columnCount(), v.columnCount());
+            for (Dimension index = 0; index < singularValues.rowCount(); index++) {
+                sigma(index, index) = singularValues[index];
+                if (index > 0) {
+                    EXPECT_GE(singularValues[index - 1], singularValues[index]);
+                }
+            }
+            expectEqual(matrix, Matrix(u * sigma * v.transposed<Matrix>()), "U S V^T", 1e-10);
+        }
+    };
+
+    TEST_F(SingularValueDecompositionTest, knownValues) {
+        const Matrix m({ {3, 2, 2}, {2, 3, -2} });
+        const SingularValueDecomposition svd(m);
+        expectEqual(Matrix({ {5}, {3} }), svd.getSingularValues());
+        EXPECT_EQ(2, svd.getU().columnCount());
+        EXPECT_EQ(2, svd.getV().columnCount());
+        expectNormalizedEqual(Matrix({ {1}, {1}, {0} }), Matrix(svd.getV().getColumn(0)));
+        expectDecomposition(m, svd);
+    }
+
+    TEST_F(SingularValueDecompositionTest, shapesAndModes) {
+        const Matrix tall = randomMatrix(7, 4, 1);
+        expectDecomposition(tall, SingularValueDecomposition(tall));
+        const SingularValueDecomposition fullTall(tall, SvdMode::Full);
+        EXPECT_EQ(7, fullTall.getU().columnCount());
+        expectDecomposition(tall, fullTall);
+
+        const Matrix wide = randomMatrix(3, 6, 2);
+        expectDecomposition(wide, SingularValueDecomposition(wide));
+        const SingularValueDecomposition fullWide(wide, SvdMode::Full);
+        EXPECT_EQ(6, fullWide.getV().columnCount());
+        expectDecomposition(wide, fullWide);
+
+        // odd size, so one row sits out each round
+        const Matrix square = randomMatrix(5, 5, 3);
+        expectDecomposition(square, SingularValueDecomposition(square));
+    }
+
+    TEST_F(SingularValueDecompositionTest, rankDeficient) {
+        // rank 2: the last column is the sum of the first two, and a zero column
+        Matrix m = randomMatrix(6, 4, 4);
+        for (Dimension row = 0; row < 6; row++) {
+            m(row, 2) = m(row, 0) + m(row, 1);
+            m(row, 3) = 0;
+        }
+        const SingularValueDecomposition svd(m);
+        EXPECT_EQ(2, svd.getRank());
+        EXPECT_NEAR(0, svd.getSingularValues()[3], 1e-12);
+        expectDecomposition(m, svd);
+
+        const SingularValueDecomposition zero(Matrix(3, 2));
+        EXPECT_EQ(0, zero.getRank());
+        expectDecomposition(Matrix(3, 2), zero);
+    }
+
+    TEST_F(SingularValueDecompositionTest, pseudoInverse) {
+        const Matrix square({ {4, 7}, {2, 6} });
+        expectEqual(square.inverted(), square.pseudoInverse());
+
+        // the four Moore-Penrose conditions, on a rank deficient wide matrix
+        const Matrix m({ {1, 2, 3, 4}, {2, 4, 6, 8}, {1, 0, 1, 0} });
+        const Matrix pseudo = m.pseudoInverse();
+        EXPECT_EQ(4, pseudo.rowCount());
+        EXPECT_EQ(3, pseudo.columnCount());
+        expectEqual(m, Matrix(m * pseudo * m), "A A+ A", 1e-10);
+        expectEqual(pseudo, Matrix(pseudo * m * pseudo), "A+ A A+", 1e-10);
+        const Matrix left(m * pseudo);
+        const Matrix right(pseudo * m);
+        EXPECT_TRUE(left.isSymmetric(1e-10));
+        EXPECT_TRUE(right.isSymmetric(1e-10));
+    }
+
+    TEST_F(SingularValueDecompositionTest, leastSquares) {
+        // fit y = a + b x through points that don't lie on a line: the normal equations give the same
+        const Matrix design({ {1, 0}, {1, 1}, {1, 2}, {1, 3} });
+        const Matrix y({ {1}, {3}, {4}, {4} });
+        const SingularValueDecomposition svd(design);
+        const Matrix actual = svd.solve(y);
+        const Matrix normal = design.transposed<Matrix>() * design;
+        const Matrix expected = normal.solve(design.transposed<Matrix>() * y);
+        expectEqual(expected, actual, "least squares", 1e-12);
+        expectEqual(Matrix(svd.pseudoInverse() * y), actual, "pseudo-inverse", 1e-12);
+
+        // underdetermined: the minimum norm solution of x1 + x2 = 2 is (1, 1)
+        const SingularValueDecomposition wide(Matrix({ {1, 1} }));
+        expectEqual(Matrix({ {1}, {1} }), wide.solve(Matrix({ {2} })));
+    }
+
+    TEST_F(SingularValueDecompositionTest, tallCalibrationSystem) {
+        // many observations of a few parameters
+        const Matrix m = randomMatrix(4000, 16, 5);
+        const Matrix parameters = randomMatrix(16, 1, 6);
+        SingularValueDecomposition svd(4000, 16);
+        EXPECT_TRUE(svd.decompose(m));
+        expectDecomposition(m, svd);
+        expectEqual(parameters, svd.solve(Matrix(m * parameters)), "exact fit", 1e-10);
+    }
+
+    TEST_F(SingularValueDecompositionTest, parallelRounds) {
+        // large enough for the rounds to run on the thread pool
+        const Matrix m = randomMatrix(130, 130, 7);
+        const SingularValueDecomposition sequential(m);
+        ThreadPool::instance().setThreadCount(4);
+        const SingularValueDecomposition parallel(m);
+        ThreadPool::instance().setThreadCount(1);
+        expectDecomposition(m, parallel);
+        expectEqual(sequential.getSingularValues(), parallel.getSingularValues(), "same as sequential", 0);
+    }
+
+    TEST_F(SingularValueDecompositionTest, floatVersion) {
+        const FloatMatrix m({ {3, 2, 2}, {2, 3, -2} });
+        const FloatSingularValueDecomposition svd(m);
+        EXPECT_NEAR(5.0f, svd.getSingularValues()[0], 1e-5f);
+        EXPECT_NEAR(3.0f, svd.getSingularValues()[1], 1e-5f);
+        const FloatMatrix pseudo = m.pseudoInverse();
+        const FloatMatrix identity(m * pseudo);
+        EXPECT_NEAR(1.0f, identity(0, 0), 1e-5f);
+        EXPECT_NEAR(0.0f, identity(0, 1), 1e-5f);
+        EXPECT_NEAR(1.0f, identity(1, 1), 1e-5f);
+    }
+}
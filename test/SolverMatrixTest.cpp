@@ -34,53 +34,53 @@ namespace RixMatrixTest {
 
     TEST_F(SolverMatrixTest, toRowEchelonForm10x) {
         SolverMatrix m({ {10, 20, 30, 0}, {30, 40, 50, 0}, {40, 50, 60, 0} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, 0.5, 0}, {0, 1, 0.5, 0}, {0, 0, 0, 0} });
         expectEqual(expected, m);
-        expectEqual(Array({ {0,1,0,0}, {0,0,1,0}, {1,0,0,0}, {0,0,0,1} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 2, 0, 1, 3 }), permutation);
     }
 
 
     TEST_F(SolverMatrixTest, toRowEchelonForm1) {
         SolverMatrix m({ {1, 2, 3, 0}, {3, 4, 5, 0}, {4, 5, 6, 0} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, 0.5, 0}, {0, 1, 0.5, 0}, {0, 0, 0, 0} });
         expectEqual(expected, m);
-        expectEqual(Array({ {0,1,0,0}, {0,0,1,0}, {1,0,0,0}, {0,0,0,1} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 2, 0, 1, 3 }), permutation);
         m.toReducedRowEchelonFormWithPivot();
         expectEqual(expected, m);
     }
 
     TEST_F(SolverMatrixTest, toRowEchelonForm2) {
         SolverMatrix m({ {-5, -4, 2, 0}, {-2, -2, 2, 0}, {4, 2, 2, 0} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, 2.0 / 3.0, 0}, {0, 1, -1.0 / 3.0, 0}, {0, 0, 0, 0} });
         expectEqual(expected, m);
-        expectEqual(Array({ {1,0,0,0}, {0,0,1,0}, {0,1,0,0}, {0,0,0,1} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 0, 2, 1, 3 }), permutation);
     }
 
     TEST_F(SolverMatrixTest, toRowEchelonForm3) {
         SolverMatrix m({ {0, 0, 0}, {1, 0, 1}, {0, 1, -1} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, 1}, {0, 1, -1}, {0, 0, 0} });
         expectEqual(expected, m);
-        expectEqual(Array({ {1, 0, 0}, {0, 1, 0}, {0, 0, 1} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 0, 1, 2 }), permutation);
     }
 
     TEST_F(SolverMatrixTest, toRowEchelonForm4) {
         SolverMatrix m({ {1, 0, 0}, {0, 2, 1}, {0, 0, 2} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, 0}, {0, 1, 0}, {0, 0, 1} });
         expectEqual(expected, m);
-        expectEqual(Array({ {0, 0, 1}, {1, 0, 0}, {0, 1, 0} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 1, 2, 0 }), permutation);
     }
 
     TEST_F(SolverMatrixTest, toRowEchelonFormSpecial) {
         SolverMatrix m({ {8192.10277, -0.0341611, 8192.03422}, {0.0686703, -6.3222615e-7, 0.0686707}, {8192.03422, -0.03416085, 8192.10277} });
-        const Matrix permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
         const Array expected({ {1, 0, -3.9e-6}, {0, 1, -2.62e-7}, {0, 9.74e-7, -3.46e-7} });
         expectEqual(expected, m, "toRowEchelonFormSpecial", 1e-7);
-        expectEqual(Array({ {1, 0, 0}, {0, 0, 1}, {0, 1, 0} }), permutation);
+        EXPECT_EQ(std::vector<Dimension>({ 0, 2, 1 }), permutation);
     }
 
     // *** Null spaces and free variables ***
@@ -142,6 +142,30 @@ namespace RixMatrixTest {
         expectEqual(Array({ {0},{0},{0} }), outcome, "matrix * null space", SolverMatrix::EigenEpsilon);
     }
 
+    TEST_F(SolverMatrixTest, nullSpaceWithPermutation) {
+        const Matrix original({ {0, 0, 2, 4}, {1, 0, 3, 0}, {0, 5, 0, 10}, {0, 0, 1, 2} });
+        SolverMatrix m(original);
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
+        const auto actual = m.getNullSpace(permutation);
+
+        EXPECT_EQ(1, actual.columnCount());
+        expectNormalizedEqual(Matrix({ { 6 }, { -2 }, { -2 }, { 1 } }), actual);
+        expectEqual(Array({ {0},{0},{0},{0} }), original * actual, "original * null space", SolverMatrix::EigenEpsilon);
+    }
+
+    TEST_F(SolverMatrixTest, nullSpaceWide) {
+        // more variables than equations: the null space has a row per column
+        const Matrix original({ {1, 2, 0, 3}, {2, 4, 1, 7} });
+        SolverMatrix m(original);
+        const auto permutation = m.toReducedRowEchelonFormWithPivot();
+        EXPECT_EQ(2u, m.getFreeVariables().size());
+        const auto actual = m.getNullSpace(permutation);
+
+        EXPECT_EQ(4, actual.rowCount());
+        EXPECT_EQ(2, actual.columnCount());
+        expectEqual(Array(2, 2), original * actual, "original * null space", SolverMatrix::EigenEpsilon);
+    }
+
     // *** Eigenvalues, eigen vectors ***
 
     TEST_F(SolverMatrixTest, getEigenvalues1d) {
@@ -255,6 +279,22 @@ namespace RixMatrixTest {
         expectEqual(m, sm);
     }
 
+    TEST_F(SolverMatrixTest, takeOverTemporary) {
+        const SolverMatrix m({ {2, 1}, {1, 2} });
+        Matrix difference(2, 2);
+        const double* storage = difference.data();
+        difference = m - Matrix::getIdentity(2) * 3.0;
+        SolverMatrix beta(std::move(difference));
+        EXPECT_EQ(storage, beta.data()) << "evaluated in place and moved";
+        expectEqual(Matrix({ {-1, 1}, {1, -1} }), beta);
+
+        // an expression is evaluated once, straight into the solver matrix's storage
+        SolverMatrix gamma(m - Matrix::getIdentity(2) * 1.0);
+        expectEqual(Matrix({ {1, 1}, {1, 1} }), gamma);
+        beta.toReducedRowEchelonFormWithPivot();
+        expectEqual(Matrix({ {1}, {1} }), beta.getNullSpace());
+    }
+
 #ifdef DEBUG
     TEST_F(SolverMatrixTest, assertTest) {
         SolverMatrix m({ {1, 2} });
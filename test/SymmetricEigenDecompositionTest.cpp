@@ -0,0 +1,103 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "MatrixTest.h"
+#include "SolverMatrix.h"
+#include "SymmetricEigenDecomposition.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::SolverMatrix;
+    using RixMatrix::SymmetricEigenDecomposition;
+
+    class SymmetricEigenDecompositionTest : public MatrixTest {
+    protected:
+        static Matrix randomSymmetric(const Dimension size, const unsigned int seed) {
+            std::mt19937 generator(seed);
+            std::uniform_real_distribution<double> distribution(-1, 1);
+            Matrix result(size, size);
+            for (Dimension row = 0; row < size; row++) {
+                for (Dimension column = 0; column <= row; column++) {
+                    result(row, column) = distribution(generator);
+                    result(column, row) = result(row, column);
+                }
+            }
+            return result;
+        }
+
+        // A V = V diag(values), V orthonormal and the values descending
+        static void expectDecomposition(const Matrix& m, const SymmetricEigenDecomposition& decomposition, const double epsilon) {
+            ASSERT_TRUE(decomposition.hasConverged());
+            const auto& values = decomposition.getEigenvalues();
+            const auto& vectors = decomposition.getEigenvectors();
+            const Dimension n = m.rowCount();
+            Matrix scaled(vectors);
+            for (Dimension column = 0; column < n; column++) {
+                scaled.column(column) *= values(column, 0);
+                if (column > 0) {
+                    EXPECT_LE(values(column, 0), values(column - 1, 0)) << "descending " << column;
+                }
+            }
+            expectEqual(scaled, m * vectors, "A V = V D", epsilon);
+            expectEqual(Matrix::getIdentity(n), vectors.transposed<Matrix>() * vectors, "orthonormal", epsilon);
+        }
+    };
+
+    TEST_F(SymmetricEigenDecompositionTest, tridiagonal4x4) {
+        const Matrix m({ {2, -1, 0, 0}, {-1, 2, -1, 0}, {0, -1, 2, -1}, {0, 0, -1, 2} });
+        const SymmetricEigenDecomposition decomposition(m);
+        // eigenvalues are 2 - 2 cos(k pi / 5)
+        const double pi = acos(-1.0);
+        for (Dimension k = 0; k < 4; k++) {
+            EXPECT_NEAR(2 - 2 * cos((4 - k) * pi / 5), decomposition.getEigenvalues()(k, 0), 1e-12) << k;
+        }
+        expectDecomposition(m, decomposition, 1e-12);
+    }
+
+    TEST_F(SymmetricEigenDecompositionTest, diagonalAndRepeated) {
+        const Matrix diagonal({ {1, 0, 0, 0}, {0, 4, 0, 0}, {0, 0, -2, 0}, {0, 0, 0, 3} });
+        const SymmetricEigenDecomposition decomposition(diagonal);
+        expectEqual(Matrix({ {4}, {3}, {1}, {-2} }), decomposition.getEigenvalues(), "diagonal values");
+        expectDecomposition(diagonal, decomposition, 1e-12);
+
+        const Matrix identity = Matrix::getIdentity(5);
+        expectDecomposition(identity, SymmetricEigenDecomposition(identity), 1e-12);
+        const Matrix zero(4, 4);
+        expectDecomposition(zero, SymmetricEigenDecomposition(zero), 1e-12);
+    }
+
+    TEST_F(SymmetricEigenDecompositionTest, randomMatrices) {
+        SymmetricEigenDecomposition decomposition(50);
+        for (unsigned int seed = 1; seed <= 3; seed++) {
+            const Matrix m = randomSymmetric(50, seed);
+            EXPECT_TRUE(decomposition.decompose(m)) << seed;
+            expectDecomposition(m, decomposition, 1e-10);
+        }
+        const Matrix m = randomSymmetric(10, 42);
+        const SymmetricEigenDecomposition small(m);
+        double sum = 0;
+        for (Dimension i = 0; i < 10; i++) sum += small.getEigenvalues()(i, 0);
+        EXPECT_NEAR(m.getTrace(), sum, 1e-12);
+        expectDecomposition(m, small, 1e-12);
+    }
+
+    TEST_F(SymmetricEigenDecompositionTest, solverMatrixUsesItBeyond3x3) {
+        const SolverMatrix m({ {4, 1, 0, 0}, {1, 4, 1, 0}, {0, 1, 4, 1}, {0, 0, 1, 4} });
+        EXPECT_TRUE(m.isSymmetric());
+        const SymmetricEigenDecomposition decomposition(m);
+        expectEqual(decomposition.getEigenvalues(), m.getEigenvalues(), "eigenvalues");
+        expectEqual(decomposition.getEigenvectors(), m.getEigenvectors(), "eigenvectors");
+        EXPECT_FALSE(Matrix({ {1, 2}, {3, 1} }).isSymmetric());
+    }
+}
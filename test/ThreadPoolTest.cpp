@@ -0,0 +1,124 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <vector>
+#include "MatrixTest.h"
+#include "ElementKernels.h"
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::ElementKernels;
+    using RixMatrix::MatrixMultiplier;
+    using RixMatrix::ThreadPool;
+
+    class ThreadPoolTest : public MatrixTest {
+    protected:
+        void TearDown() override {
+            ThreadPool::instance().setThreadCount(1);
+        }
+
+        static std::vector<double> randomValues(const Dimension count) {
+            std::mt19937 generator(42);
+            std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+            std::vector<double> values(count);
+            for (auto& value : values) value = distribution(generator);
+            return values;
+        }
+    };
+
+    TEST_F(ThreadPoolTest, threadPoolIsOptInTest) {
+        EXPECT_EQ(1u, ThreadPool::instance().getThreadCount()) << "Single threaded by default";
+        EXPECT_FALSE(ThreadPool::instance().isParallel());
+        ThreadPool::instance().setThreadCount(0);
+        EXPECT_EQ(1u, ThreadPool::instance().getThreadCount()) << "0 means single threaded too";
+        ThreadPool::instance().setThreadCount(3);
+        EXPECT_EQ(3u, ThreadPool::instance().getThreadCount());
+        EXPECT_TRUE(ThreadPool::instance().isParallel());
+    }
+
+    TEST_F(ThreadPoolTest, threadPoolParallelForTest) {
+        for (const unsigned int threads : { 1u, 2u, 4u }) {
+            ThreadPool pool(threads);
+            constexpr Dimension Count = 10007;
+            std::vector<int> visits(Count, 0);
+            std::atomic<Dimension> chunks{ 0 };
+            pool.parallelFor(Count, 100, [&](const Dimension begin, const Dimension end) {
+                EXPECT_LE(end - begin, 100u);
+                for (Dimension i = begin; i < end; i++) visits[i]++;
+                chunks++;
+            });
+            EXPECT_EQ(101u, chunks.load()) << "Chunking doesn't depend on the thread count " << threads;
+            for (Dimension i = 0; i < Count; i++) {
+                ASSERT_EQ(1, visits[i]) << "Element " << i << " visited once with " << threads << " threads";
+            }
+        }
+    }
+
+    TEST_F(ThreadPoolTest, threadPoolEmptyAndNestedTest) {
+        ThreadPool pool(4);
+        bool called = false;
+        pool.parallelFor(0, 10, [&](Dimension, Dimension) { called = true; });
+        EXPECT_FALSE(called) << "Nothing to do";
+
+        std::atomic<Dimension> total{ 0 };
+        pool.parallelFor(8, 1, [&](Dimension, Dimension) {
+            // nested calls run inline instead of waiting for workers that are busy with the outer loop
+            pool.parallelFor(100, 10, [&](const Dimension begin, const Dimension end) { total += end - begin; });
+        });
+        EXPECT_EQ(800u, total.load());
+    }
+
+    TEST_F(ThreadPoolTest, threadPoolReuseTest) {
+        ThreadPool pool(4);
+        for (int round = 0; round < 200; round++) {
+            std::atomic<Dimension> total{ 0 };
+            pool.parallelFor(64, 1, [&](const Dimension begin, const Dimension end) { total += end - begin; });
+            ASSERT_EQ(64u, total.load()) << "Round " << round;
+        }
+    }
+
+    TEST_F(ThreadPoolTest, threadPoolMultiplyTest) {
+        // not a multiple of the block sizes, and large enough to be split
+        constexpr Dimension Rows = 200;
+        constexpr Dimension Inner = 150;
+        constexpr Dimension Columns = 600;
+        const auto left = randomValues(Rows * Inner);
+        const auto right = randomValues(Inner * Columns);
+        std::vector<double> serial(Rows * Columns);
+        MatrixMultiplier::multiply(Rows, Inner, Columns, left.data(), Inner, right.data(), Columns, serial.data(), Columns);
+
+        ThreadPool::instance().setThreadCount(4);
+        std::vector<double> parallel(Rows * Columns);
+        MatrixMultiplier::multiply(Rows, Inner, Columns, left.data(), Inner, right.data(), Columns, parallel.data(), Columns);
+        EXPECT_EQ(serial, parallel) << "Same blocks, so the same rounding";
+    }
+
+    TEST_F(ThreadPoolTest, threadPoolElementWiseTest) {
+        constexpr Dimension Count = ElementKernels::ParallelLimit + 12345;
+        const auto source = randomValues(Count);
+        auto serial = randomValues(Count);
+        auto parallel = serial;
+        ElementKernels::add(serial.data(), source.data(), Count);
+        ElementKernels::multiplyScalar(serial.data(), 3.0, Count);
+        ElementKernels::square(serial.data(), serial.data(), Count);
+
+        ThreadPool::instance().setThreadCount(4);
+        ElementKernels::add(parallel.data(), source.data(), Count);
+        ElementKernels::multiplyScalar(parallel.data(), 3.0, Count);
+        ElementKernels::square(parallel.data(), parallel.data(), Count);
+        EXPECT_EQ(serial, parallel);
+    }
+}
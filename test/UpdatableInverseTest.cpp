@@ -0,0 +1,151 @@
+// Copyright 2024 Rik Essenius
+// 
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+// except in compliance with the License. You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include "MatrixTest.h"
+#include "UpdatableInverse.h"
+
+namespace RixMatrixTest {
+    using RixMatrix::Dimension;
+    using RixMatrix::FloatMatrix;
+    using RixMatrix::FloatUpdatableInverse;
+    using RixMatrix::UpdatableInverse;
+
+    class UpdatableInverseTest : public MatrixTest {
+    protected:
+        static Matrix wellConditioned(const Dimension size) {
+            Matrix result(size, size);
+            for (Dimension row = 0; row < size; row++) {
+                for (Dimension column = 0; column < size; column++) {
+                    result(row, column) = static_cast<double>((row * 3 + column * 5) % 7) / 7 - 0.4;
+                }
+                result(row, row) += 3;
+            }
+            return result;
+        }
+
+        static Matrix column(const Dimension size, const double offset) {
+            Matrix result(size, 1);
+            for (Dimension row = 0; row < size; row++) {
+                result(row, 0) = offset + 0.1 * row;
+            }
+            return result;
+        }
+    };
+
+    TEST_F(UpdatableInverseTest, rankOne) {
+        constexpr Dimension Size = 8;
+        Matrix expected = wellConditioned(Size);
+        UpdatableInverse inverse(expected, 0);
+        expectEqual(expected.inverted(), inverse.getInverse(), "initial", 1e-12);
+        for (int iteration = 0; iteration < 5; iteration++) {
+            const Matrix u = column(Size, 0.2 * iteration - 0.3);
+            const Matrix v = column(Size, 0.5 - 0.1 * iteration);
+            ASSERT_TRUE(inverse.update(u, v)) << iteration;
+            expected += u * v.transposed<Matrix>();
+            expectEqual(expected, inverse.getMatrix(), "matrix " + std::to_string(iteration), 1e-12);
+            expectEqual(expected.inverted(), inverse.getInverse(), "inverse " + std::to_string(iteration), 1e-10);
+        }
+        EXPECT_EQ(5u, inverse.getUpdatesSinceRefactor()) << "never refactored";
+    }
+
+    TEST_F(UpdatableInverseTest, replaceRowAndColumn) {
+        constexpr Dimension Size = 5;
+        UpdatableInverse inverse(wellConditioned(Size));
+        const Matrix newRow({ {1, 4, -1, 0.5, 2} });
+        ASSERT_TRUE(inverse.replaceRow(2, newRow));
+        Matrix expected = wellConditioned(Size);
+        expected.setRow(2, newRow);
+        expectEqual(expected.inverted(), inverse.getInverse(), "row", 1e-12);
+
+        const Matrix newColumn({ {2}, {0}, {1}, {5}, {-1} });
+        ASSERT_TRUE(inverse.replaceColumn(4, newColumn));
+        expected.setColumn(4, newColumn);
+        expectEqual(expected, inverse.getMatrix(), "column matrix", 1e-12);
+        expectEqual(expected.inverted(), inverse.getInverse(), "column", 1e-12);
+    }
+
+    TEST_F(UpdatableInverseTest, lowRank) {
+        constexpr Dimension Size = 10;
+        constexpr Dimension Rank = 3;
+        UpdatableInverse inverse(wellConditioned(Size));
+        Matrix u(Size, Rank);
+        Matrix v(Size, Rank);
+        for (Dimension row = 0; row < Size; row++) {
+            for (Dimension column = 0; column < Rank; column++) {
+                u(row, column) = static_cast<double>((row + column) % 4) / 4;
+                v(row, column) = static_cast<double>((row * column) % 3) / 5 - 0.2;
+            }
+        }
+        ASSERT_TRUE(inverse.updateLowRank(u, v));
+        const Matrix expected = Matrix(wellConditioned(Size) + u * v.transposed<Matrix>());
+        expectEqual(expected.inverted(), inverse.getInverse(), "woodbury", 1e-12);
+    }
+
+    TEST_F(UpdatableInverseTest, singularUpdateIsRejected) {
+        const Matrix identity = Matrix::getIdentity(3);
+        UpdatableInverse inverse(identity);
+        // I - e0 e0^T has a zero row
+        const Matrix unit({ {1}, {0}, {0} });
+        EXPECT_FALSE(inverse.update(unit, unit * -1.0));
+        expectEqual(identity, inverse.getInverse(), "inverse untouched");
+        expectEqual(identity, inverse.getMatrix(), "matrix untouched");
+        EXPECT_EQ(0u, inverse.getUpdatesSinceRefactor());
+        EXPECT_FALSE(inverse.updateLowRank(Matrix({ {1, 0}, {0, 1}, {0, 0} }), Matrix({ {-1, 0}, {0, 1}, {0, 0} })));
+    }
+
+    TEST_F(UpdatableInverseTest, refactorInterval) {
+        constexpr Dimension Size = 4;
+        UpdatableInverse inverse(wellConditioned(Size), 3);
+        EXPECT_EQ(3u, inverse.getRefactorInterval());
+        const Matrix u = column(Size, 0.1);
+        const Matrix v = column(Size, -0.05);
+        ASSERT_TRUE(inverse.update(u, v));
+        ASSERT_TRUE(inverse.update(u, v));
+        EXPECT_EQ(2u, inverse.getUpdatesSinceRefactor());
+        ASSERT_TRUE(inverse.update(u, v));
+        EXPECT_EQ(0u, inverse.getUpdatesSinceRefactor()) << "refactored";
+        expectEqual(inverse.getMatrix().inverted(), inverse.getInverse(), "refactored inverse", 1e-14);
+
+        inverse.setRefactorInterval(UpdatableInverse::DefaultRefactorInterval);
+        EXPECT_EQ(UpdatableInverse::DefaultRefactorInterval, inverse.getRefactorInterval());
+    }
+
+    TEST_F(UpdatableInverseTest, singularStart) {
+        UpdatableInverse inverse(Matrix({ {1, 2}, {2, 4} }));
+        EXPECT_TRUE(inverse.isSingular());
+        EXPECT_TRUE(inverse.update(Matrix({ {1}, {0} }), Matrix({ {1}, {0} }))) << "recovered via a refactor";
+        EXPECT_FALSE(inverse.isSingular());
+        expectEqual(Matrix({ {2, 2}, {2, 4} }), inverse.getMatrix());
+        expectEqual(Matrix({ {1, -0.5}, {-0.5, 0.5} }), inverse.getInverse());
+
+        EXPECT_FALSE(inverse.replaceRow(1, Matrix({ {4, 4} }))) << "singular again";
+        expectEqual(Matrix({ {2, 2}, {2, 4} }), inverse.getMatrix(), "rejected");
+    }
+
+    TEST_F(UpdatableInverseTest, singularStartLowRank) {
+        UpdatableInverse inverse(Matrix({ {1, 2}, {2, 4} }));
+        ASSERT_TRUE(inverse.isSingular());
+        const Matrix identity = Matrix::getIdentity(2);
+        EXPECT_TRUE(inverse.updateLowRank(identity, identity)) << "rank 2 update recovered via a refactor";
+        EXPECT_FALSE(inverse.isSingular());
+        expectEqual(Matrix({ {2, 2}, {2, 5} }), inverse.getMatrix());
+        expectEqual(Matrix(Matrix({ {5, -2}, {-2, 2} }) * (1.0 / 6)), inverse.getInverse());
+    }
+
+    TEST_F(UpdatableInverseTest, floatVersion) {
+        const FloatMatrix m({ {4, 1}, {1, 3} });
+        FloatUpdatableInverse inverse(m);
+        ASSERT_TRUE(inverse.update(FloatMatrix({ {1}, {0} }), FloatMatrix({ {0}, {1} })));
+        const FloatMatrix expected({ {4, 2}, {1, 3} });
+        expectEqual(Matrix(expected.inverted()), Matrix(inverse.getInverse()), "float", 1e-6);
+    }
+}